@@ -92,7 +92,7 @@ install_dependencies() {
     case "$pkg_family" in
     apt)
         sudo apt update
-        sudo apt install -y libx11-dev libxi-dev libxext-dev libxinerama-dev \
+        sudo apt install -y libx11-dev libx11-xcb-dev libxi-dev libxext-dev libxinerama-dev \
             libjson-c-dev libdbus-1-dev cmake gcc make pkg-config
         sudo apt install -y libgtk-4-dev libglib2.0-dev
         ;;
@@ -1,9 +1,35 @@
 #include "../ipc/ipc.h"
 #include "../ipc/ipc_command.h"
+#include "../utils/intern.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+static void
+print_delta (const gf_wire_delta_t *delta)
+{
+    printf ("Generation: %llu%s\n", (unsigned long long)delta->generation,
+            delta->reset ? " (full snapshot)" : "");
+    for (uint32_t i = 0; i < delta->removed_count; i++)
+        printf ("Removed: 0x%llx\n", (unsigned long long)delta->removed[i]);
+}
+
+// Print pushed events one per line until the daemon goes away
+static int
+print_events (gf_ipc_handle_t handle)
+{
+    char event[GF_IPC_EVENT_SIZE];
+    while (gf_ipc_client_next_event (handle, event, sizeof (event)))
+    {
+        printf ("%s\n", event);
+        fflush (stdout);
+    }
+
+    gf_ipc_client_disconnect (handle);
+    fprintf (stderr, "Error: Event stream closed\n");
+    return 1;
+}
+
 static void
 print_usage (const char *prog)
 {
@@ -11,6 +37,8 @@ print_usage (const char *prog)
     printf ("Commands:\n");
     printf ("  query windows [WORKSPACE_ID]    List windows\n");
     printf ("  query workspaces                List workspaces\n");
+    printf ("  query windows|workspaces since <GEN>\n");
+    printf ("                                  Changes since a generation (0 = all)\n");
     printf ("  query count [WORKSPACE_ID]      Count windows\n");
     printf ("  query apps                      List running application classes\n");
     printf ("  move <WINDOW_ID> <WORKSPACE_ID> Move window to workspace\n");
@@ -19,10 +47,15 @@ print_usage (const char *prog)
     printf ("  rule add <WM_CLASS> <WS_ID>     Add a window rule\n");
     printf ("  rule remove <WM_CLASS>          Remove a window rule\n");
     printf ("  rule list                       List all window rules\n");
+    printf ("  stats [reset]                   Show (or reset) the tick phase profile\n");
+    printf ("  stats memory                    Show heap usage per subsystem\n");
+    printf ("  trace start|stop|dump [PATH]    Record and dump a Chrome trace\n");
+    printf ("  subscribe [TOPIC,...]           Stream events (all topics by default)\n");
     printf ("\nExamples:\n");
     printf ("  %s query windows              # List all windows\n", prog);
     printf ("  %s query workspaces           # List all workspaces\n", prog);
     printf ("  %s query apps                 # List running app classes\n", prog);
+    printf ("  %s query windows since 0      # Snapshot plus its generation\n", prog);
     printf ("  %s move 0x12345 2               # Move window 0x12345 to workspace 2\n",
             prog);
     printf ("  %s lock 3                     # Lock workspace 3\n", prog);
@@ -30,6 +63,9 @@ print_usage (const char *prog)
     printf ("  %s rule add firefox 3         # Assign Firefox to workspace 3\n", prog);
     printf ("  %s rule remove firefox        # Remove Firefox rule\n", prog);
     printf ("  %s rule list                  # Show all rules\n", prog);
+    printf ("  %s stats                      # Per-phase latency percentiles\n", prog);
+    printf ("  %s subscribe window,focus_changed # Follow window and focus events\n",
+            prog);
 }
 
 int
@@ -73,17 +109,71 @@ main (int argc, char **argv)
         return 1;
     }
 
+    if (strncmp (command, "subscribe", 9) == 0 && response.status == GF_IPC_SUCCESS)
+    {
+        gf_ipc_response_release (&response);
+        return print_events (handle);
+    }
+
     gf_ipc_client_disconnect (handle);
 
+    const char *data = gf_ipc_response_data (&response);
     if (response.status != GF_IPC_SUCCESS)
     {
         fprintf (stderr, "Error: %s\n", response.message);
+        gf_ipc_response_release (&response);
         return 1;
     }
 
-    if (strncmp (command, "query workspaces", 16) == 0)
+    if (strncmp (command, "query workspaces since", 22) == 0)
     {
-        gf_ws_list_t *workspaces = gf_parse_workspace_list (response.message);
+        gf_wire_delta_t delta;
+        gf_ws_list_t *workspaces
+            = gf_parse_workspace_delta (data, response.length, &delta);
+        gf_ipc_response_release (&response);
+        if (!workspaces)
+        {
+            fprintf (stderr, "Error: Failed to parse workspace data\n");
+            return 1;
+        }
+
+        print_delta (&delta);
+        for (uint32_t i = 0; i < workspaces->count; i++)
+        {
+            gf_ws_info_t *ws = &workspaces->items[i];
+            printf ("Changed: %-5d windows %u/%u%s\n", ws->id, ws->window_count,
+                    ws->max_windows, ws->is_locked ? " locked" : "");
+        }
+
+        gf_wire_delta_release (&delta);
+        gf_free_workspace_list (workspaces);
+    }
+    else if (strncmp (command, "query windows since", 19) == 0)
+    {
+        gf_wire_delta_t delta;
+        gf_win_list_t *windows = gf_parse_window_delta (data, response.length, &delta);
+        gf_ipc_response_release (&response);
+        if (!windows)
+        {
+            fprintf (stderr, "Error: Failed to parse window data\n");
+            return 1;
+        }
+
+        print_delta (&delta);
+        for (uint32_t i = 0; i < windows->count; i++)
+        {
+            gf_win_info_t *win = &windows->items[i];
+            printf ("Changed: %-18p %-20s workspace %d\n", (void *)win->id,
+                    gf_win_name (win), win->workspace_id);
+        }
+
+        gf_wire_delta_release (&delta);
+        gf_free_window_list (windows);
+    }
+    else if (strncmp (command, "query workspaces", 16) == 0)
+    {
+        gf_ws_list_t *workspaces = gf_parse_workspace_list (data, response.length);
+        gf_ipc_response_release (&response);
         if (!workspaces)
         {
             fprintf (stderr, "Error: Failed to parse workspace data\n");
@@ -103,11 +193,12 @@ main (int argc, char **argv)
                     ws->max_windows, ws->available_space, ws->is_locked ? "Yes" : "No");
         }
 
-        gf_workspace_list_cleanup (workspaces);
+        gf_free_workspace_list (workspaces);
     }
     else if (strncmp (command, "query windows", 13) == 0)
     {
-        gf_win_list_t *windows = gf_parse_window_list (response.message);
+        gf_win_list_t *windows = gf_parse_window_list (data, response.length);
+        gf_ipc_response_release (&response);
         if (!windows)
         {
             fprintf (stderr, "Error: Failed to parse window data\n");
@@ -124,11 +215,16 @@ main (int argc, char **argv)
             gf_win_info_t *win = &windows->items[i];
             const char *state
                 = win->is_minimized ? "Min" : (win->is_maximized ? "Max" : "Norm");
-            printf ("%-18p %-20s %-10d %-6s\n", (void *)win->id, win->name,
+            printf ("%-18p %-20s %-10d %-6s\n", (void *)win->id, gf_win_name (win),
                     win->workspace_id, state);
         }
 
-        gf_window_list_cleanup (windows);
+        gf_free_window_list (windows);
+    }
+    else if (strncmp (command, "stats", 5) == 0)
+    {
+        printf ("%s", data);
+        gf_ipc_response_release (&response);
     }
     else
     {
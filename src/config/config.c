@@ -1,3 +1,5 @@
+#define GF_MEM_TAG GF_MEM_TAG_CONFIG
+
 #include "config.h"
 #include "../core/types.h"
 #include "../platform/platform_compat.h"
@@ -21,7 +23,7 @@
 
 static const gf_config_t DEFAULT_CONFIG
     = { .max_windows_per_workspace = GF_MAX_WINDOWS_PER_WORKSPACE,
-        .max_workspaces = GF_MAX_WORKSPACES,
+        .max_workspaces = GF_DEFAULT_WORKSPACES,
         .min_window_size = GF_MIN_WINDOW_SIZE,
         .border_color = 0x00F49D2A,
         .enable_borders = true,
@@ -30,56 +32,54 @@ static const gf_config_t DEFAULT_CONFIG
         .window_rules_count = 0,
         .exclude_zones_count = 0 };
 
-const char *
-gf_config_get_path (void)
+// Build the config path and make sure its directory exists.
+static bool
+resolve_config_path (char *config_path, size_t size)
 {
-    static char config_path[PATH_MAX];
-
 #ifdef GF_DEV_MODE
-    strncpy (config_path, "config.json", sizeof (config_path) - 1);
-    config_path[sizeof (config_path) - 1] = '\0';
-    return config_path;
+    strncpy (config_path, "config.json", size - 1);
+    config_path[size - 1] = '\0';
+    return true;
 #else
 #ifdef _WIN32
     const char *appdata = getenv ("APPDATA");
     if (!appdata || appdata[0] == '\0')
     {
         fprintf (stderr, "Error: APPDATA environment variable not set or empty\n");
-        return NULL;
+        return false;
     }
 
-    snprintf (config_path, sizeof (config_path), "%s\\gridflux\\config.json", appdata);
+    snprintf (config_path, size, "%s\\gridflux\\config.json", appdata);
 
     // Ensure the directory exists
     char gridflux_dir[PATH_MAX];
     snprintf (gridflux_dir, sizeof (gridflux_dir), "%s\\gridflux", appdata);
     _mkdir (gridflux_dir);
 
-    return config_path;
+    return true;
 #else
     // Unix-like systems
     const char *xdg_config = getenv ("XDG_CONFIG_HOME");
     if (xdg_config && xdg_config[0] != '\0')
     {
-        snprintf (config_path, sizeof (config_path), "%s/gridflux/config.json",
-                  xdg_config);
+        snprintf (config_path, size, "%s/gridflux/config.json", xdg_config);
 
         // Ensure the directory exists
         char gridflux_dir[PATH_MAX];
         snprintf (gridflux_dir, sizeof (gridflux_dir), "%s/gridflux", xdg_config);
         mkdir (gridflux_dir, 0755);
 
-        return config_path;
+        return true;
     }
 
     const char *home = getenv ("HOME");
     if (!home || home[0] == '\0')
     {
         fprintf (stderr, "Error: HOME environment variable not set\n");
-        return NULL;
+        return false;
     }
 
-    snprintf (config_path, sizeof (config_path), "%s/.config/gridflux/config.json", home);
+    snprintf (config_path, size, "%s/.config/gridflux/config.json", home);
 
     // Ensure the directory exists
     char config_dir[PATH_MAX];
@@ -90,11 +90,29 @@ gf_config_get_path (void)
     snprintf (gridflux_dir, sizeof (gridflux_dir), "%s/.config/gridflux", home);
     mkdir (gridflux_dir, 0755);
 
-    return config_path;
+    return true;
 #endif
 #endif
 }
 
+// The path only depends on the environment, so it is resolved (and the
+// directory created) on the first call and reused afterwards.
+const char *
+gf_config_get_path (void)
+{
+    static char config_path[PATH_MAX];
+    static bool resolved = false;
+
+    if (!resolved)
+    {
+        if (!resolve_config_path (config_path, sizeof (config_path)))
+            return NULL;
+        resolved = true;
+    }
+
+    return config_path;
+}
+
 static char *
 read_file (const char *filename)
 {
@@ -118,7 +136,7 @@ read_file (const char *filename)
         return NULL;
     }
 
-    char *data = malloc ((size_t)len + 1);
+    char *data = gf_malloc ((size_t)len + 1);
     if (!data)
     {
         fprintf (stderr, "Error: Memory allocation failed while reading file '%s'.\n",
@@ -276,7 +294,7 @@ load_or_create_config (const char *filename)
     }
 
     struct json_object *json = json_tokener_parse (data);
-    free (data);
+    gf_free (data);
 
     if (!json)
     {
@@ -290,12 +308,9 @@ load_or_create_config (const char *filename)
     set_if_missing_int (json, "max_workspaces", &cfg.max_workspaces,
                         DEFAULT_CONFIG.max_workspaces, &changed);
 
-    // Clamp to the fixed array bounds so a malicious/typo'd config can never
-    // drive locked_workspaces[] (size GF_MAX_LOCKED_WORKSPACES) out of range.
-    if (cfg.max_workspaces == 0 || cfg.max_workspaces > GF_MAX_WORKSPACES)
+    if (cfg.max_workspaces == 0)
     {
-        cfg.max_workspaces = (cfg.max_workspaces == 0) ? DEFAULT_CONFIG.max_workspaces
-                                                       : GF_MAX_WORKSPACES;
+        cfg.max_workspaces = DEFAULT_CONFIG.max_workspaces;
         changed = true;
     }
 
@@ -334,11 +349,12 @@ load_or_create_config (const char *filename)
         size_t len = json_object_array_length (arr_obj);
         cfg.locked_workspaces_count = 0;
 
-        if (len > cfg.max_workspaces)
+        // locked_workspaces[] is fixed-size; never let the config overrun it
+        if (len > GF_MAX_LOCKED_WORKSPACES)
             changed = true; // truncated
 
-        for (size_t i = 0; i < len && cfg.locked_workspaces_count < cfg.max_workspaces;
-             i++)
+        for (size_t i = 0;
+             i < len && cfg.locked_workspaces_count < GF_MAX_LOCKED_WORKSPACES; i++)
         {
             int ws = json_object_get_int (json_object_array_get_idx (arr_obj, i));
 
@@ -468,9 +484,7 @@ gf_config_workspace_lock (gf_config_t *config, gf_ws_id_t ws_id)
         }
     }
 
-    // max_workspaces is clamped to the array size at load, so it is the
-    // authoritative (config-driven) limit here.
-    if (config->locked_workspaces_count >= config->max_workspaces)
+    if (config->locked_workspaces_count >= GF_MAX_LOCKED_WORKSPACES)
     {
         return GF_ERROR_INVALID_PARAMETER;
     }
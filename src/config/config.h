@@ -27,6 +27,7 @@ struct gf_config
     uint32_t locked_workspaces_count;
     gf_window_rule_t window_rules[GF_MAX_RULES];
     uint32_t window_rules_count;
+    gf_rule_memo_t rule_memo[GF_RULE_MEMO_SIZE];
     gf_rect_t exclude_zones[GF_MAX_EXCLUDE_ZONES];
     uint32_t exclude_zones_count;
 };
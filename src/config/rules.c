@@ -1,4 +1,5 @@
 #include "rules.h"
+#include "../utils/intern.h"
 #include "../utils/logger.h"
 #include "config.h"
 #include <ctype.h>
@@ -54,6 +55,7 @@ gf_rules_add (gf_config_t *cfg, const char *wm_class, gf_ws_id_t ws_id)
         if (class_matches (cfg->window_rules[i].wm_class, wm_class))
         {
             cfg->window_rules[i].workspace_id = ws_id;
+            gf_rules_memo_clear (cfg);
             GF_LOG_INFO ("Updated rule: %s → workspace %d", wm_class, ws_id);
 
             const char *path = gf_config_get_path ();
@@ -72,6 +74,7 @@ gf_rules_add (gf_config_t *cfg, const char *wm_class, gf_ws_id_t ws_id)
     rule->wm_class[GF_RULE_CLASS_MAX - 1] = '\0';
     rule->workspace_id = ws_id;
     cfg->window_rules_count++;
+    gf_rules_memo_clear (cfg);
 
     GF_LOG_INFO ("Added rule: %s → workspace %d", wm_class, ws_id);
 
@@ -98,6 +101,7 @@ gf_rules_remove (gf_config_t *cfg, const char *wm_class)
                 cfg->window_rules[j] = cfg->window_rules[j + 1];
             }
             cfg->window_rules_count--;
+            gf_rules_memo_clear (cfg);
 
             GF_LOG_INFO ("Removed rule for: %s", wm_class);
 
@@ -127,6 +131,34 @@ gf_rules_find (const gf_config_t *cfg, const char *wm_class)
     return NULL;
 }
 
+// Rule matching is a case-insensitive substring search, so it cannot be an id
+// compare; instead the answer for each name id is remembered until the rules
+// change. Names are stable per window, so after the first tick this is one
+// memo probe per call.
+const gf_window_rule_t *
+gf_rules_match (gf_config_t *cfg, gf_str_id_t name_id)
+{
+    if (!cfg || name_id == GF_STR_NONE)
+        return NULL;
+
+    gf_rule_memo_t *memo = &cfg->rule_memo[name_id % GF_RULE_MEMO_SIZE];
+    if (memo->name_id != name_id)
+    {
+        const gf_window_rule_t *rule = gf_rules_find (cfg, gf_intern_str (name_id));
+        memo->name_id = name_id;
+        memo->rule = rule ? (int16_t)(rule - cfg->window_rules) : -1;
+    }
+
+    return memo->rule >= 0 ? &cfg->window_rules[memo->rule] : NULL;
+}
+
+void
+gf_rules_memo_clear (gf_config_t *cfg)
+{
+    if (cfg)
+        memset (cfg->rule_memo, 0, sizeof (cfg->rule_memo));
+}
+
 uint32_t
 gf_rules_count (const gf_config_t *cfg)
 {
@@ -14,6 +14,17 @@ typedef struct
     gf_ws_id_t workspace_id;
 } gf_window_rule_t;
 
+// Memo of rule lookups by interned window name, direct-mapped on the id. A
+// zeroed memo is empty (GF_STR_NONE is never stored); it is cleared whenever
+// the rule set changes.
+#define GF_RULE_MEMO_SIZE 64
+
+typedef struct
+{
+    gf_str_id_t name_id;
+    int16_t rule; // index into window_rules, -1 for no match
+} gf_rule_memo_t;
+
 // Forward declaration
 struct gf_config;
 
@@ -21,6 +32,8 @@ struct gf_config;
 gf_err_t gf_rules_add (struct gf_config *cfg, const char *wm_class, gf_ws_id_t ws_id);
 gf_err_t gf_rules_remove (struct gf_config *cfg, const char *wm_class);
 const gf_window_rule_t *gf_rules_find (const struct gf_config *cfg, const char *wm_class);
+const gf_window_rule_t *gf_rules_match (struct gf_config *cfg, gf_str_id_t name_id);
+void gf_rules_memo_clear (struct gf_config *cfg);
 uint32_t gf_rules_count (const struct gf_config *cfg);
 
 #endif // GF_CONFIG_RULES_H
@@ -0,0 +1,163 @@
+#include "watch.h"
+#include "../utils/logger.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <limits.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+// Only events that leave a complete file behind: a writer closing it, or a
+// finished temp file renamed into place. Reacting to IN_CREATE or IN_MODIFY
+// would read half-written files, which the loader replaces with defaults.
+#define GF_CONFIG_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+gf_err_t
+gf_config_watch_init (gf_config_watch_t *watch, const char *path)
+{
+    if (!watch || !path)
+        return GF_ERROR_INVALID_PARAMETER;
+
+    watch->fd = -1;
+    watch->wd = -1;
+    watch->name[0] = '\0';
+
+    char dir[PATH_MAX];
+    const char *slash = strrchr (path, '/');
+    const char *base = slash ? slash + 1 : path;
+
+    if (slash)
+    {
+        size_t len = slash == path ? 1 : (size_t)(slash - path);
+        if (len >= sizeof (dir))
+            return GF_ERROR_INVALID_PARAMETER;
+        memcpy (dir, path, len);
+        dir[len] = '\0';
+    }
+    else
+    {
+        strcpy (dir, ".");
+    }
+
+    if (strlen (base) >= sizeof (watch->name))
+        return GF_ERROR_INVALID_PARAMETER;
+    strcpy (watch->name, base);
+
+    watch->fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0)
+    {
+        GF_LOG_WARN ("inotify_init1 failed: %s", strerror (errno));
+        return GF_ERROR_PLATFORM_ERROR;
+    }
+
+    watch->wd = inotify_add_watch (watch->fd, dir, GF_CONFIG_WATCH_MASK);
+    if (watch->wd < 0)
+    {
+        GF_LOG_WARN ("Failed to watch config directory %s: %s", dir, strerror (errno));
+        gf_config_watch_cleanup (watch);
+        return GF_ERROR_PLATFORM_ERROR;
+    }
+
+    GF_LOG_INFO ("Watching %s for config changes", dir);
+    return GF_SUCCESS;
+}
+
+void
+gf_config_watch_cleanup (gf_config_watch_t *watch)
+{
+    if (!watch || watch->fd < 0)
+        return;
+
+    close (watch->fd);
+    watch->fd = -1;
+    watch->wd = -1;
+}
+
+int
+gf_config_watch_fd (const gf_config_watch_t *watch)
+{
+    return watch ? watch->fd : -1;
+}
+
+bool
+gf_config_watch_drain (gf_config_watch_t *watch)
+{
+    char buffer[4096] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+    bool touched = false;
+    bool lost = false;
+
+    if (!watch || watch->fd < 0)
+        return false;
+
+    while (true)
+    {
+        ssize_t len = read (watch->fd, buffer, sizeof (buffer));
+        if (len <= 0)
+            break;
+
+        for (char *p = buffer; p < buffer + len;)
+        {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+
+            if (ev->mask & IN_IGNORED)
+                lost = true;
+            else if (ev->mask & IN_Q_OVERFLOW)
+                touched = true;
+            else if (ev->len > 0 && strcmp (ev->name, watch->name) == 0)
+                touched = true;
+
+            p += sizeof (struct inotify_event) + ev->len;
+        }
+    }
+
+    if (lost)
+    {
+        GF_LOG_WARN ("Config directory watch removed, falling back to polling");
+        gf_config_watch_cleanup (watch);
+        touched = true;
+    }
+
+    return touched;
+}
+
+#else
+
+gf_err_t
+gf_config_watch_init (gf_config_watch_t *watch, const char *path)
+{
+    (void)path;
+    if (!watch)
+        return GF_ERROR_INVALID_PARAMETER;
+
+    watch->fd = -1;
+    watch->wd = -1;
+    watch->name[0] = '\0';
+    return GF_ERROR_PLATFORM_ERROR;
+}
+
+void
+gf_config_watch_cleanup (gf_config_watch_t *watch)
+{
+    (void)watch;
+}
+
+int
+gf_config_watch_fd (const gf_config_watch_t *watch)
+{
+    (void)watch;
+    return -1;
+}
+
+bool
+gf_config_watch_drain (gf_config_watch_t *watch)
+{
+    (void)watch;
+    return false;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef GF_CONFIG_WATCH_H
+#define GF_CONFIG_WATCH_H
+
+#include "../core/types.h"
+#include <stdbool.h>
+
+/*
+ * Config file change notification. On Linux the watch sits on the config
+ * directory rather than the file, so editors that save by writing a temp file
+ * and renaming it over config.json are still seen. Elsewhere init fails and
+ * callers fall back to polling the file's mtime.
+ */
+typedef struct
+{
+    int fd;
+    int wd;
+    char name[256]; // basename of the config file inside the watched directory
+} gf_config_watch_t;
+
+gf_err_t gf_config_watch_init (gf_config_watch_t *watch, const char *path);
+void gf_config_watch_cleanup (gf_config_watch_t *watch);
+
+// Pollable descriptor, or -1 when no watch is active.
+int gf_config_watch_fd (const gf_config_watch_t *watch);
+
+// Consume pending notifications; true when any of them touched the config
+// file. If the directory itself goes away the watch is dropped and later
+// calls report -1 from gf_config_watch_fd.
+bool gf_config_watch_drain (gf_config_watch_t *watch);
+
+#endif
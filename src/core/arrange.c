@@ -14,7 +14,7 @@
 #include <time.h>
 
 gf_err_t
-gf_wm_calculate_layout (gf_wm_t *m, gf_win_info_t *windows, uint32_t window_count,
+gf_wm_calculate_layout (gf_wm_t *m, gf_win_info_t *const *windows, uint32_t window_count,
                         gf_monitor_id_t mon_id, gf_rect_t **out_geometries)
 {
     if (!m || !windows || !out_geometries || window_count == 0)
@@ -40,7 +40,7 @@ gf_wm_calculate_layout (gf_wm_t *m, gf_win_info_t *windows, uint32_t window_coun
             return GF_ERROR_DISPLAY_CONNECTION;
     }
 
-    gf_rect_t *new_geometries = gf_malloc (window_count * sizeof (gf_rect_t));
+    gf_rect_t *new_geometries = gf_scratch_alloc (window_count * sizeof (gf_rect_t));
     if (!new_geometries)
         return GF_ERROR_MEMORY_ALLOCATION;
 
@@ -66,35 +66,48 @@ calc_ws_max_wins (const gf_rect_t *bounds, const gf_config_t *config)
     return (config_max < auto_max) ? config_max : auto_max;
 }
 
-void
-gf_wm_apply_layout (gf_wm_t *m, gf_win_info_t *windows, gf_rect_t *geometry,
+// Place each pending window and read back where it actually landed (size
+// hints and frames can move it), straight into its record. Clearing the
+// workspace's update flags is left to the caller, once every monitor is done.
+uint32_t
+gf_wm_apply_layout (gf_wm_t *m, gf_win_info_t *const *windows, const gf_rect_t *geometry,
                     uint32_t window_count)
 {
     if (!m || !windows || !geometry || window_count == 0)
-        return;
+        return 0;
 
-    gf_win_list_t *window_list = wm_windows (m);
     gf_platform_t *platform = wm_platform (m);
     gf_display_t display = *wm_display (m);
+    uint32_t placed = 0;
 
     for (uint32_t i = 0; i < window_count; i++)
     {
-        if (wm_is_excluded (m, windows[i].id))
+        gf_win_info_t *win = windows[i];
+
+        if (wm_is_excluded (m, win->id))
             continue;
-        if (!windows[i].needs_update)
+        if (!win->needs_update)
             continue;
-        if (windows[i].is_minimized || !windows[i].is_valid)
+        if (win->is_minimized || !win->is_valid)
             continue;
 
         gf_err_t result = platform->window_set_geometry (
-            display, windows[i].id, &geometry[i], GF_GEOMETRY_CHANGE_ALL, m->config);
+            display, win->id, &geometry[i], GF_GEOMETRY_CHANGE_ALL, m->config);
 
         if (result != GF_SUCCESS)
-            GF_LOG_WARN ("Failed to set geometry for window %p", (void *)windows[i].id);
+            GF_LOG_WARN ("Failed to set geometry for window %p", (void *)win->id);
 
-        gf_wm_window_sync (m, windows[i].id, windows[i].workspace_id);
-        gf_window_list_clear_update_flags (window_list, windows[i].workspace_id);
+        gf_rect_t actual;
+        if (platform->window_get_geometry (display, win->id, &actual) == GF_SUCCESS
+            && !gf_rect_equals (&actual, &win->geometry))
+        {
+            win->geometry = actual;
+            win->last_modified = time (NULL);
+        }
+        placed++;
     }
+
+    return placed;
 }
 
 static uint32_t
@@ -118,53 +131,59 @@ enumerate_monitors (gf_platform_t *platform, gf_display_t display, gf_monitor_t
     return count;
 }
 
-static void
-filter_monitor_windows (gf_win_info_t *ws_wins, uint32_t ws_count, gf_monitor_t *mon,
-                        uint32_t monitor_count, gf_win_info_t *out, uint32_t *out_count,
-                        gf_wm_t *m, gf_ws_info_t *ws)
+typedef struct
 {
-    *out_count = 0;
-    for (uint32_t j = 0; j < ws_count; j++)
-    {
-        if (ws_wins[j].is_maximized && !ws->has_maximized_state)
-            continue;
-        if (ws_wins[j].is_minimized || wm_is_excluded (m, ws_wins[j].id))
-            continue;
-        if (monitor_count > 1 && ws_wins[j].monitor_id != mon->id)
-            continue;
-        out[(*out_count)++] = ws_wins[j];
-    }
+    gf_wm_t *m;
+    const gf_ws_info_t *ws;
+    const gf_monitor_t *mon;
+    uint32_t monitor_count;
+} monitor_filter_t;
+
+// Windows that take a tile on the given monitor
+static bool
+monitor_window_tiles (const gf_win_info_t *win, void *ctx)
+{
+    const monitor_filter_t *f = ctx;
+
+    if (win->is_maximized && !f->ws->has_maximized_state)
+        return false;
+    if (win->is_minimized || wm_is_excluded (f->m, win->id))
+        return false;
+    if (f->monitor_count > 1 && win->monitor_id != f->mon->id)
+        return false;
+    return true;
 }
 
-static void
-apply_layout_to_monitor (gf_wm_t *m, gf_ws_info_t *ws, gf_monitor_t *mon,
-                         gf_win_info_t *ws_wins, uint32_t ws_count,
-                         uint32_t monitor_count)
+static bool
+window_not_minimized (const gf_win_info_t *win, void *ctx)
+{
+    (void)ctx;
+    return !win->is_minimized;
+}
+
+// Lay out the windows the iterator yields on one monitor; returns how many
+// were placed.
+static uint32_t
+layout_view (gf_wm_t *m, gf_ws_iter_t *it, uint32_t max, gf_monitor_id_t mon_id)
 {
     gf_platform_t *platform = wm_platform (m);
 
-    gf_win_info_t *mon_wins = gf_malloc (ws_count * sizeof (gf_win_info_t));
-    if (!mon_wins)
-        return;
+    gf_win_info_t **view = gf_scratch_alloc (max * sizeof (gf_win_info_t *));
+    if (!view)
+        return 0;
 
-    uint32_t mon_count = 0;
-    filter_monitor_windows (ws_wins, ws_count, mon, monitor_count, mon_wins, &mon_count,
-                            m, ws);
+    uint32_t count = gf_ws_iter_collect (it, view, max);
+    if (count == 0)
+        return 0;
 
-    if (mon_count > 0)
-    {
-        gf_rect_t *new_geoms = NULL;
-        if (gf_wm_calculate_layout (m, mon_wins, mon_count, mon->id, &new_geoms)
-            == GF_SUCCESS)
-        {
-            gf_wm_apply_layout (m, mon_wins, new_geoms, mon_count);
-            if (m->config->enable_borders && platform->border_update)
-                platform->border_update (platform, m->config);
-            gf_free (new_geoms);
-        }
-    }
+    gf_rect_t *new_geoms = NULL;
+    if (gf_wm_calculate_layout (m, view, count, mon_id, &new_geoms) != GF_SUCCESS)
+        return 0;
 
-    gf_free (mon_wins);
+    uint32_t placed = gf_wm_apply_layout (m, view, new_geoms, count);
+    if (m->config->enable_borders && platform->border_update)
+        platform->border_update (platform, m->config);
+    return placed;
 }
 
 static void
@@ -172,22 +191,27 @@ apply_layout_to_workspace (gf_wm_t *m, gf_ws_info_t *ws, gf_monitor_t *monitors,
                            uint32_t monitor_count)
 {
     gf_win_list_t *windows = wm_windows (m);
-    gf_win_info_t *ws_wins = NULL;
-    uint32_t ws_count = 0;
+    uint32_t ws_count = gf_window_list_count_by_workspace (windows, ws->id);
+    uint32_t placed = 0;
 
-    if (gf_window_list_get_by_workspace (windows, ws->id, &ws_wins, &ws_count)
-            != GF_SUCCESS
-        || ws_count == 0)
-    {
-        gf_free (ws_wins);
+    if (ws_count == 0)
         return;
-    }
 
     for (uint32_t mon_idx = 0; mon_idx < monitor_count; mon_idx++)
-        apply_layout_to_monitor (m, ws, &monitors[mon_idx], ws_wins, ws_count,
-                                 monitor_count);
+    {
+        monitor_filter_t filter = { m, ws, &monitors[mon_idx], monitor_count };
+        gf_ws_iter_t it;
+
+        gf_ws_iter_init (&it, windows, ws->id, monitor_window_tiles, &filter);
+        placed += layout_view (m, &it, ws_count, monitors[mon_idx].id);
+    }
 
-    gf_free (ws_wins);
+    if (placed > 0)
+    {
+        gf_window_list_clear_update_flags (windows, ws->id);
+        gf_wm_notify (m, GF_IPC_TOPIC_LAYOUT_APPLIED, (uint32_t)ws->id, "%d %u", ws->id,
+                      placed);
+    }
 }
 
 gf_err_t
@@ -248,64 +272,37 @@ relocate_overflow_window (gf_wm_t *m, gf_ws_info_t *src_ws, gf_ws_id_t dst_id,
 {
     gf_win_list_t *windows = wm_windows (m);
     gf_ws_list_t *workspaces = wm_workspaces (m);
-    gf_platform_t *platform = wm_platform (m);
-    uint32_t max_per_ws = m->config->max_windows_per_workspace;
 
-    for (uint32_t w = 0; w < windows->count; w++)
-    {
-        if (windows->items[w].id != win->id || wm_is_excluded (m, win->id))
-            continue;
+    if (wm_is_excluded (m, win->id))
+        return;
 
-        GF_LOG_INFO ("Move window %p from workspace %u to workspace %u",
-                     (void *)windows->items[w].id, windows->items[w].workspace_id,
-                     dst_id);
+    GF_LOG_INFO ("Move window %p from workspace %u to workspace %u", (void *)win->id,
+                 win->workspace_id, dst_id);
 
-        windows->items[w].workspace_id = dst_id;
+    gf_window_list_set_workspace (windows, win, dst_id);
 
-        gf_ws_info_t *dst_ws = gf_workspace_list_find_by_id (workspaces, dst_id);
-        if (dst_ws)
-        {
-            dst_ws->window_count++;
-            dst_ws->available_space--;
-        }
-        src_ws->window_count--;
-        src_ws->available_space++;
-
-        gf_window_list_mark_all_needs_update (windows, &src_ws->id);
-        src_ws->is_custom_layout = false;
-        gf_window_list_mark_all_needs_update (windows, &dst_id);
-        if (dst_ws)
-            dst_ws->is_custom_layout = false;
-
-        /* Re-layout destination */
-        gf_win_info_t *mon_wins = gf_malloc (windows->count * sizeof (gf_win_info_t));
-        if (!mon_wins)
-            break;
-
-        uint32_t mon_count = 0;
-        for (uint32_t k = 0; k < windows->count; k++)
-        {
-            if (windows->items[k].workspace_id == dst_id
-                && !windows->items[k].is_minimized)
-                mon_wins[mon_count++] = windows->items[k];
-        }
-
-        if (mon_count > 0)
-        {
-            gf_rect_t *new_geoms = NULL;
-            if (gf_wm_calculate_layout (m, mon_wins, mon_count, win->monitor_id,
-                                        &new_geoms)
-                == GF_SUCCESS)
-            {
-                gf_wm_apply_layout (m, mon_wins, new_geoms, mon_count);
-                if (m->config->enable_borders && platform->border_update)
-                    platform->border_update (platform, m->config);
-                gf_free (new_geoms);
-            }
-        }
-        gf_free (mon_wins);
-        break;
+    gf_ws_info_t *dst_ws = gf_workspace_list_find_by_id (workspaces, dst_id);
+    if (dst_ws)
+    {
+        dst_ws->window_count++;
+        dst_ws->available_space--;
     }
+    src_ws->window_count--;
+    src_ws->available_space++;
+
+    gf_window_list_mark_all_needs_update (windows, &src_ws->id);
+    src_ws->is_custom_layout = false;
+    gf_window_list_mark_all_needs_update (windows, &dst_id);
+    if (dst_ws)
+        dst_ws->is_custom_layout = false;
+
+    /* Re-layout destination */
+    gf_ws_iter_t it;
+    gf_ws_iter_init (&it, windows, dst_id, window_not_minimized, NULL);
+    if (layout_view (m, &it, gf_window_list_count_by_workspace (windows, dst_id),
+                     win->monitor_id)
+        > 0)
+        gf_window_list_clear_update_flags (windows, dst_id);
 }
 
 static gf_err_t
@@ -324,21 +321,14 @@ rebalance_workspace (gf_wm_t *m, gf_ws_info_t *src_ws)
             return GF_ERROR_INVALID_PARAMETER;
         }
 
-        gf_win_info_t *list = NULL;
-        uint32_t count = 0;
-
-        if (gf_window_list_get_by_workspace (windows, src_ws->id, &list, &count)
-                != GF_SUCCESS
-            || count == 0)
-        {
-            gf_free (list);
+        gf_ws_iter_t it;
+        gf_ws_iter_init (&it, windows, src_ws->id, NULL, NULL);
+        gf_win_info_t *first = gf_ws_iter_next (&it);
+        if (!first)
             break;
-        }
 
         if (src_ws->id != dst_id)
-            relocate_overflow_window (m, src_ws, dst_id, &list[0]);
-
-        gf_free (list);
+            relocate_overflow_window (m, src_ws, dst_id, first);
     }
 
     return GF_SUCCESS;
@@ -370,8 +360,7 @@ enforce_fullscreen (gf_wm_t *m)
     gf_win_list_t *windows = wm_windows (m);
     gf_handle_t active = m->platform->window_get_focused (m->display);
 
-    if (active == 0
-        || !m->platform->window_is_fullscreen (m->display, (gf_handle_t)active))
+    if (active == 0 || !(wm_window_state (m, active) & GF_WIN_STATE_FULLSCREEN))
         return;
 
     gf_monitor_id_t active_monitor = find_active_monitor (m);
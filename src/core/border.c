@@ -57,7 +57,6 @@ _borders_apply_to_workspace (gf_wm_t *m, gf_ws_id_t workspace)
         }
     }
 
-    gf_free (wins);
 }
 
 static void
@@ -82,8 +81,9 @@ gf_border_enable_all (gf_wm_t *m)
     if (m->platform->border_cleanup)
         m->platform->border_cleanup (m->platform);
 
-    for (gf_ws_id_t ws = 0; ws < GF_MAX_WORKSPACES; ws++)
-        _borders_apply_to_workspace (m, ws);
+    gf_ws_list_t *workspaces = wm_workspaces (m);
+    for (uint32_t i = 0; i < workspaces->count; i++)
+        _borders_apply_to_workspace (m, workspaces->items[i].id);
 
     /* Fallback: catch any windows tracked in the current list */
     _borders_apply_to_current_windows (m);
@@ -0,0 +1,316 @@
+#include "../utils/logger.h"
+#include "../utils/memory.h"
+#include "internal.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Change tracking for delta queries. Instead of instrumenting every place
+ * that writes a record, a sweep hashes the client-visible fields of each
+ * window and workspace and compares them with the digest stored in the
+ * record at the previous sweep. Records that differ, and records the lists
+ * have just added (generation 0), are stamped with the next generation.
+ * Removals are found by checking the keys seen at the previous sweep, which
+ * is only needed when something was added or the count moved.
+ *
+ * An idle sweep is one hash per record, cheap enough to run after every tick.
+ * What a sweep finds is also what subscribers hear about: added, removed and
+ * moved windows, workspace switches and focus changes are all published from
+ * here rather than from the code paths that cause them.
+ */
+
+#define GF_FNV_OFFSET 2166136261u
+#define GF_FNV_PRIME 16777619u
+
+// Event payloads print handles as 0x%llx: %p output is up to the libc (glibc
+// prints "(nil)" for no focus), and the protocol must not be.
+#define GF_HANDLE_ARG(h) ((unsigned long long)(uintptr_t)(h))
+
+static uint32_t
+_changes_hash (uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ p[i]) * GF_FNV_PRIME;
+    return hash;
+}
+
+// needs_update and last_modified are bookkeeping that moves without the
+// window changing, so they stay out of the digest
+static uint32_t
+_window_digest (const gf_win_info_t *win)
+{
+    uint8_t flags = (uint8_t)(win->is_maximized | win->is_minimized << 1
+                              | win->is_valid << 2);
+
+    uint32_t h = GF_FNV_OFFSET;
+    h = _changes_hash (h, &win->workspace_id, sizeof (win->workspace_id));
+    h = _changes_hash (h, &win->monitor_id, sizeof (win->monitor_id));
+    h = _changes_hash (h, &win->geometry, sizeof (win->geometry));
+    h = _changes_hash (h, &flags, sizeof (flags));
+    h = _changes_hash (h, &win->name_id, sizeof (win->name_id));
+    return h;
+}
+
+static uint32_t
+_workspace_digest (const gf_ws_info_t *ws)
+{
+    uint8_t flags = (uint8_t)(ws->is_locked | ws->has_maximized_state << 1
+                              | ws->is_custom_layout << 2 | ws->has_rule << 3);
+
+    uint32_t h = GF_FNV_OFFSET;
+    h = _changes_hash (h, &ws->window_count, sizeof (ws->window_count));
+    h = _changes_hash (h, &ws->max_windows, sizeof (ws->max_windows));
+    h = _changes_hash (h, &ws->available_space, sizeof (ws->available_space));
+    h = _changes_hash (h, &flags, sizeof (flags));
+    return h;
+}
+
+static void
+_changes_bury (gf_wm_changes_t *c, uint64_t key, uint64_t generation)
+{
+    gf_wm_tombstone_t *slot = &c->removed[c->removed_next];
+
+    // Whoever is older than the entry being overwritten can no longer be
+    // told about it
+    if (c->removed_count == GF_WM_TOMBSTONES)
+        c->floor = slot->generation;
+    else
+        c->removed_count++;
+
+    slot->key = key;
+    slot->generation = generation;
+    c->removed_next = (c->removed_next + 1) % GF_WM_TOMBSTONES;
+}
+
+// Room for count keys; the old contents are about to be rewritten anyway
+static bool
+_changes_reserve (gf_wm_changes_t *c, uint32_t count)
+{
+    if (count <= c->key_capacity)
+        return true;
+
+    uint32_t capacity = c->key_capacity ? c->key_capacity : 16;
+    while (capacity < count)
+        capacity *= 2;
+
+    uint64_t *keys = gf_malloc (capacity * sizeof (uint64_t));
+    if (!keys)
+        return false;
+
+    gf_free (c->keys);
+    c->keys = keys;
+    c->key_capacity = capacity;
+    return true;
+}
+
+// Without the key set removals go unseen, so every delta becomes a reset
+// until a sweep manages to record it again.
+static void
+_changes_lost (gf_wm_changes_t *c, uint64_t generation)
+{
+    GF_LOG_WARN ("Change tracking lost its key set; next deltas will be full");
+    c->floor = generation;
+    c->key_count = 0;
+}
+
+static bool
+_sweep_windows (gf_wm_t *m, uint64_t next)
+{
+    gf_win_list_t *windows = wm_windows (m);
+    gf_wm_changes_t *c = &m->state.window_changes;
+    bool changed = false;
+
+    for (uint32_t i = 0; i < windows->count; i++)
+    {
+        gf_win_info_t *win = &windows->items[i];
+        uint32_t digest = _window_digest (win);
+        if (digest != win->digest || win->generation == 0)
+        {
+            if (win->generation == 0)
+                gf_wm_notify (m, GF_IPC_TOPIC_WINDOW_ADDED, (uintptr_t)win->id,
+                              "0x%llx %d", GF_HANDLE_ARG (win->id), win->workspace_id);
+            else
+                gf_wm_notify (m, GF_IPC_TOPIC_WINDOW_MOVED, (uintptr_t)win->id,
+                              "0x%llx %d %d %d %d %d", GF_HANDLE_ARG (win->id),
+                              win->workspace_id, win->geometry.x, win->geometry.y,
+                              win->geometry.width, win->geometry.height);
+
+            win->digest = digest;
+            win->generation = next;
+            changed = true;
+        }
+    }
+
+    for (uint32_t i = 0; i < GF_MAX_MONITORS; i++)
+    {
+        gf_handle_t focus = m->state.last_active_window[i];
+        if (focus != c->focus[i])
+        {
+            c->focus[i] = focus;
+            gf_wm_notify (m, GF_IPC_TOPIC_FOCUS_CHANGED, i, "%u 0x%llx", i,
+                          GF_HANDLE_ARG (focus));
+        }
+    }
+
+    if (!changed && windows->count == c->key_count)
+        return false;
+
+    for (uint32_t i = 0; i < c->key_count; i++)
+    {
+        gf_handle_t id = (gf_handle_t)(uintptr_t)c->keys[i];
+        if (!gf_window_list_find_by_window_id (windows, id))
+        {
+            gf_wm_notify (m, GF_IPC_TOPIC_WINDOW_REMOVED, c->keys[i], "0x%llx",
+                          GF_HANDLE_ARG (id));
+            _changes_bury (c, c->keys[i], next);
+            changed = true;
+        }
+    }
+
+    if (!_changes_reserve (c, windows->count))
+    {
+        _changes_lost (c, next);
+        return true;
+    }
+
+    for (uint32_t i = 0; i < windows->count; i++)
+        c->keys[i] = (uint64_t)(uintptr_t)windows->items[i].id;
+    c->key_count = windows->count;
+    return changed;
+}
+
+static bool
+_sweep_workspaces (gf_wm_t *m, uint64_t next)
+{
+    gf_ws_list_t *workspaces = wm_workspaces (m);
+    gf_wm_changes_t *c = &m->state.workspace_changes;
+    bool changed = false;
+
+    for (uint32_t i = 0; i < GF_MAX_MONITORS; i++)
+    {
+        uint32_t active = workspaces->active_workspace[i];
+        if (active != c->active[i])
+        {
+            c->active[i] = active;
+            gf_wm_notify (m, GF_IPC_TOPIC_WORKSPACE_SWITCHED, i, "%u %u", i, active);
+            changed = true;
+        }
+    }
+
+    bool records_changed = false;
+    for (uint32_t i = 0; i < workspaces->count; i++)
+    {
+        gf_ws_info_t *ws = &workspaces->items[i];
+        uint32_t digest = _workspace_digest (ws);
+        if (digest != ws->digest || ws->generation == 0)
+        {
+            ws->digest = digest;
+            ws->generation = next;
+            records_changed = true;
+        }
+    }
+
+    if (!records_changed && workspaces->count == c->key_count)
+        return changed;
+
+    for (uint32_t i = 0; i < c->key_count; i++)
+    {
+        gf_ws_id_t id = (gf_ws_id_t)(uint32_t)c->keys[i];
+        if (!gf_workspace_list_find_by_id (workspaces, id))
+            _changes_bury (c, c->keys[i], next);
+    }
+
+    if (!_changes_reserve (c, workspaces->count))
+    {
+        _changes_lost (c, next);
+        return true;
+    }
+
+    for (uint32_t i = 0; i < workspaces->count; i++)
+        c->keys[i] = (uint32_t)workspaces->items[i].id;
+    c->key_count = workspaces->count;
+    return true;
+}
+
+void
+gf_wm_changes_init (gf_wm_t *m)
+{
+    // Seeded from the clock so a restarted daemon never hands out numbers a
+    // client may still hold from the previous run
+    uint64_t start = (uint64_t)time (NULL) << 20;
+
+    m->state.generation = start;
+    m->state.window_changes.floor = start;
+    m->state.workspace_changes.floor = start;
+}
+
+void
+gf_wm_changes_sweep (gf_wm_t *m)
+{
+    uint64_t next = m->state.generation + 1;
+
+    bool windows_changed = _sweep_windows (m, next);
+    bool workspaces_changed = _sweep_workspaces (m, next);
+
+    if (windows_changed || workspaces_changed)
+        m->state.generation = next;
+}
+
+void
+gf_wm_changes_since (const gf_wm_t *m, const gf_wm_changes_t *changes, uint64_t since,
+                     gf_wire_delta_t *delta)
+{
+    memset (delta, 0, sizeof (*delta));
+    delta->generation = m->state.generation;
+    delta->reset = since < changes->floor || since > m->state.generation;
+
+    if (delta->reset || changes->removed_count == 0)
+        return;
+
+    delta->removed = gf_scratch_alloc (changes->removed_count * sizeof (uint64_t));
+    if (!delta->removed)
+    {
+        delta->reset = true;
+        return;
+    }
+
+    for (uint32_t i = 0; i < changes->removed_count; i++)
+    {
+        const gf_wm_tombstone_t *t = &changes->removed[i];
+        if (t->generation > since)
+            delta->removed[delta->removed_count++] = t->key;
+    }
+}
+
+void
+gf_wm_notify (gf_wm_t *m, uint32_t topic, uint64_t key, const char *fmt, ...)
+{
+    if (m->ipc_handle < 0 || !gf_ipc_server_subscribed (m->ipc_handle, topic))
+        return;
+
+    char event[GF_IPC_EVENT_SIZE];
+    int len = snprintf (event, sizeof (event), "%s", gf_ipc_topic_name (topic));
+
+    if (fmt && len > 0 && (size_t)len < sizeof (event) - 1)
+    {
+        va_list args;
+        va_start (args, fmt);
+        event[len++] = ' ';
+        vsnprintf (event + len, sizeof (event) - (size_t)len, fmt, args);
+        va_end (args);
+    }
+
+    gf_ipc_server_publish (m->ipc_handle, topic, key, event);
+}
+
+void
+gf_wm_changes_cleanup (gf_wm_t *m)
+{
+    gf_free (m->state.window_changes.keys);
+    gf_free (m->state.workspace_changes.keys);
+    m->state.window_changes.keys = NULL;
+    m->state.workspace_changes.keys = NULL;
+}
@@ -6,6 +6,7 @@
 #include "layout.h"
 #include "types.h"
 #include "wm.h"
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -104,3 +105,152 @@ gf_wm_debug_stats (const gf_wm_t *m)
 
     gf_free (workspace_counts);
 }
+
+// Append to a fixed buffer; the cursor stops at the end instead of overrunning.
+static size_t
+_stats_append (char *buffer, size_t size, size_t pos, const char *fmt, ...)
+{
+    if (pos >= size)
+        return pos;
+
+    va_list ap;
+    va_start (ap, fmt);
+    int n = vsnprintf (buffer + pos, size - pos, fmt, ap);
+    va_end (ap);
+
+    if (n < 0)
+        return pos;
+    return (pos + (size_t)n < size) ? pos + (size_t)n : size - 1;
+}
+
+static size_t
+_stats_row (char *buffer, size_t size, size_t pos, const char *name,
+            const gf_prof_hist_t *h)
+{
+    double avg = h->count ? (double)h->total_ns / (double)h->count : 0.0;
+    return _stats_append (buffer, size, pos,
+                          "%-14s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f\n", name,
+                          (unsigned long long)h->count, avg / 1000.0,
+                          gf_prof_percentile (h, 500) / 1000.0,
+                          gf_prof_percentile (h, 950) / 1000.0,
+                          gf_prof_percentile (h, 990) / 1000.0, h->max_ns / 1000.0);
+}
+
+// Display-server calls per phase run; calls made outside a tick are totals.
+static size_t
+_stats_calls_row (char *buffer, size_t size, size_t pos, const char *name,
+                  uint32_t scope, uint64_t runs)
+{
+    pos = _stats_append (buffer, size, pos, "%-14s", name);
+    for (int c = 0; c < GF_PROF_CALL_COUNT; c++)
+    {
+        uint64_t n = gf_prof_calls (scope, (gf_prof_call_t)c);
+        double value = runs ? (double)n / (double)runs : (double)n;
+        pos = _stats_append (buffer, size, pos, " %12.2f", value);
+    }
+    return _stats_append (buffer, size, pos, "\n");
+}
+
+// Render the tick profile as a text table (times in microseconds), followed
+// by the display-server calls each phase issues.
+size_t
+gf_wm_stats_format (const gf_wm_t *m, char *buffer, size_t size)
+{
+    if (!m || !buffer || size == 0)
+        return 0;
+
+    const gf_wm_stats_t *stats = &m->stats;
+    double window_s = (double)(gf_prof_now_ns () - stats->since_ns) / 1e9;
+    size_t pos = 0;
+
+    buffer[0] = '\0';
+    pos = _stats_append (buffer, size, pos, "Tick profile over %.1f s (times in us)\n",
+                         window_s);
+    pos = _stats_append (buffer, size, pos, "%-14s %10s %9s %9s %9s %9s %9s\n", "phase",
+                         "count", "avg", "p50", "p95", "p99", "max");
+
+    for (int i = 0; i < GF_WM_PHASE_COUNT; i++)
+        pos = _stats_row (buffer, size, pos, gf_wm_phase_name (i), &stats->phases[i]);
+
+    pos = _stats_row (buffer, size, pos, "tick", &stats->tick);
+
+    double allocs_per_tick = 0.0;
+    if (stats->tick.count)
+        allocs_per_tick = (double)stats->tick_allocs / (double)stats->tick.count;
+    pos = _stats_append (buffer, size, pos,
+                         "\nHeap allocations per tick: %.2f (last %llu), scratch "
+                         "high-water %zu bytes\n",
+                         allocs_per_tick, (unsigned long long)stats->last_tick_allocs,
+                         gf_scratch_high_water ());
+
+    pos = _stats_append (buffer, size, pos,
+                         "\nServer calls per run (idle: totals)\n%-14s", "phase");
+    for (int c = 0; c < GF_PROF_CALL_COUNT; c++)
+        pos = _stats_append (buffer, size, pos, " %12s",
+                             gf_prof_call_name ((gf_prof_call_t)c));
+    pos = _stats_append (buffer, size, pos, "\n");
+
+    for (int i = 0; i < GF_WM_PHASE_COUNT; i++)
+        pos = _stats_calls_row (buffer, size, pos, gf_wm_phase_name (i), (uint32_t)i,
+                                stats->phases[i].count);
+    pos = _stats_calls_row (buffer, size, pos, "idle", GF_PROF_SCOPE_IDLE, 0);
+    return pos;
+}
+
+// Render the per-subsystem heap accounting: bytes held now and at the peak,
+// and the allocations and frees charged to each tag since startup.
+size_t
+gf_wm_memory_format (char *buffer, size_t size)
+{
+    if (!buffer || size == 0)
+        return 0;
+
+    size_t pos = 0;
+    buffer[0] = '\0';
+
+    if (!gf_mem_tracking_enabled ())
+        return _stats_append (buffer, size, pos,
+                              "Memory tracking disabled (built without "
+                              "GF_MEM_TRACKING)\n");
+
+    gf_mem_stats_t total = { 0 };
+    pos = _stats_append (buffer, size, pos, "%-10s %12s %12s %12s %12s %10s\n", "tag",
+                         "live_bytes", "peak_bytes", "allocs", "frees", "blocks");
+
+    for (int t = 0; t < GF_MEM_TAG_COUNT; t++)
+    {
+        gf_mem_stats_t st;
+        gf_mem_stats ((gf_mem_tag_t)t, &st);
+        pos = _stats_append (
+            buffer, size, pos, "%-10s %12llu %12llu %12llu %12llu %10llu\n",
+            gf_mem_tag_name ((gf_mem_tag_t)t), (unsigned long long)st.live_bytes,
+            (unsigned long long)st.peak_bytes, (unsigned long long)st.allocs,
+            (unsigned long long)st.frees, (unsigned long long)(st.allocs - st.frees));
+        total.live_bytes += st.live_bytes;
+        total.allocs += st.allocs;
+        total.frees += st.frees;
+    }
+
+    // Tags peak at different times, so no total peak is shown
+    pos = _stats_append (buffer, size, pos, "%-10s %12llu %12s %12llu %12llu %10llu\n",
+                         "total", (unsigned long long)total.live_bytes, "-",
+                         (unsigned long long)total.allocs,
+                         (unsigned long long)total.frees,
+                         (unsigned long long)(total.allocs - total.frees));
+    return pos;
+}
+
+void
+gf_wm_stats_reset (gf_wm_t *m)
+{
+    if (!m)
+        return;
+
+    for (int i = 0; i < GF_WM_PHASE_COUNT; i++)
+        gf_prof_reset (&m->stats.phases[i]);
+    gf_prof_reset (&m->stats.tick);
+    gf_prof_calls_reset ();
+    m->stats.tick_allocs = 0;
+    m->stats.last_tick_allocs = 0;
+    m->stats.since_ns = gf_prof_now_ns ();
+}
@@ -79,14 +79,16 @@ gf_wm_keymap_event (gf_wm_t *m)
     workspaces->active_workspace[active_monitor] = target_ws;
     m->state.last_active_workspace[active_monitor] = target_ws;
 
-    gf_win_list_t *windows = wm_windows (m);
-    for (uint32_t i = 0; i < windows->count; i++)
+    gf_ws_iter_t it;
+    gf_win_info_t *win;
+    gf_ws_iter_init (&it, wm_windows (m), target_ws, NULL, NULL);
+    while ((win = gf_ws_iter_next (&it)))
     {
-        if (windows->items[i].workspace_id == target_ws && windows->items[i].is_valid)
+        if (win->is_valid)
         {
             if (platform->window_unminimize)
-                platform->window_unminimize (display, windows->items[i].id);
-            m->state.last_active_window[active_monitor] = windows->items[i].id;
+                platform->window_unminimize (display, win->id);
+            m->state.last_active_window[active_monitor] = win->id;
             break;
         }
     }
@@ -94,27 +96,96 @@ gf_wm_keymap_event (gf_wm_t *m)
     GF_LOG_INFO ("Keymap: switched to workspace %d", target_ws);
 }
 
-void
-gf_wm_watch (gf_wm_t *m)
+// Fold one enumerated window into the managed list.
+static void
+watch_window (gf_wm_t *m, gf_win_info_t *win)
 {
-    if (!m)
+    gf_platform_t *platform = wm_platform (m);
+    gf_ws_list_t *workspaces = wm_workspaces (m);
+    gf_win_list_t *windows = wm_windows (m);
+
+    if (!win->is_valid || wm_is_excluded (m, win->id))
         return;
 
+    if (platform->monitor_from_window)
+        win->monitor_id = platform->monitor_from_window (platform, win->id);
+
+    gf_win_info_t *existing = gf_window_list_find_by_window_id (windows, win->id);
+
+    if (!existing)
+    {
+        register_new_window (m, win, NULL);
+        return;
+    }
+
+    win->workspace_id = existing->workspace_id;
+    win->name_id = gf_wm_resolve_window_name (m, win->id, existing->name_id);
+
+    const gf_window_rule_t *rule = gf_rules_match (m->config, win->name_id);
+
+    gf_ws_info_t *current_ws
+        = gf_workspace_list_find_by_id (workspaces, win->workspace_id);
+
+    if (current_ws && !rule && current_ws->has_rule)
+    {
+        gf_ws_id_t free_ws = gf_workspace_list_find_free (workspaces);
+        if (gf_workspace_list_find_by_id (workspaces, free_ws))
+            move_window_to_workspace (m, win, free_ws);
+    }
+
+    win->is_maximized = existing->is_maximized;
+    win->is_minimized = existing->is_minimized;
+
+    if (win->is_minimized)
+        win->geometry = existing->geometry;
+
+    gf_window_list_update (windows, win);
+}
+
+// Full rescan through the single-pass enumeration: one walk of the client
+// list, then each tracked workspace consumes its own desktop bucket.
+static void
+watch_rescan_buckets (gf_wm_t *m)
+{
     gf_platform_t *platform = wm_platform (m);
     gf_ws_list_t *workspaces = wm_workspaces (m);
-    gf_win_list_t *windows = wm_windows (m);
-    gf_display_t display = *wm_display (m);
+    gf_win_buckets_t buckets;
 
-    sync_workspaces (m);
-    enforce_fullscreen (m);
+    if (platform->window_enumerate_all (*wm_display (m), &buckets) != GF_SUCCESS)
+        return;
 
-    for (uint32_t mon_idx = 0; mon_idx < GF_MAX_MONITORS; mon_idx++)
+    for (uint32_t wsi = 0; wsi < workspaces->count; wsi++)
     {
-        gf_ws_info_t *current_ws = gf_workspace_list_find_by_id (
-            workspaces, workspaces->active_workspace[mon_idx]);
-        (void)current_ws;
+        gf_ws_id_t desktop = workspaces->items[wsi].id - GF_FIRST_WORKSPACE_ID;
+        if (desktop < 0 || (uint32_t)desktop >= buckets.desktop_count)
+            continue;
+
+        for (uint32_t i = buckets.offsets[desktop]; i < buckets.offsets[desktop + 1]; i++)
+            watch_window (m, &buckets.items[i]);
     }
 
+    // Sticky windows show up on every desktop; fold them in once
+    for (uint32_t i = buckets.offsets[buckets.desktop_count]; i < buckets.count; i++)
+        watch_window (m, &buckets.items[i]);
+}
+
+// Full rescan: enumerate every tracked workspace from the platform.
+static void
+watch_rescan (gf_wm_t *m)
+{
+    gf_platform_t *platform = wm_platform (m);
+    gf_ws_list_t *workspaces = wm_workspaces (m);
+    gf_display_t display = *wm_display (m);
+
+    if (platform->window_enumerate_all)
+    {
+        watch_rescan_buckets (m);
+        return;
+    }
+
+    if (!platform->window_enumerate)
+        return;
+
     for (uint32_t wsi = 0; wsi < workspaces->count; wsi++)
     {
         gf_ws_id_t ws_id = workspaces->items[wsi].id - GF_FIRST_WORKSPACE_ID;
@@ -122,57 +193,46 @@ gf_wm_watch (gf_wm_t *m)
         gf_win_info_t *ws_wins = NULL;
         uint32_t ws_count = 0;
 
-        if (!platform->window_enumerate
-            || platform->window_enumerate (display, &ws_id, &ws_wins, &ws_count)
-                   != GF_SUCCESS)
+        if (platform->window_enumerate (display, &ws_id, &ws_wins, &ws_count)
+            != GF_SUCCESS)
             continue;
 
         for (uint32_t i = 0; i < ws_count; i++)
-        {
-            gf_win_info_t *win = &ws_wins[i];
-
-            if (!win->is_valid || wm_is_excluded (m, win->id))
-                continue;
-
-            if (platform->monitor_from_window)
-                win->monitor_id = platform->monitor_from_window (platform, win->id);
-
-            gf_win_info_t *existing = gf_window_list_find_by_window_id (windows, win->id);
+            watch_window (m, &ws_wins[i]);
+    }
+}
 
-            if (!existing)
-            {
-                register_new_window (m, win, NULL);
-            }
-            else
-            {
-                win->workspace_id = existing->workspace_id;
-                gf_wm_resolve_window_name (m, win->id, existing->name, win->name,
-                                           sizeof (win->name));
+void
+gf_wm_watch (gf_wm_t *m)
+{
+    if (!m)
+        return;
 
-                const gf_window_rule_t *rule = gf_rules_find (m->config, win->name);
+    gf_platform_t *platform = wm_platform (m);
 
-                gf_ws_info_t *current_ws
-                    = gf_workspace_list_find_by_id (workspaces, win->workspace_id);
+    sync_workspaces (m);
+    enforce_fullscreen (m);
 
-                if (current_ws && !rule && current_ws->has_rule)
-                {
-                    gf_ws_id_t free_ws = gf_workspace_list_find_free (workspaces);
-                    if (gf_workspace_list_find_by_id (workspaces, free_ws))
-                        move_window_to_workspace (m, win, free_ws);
-                }
+    time_t now = time (NULL);
+    if (!platform->window_changes || m->state.last_scan_time == 0
+        || now - m->state.last_scan_time >= GF_WM_RESCAN_INTERVAL)
+    {
+        watch_rescan (m);
+        m->state.last_scan_time = now;
+    }
 
-                win->is_maximized = existing->is_maximized;
-                win->is_minimized = existing->is_minimized;
+    if (!platform->window_changes)
+        return;
 
-                if (win->is_minimized)
-                    win->geometry = existing->geometry;
+    // Incremental pass: only the windows the platform saw change
+    gf_win_info_t *changed = NULL;
+    uint32_t changed_count = 0;
 
-                gf_window_list_update (windows, win);
-            }
-        }
+    if (platform->window_changes (platform, &changed, &changed_count) != GF_SUCCESS)
+        return;
 
-        gf_free (ws_wins);
-    }
+    for (uint32_t i = 0; i < changed_count; i++)
+        watch_window (m, &changed[i]);
 }
 
 static void
@@ -211,7 +271,7 @@ exit_maximized_mode (gf_wm_t *m, gf_win_info_t *focused)
     gf_ws_id_t old_ws_id = focused->workspace_id;
     focused->is_maximized = false;
 
-    const gf_window_rule_t *rule = gf_rules_find (m->config, focused->name);
+    const gf_window_rule_t *rule = gf_rules_match (m->config, focused->name_id);
     gf_ws_id_t target_ws = rule ? rule->workspace_id : lookup_or_create_ws (m);
     move_window_to_workspace (m, focused, target_ws);
     cleanup_empty_maximized_ws (m, old_ws_id);
@@ -246,7 +306,7 @@ gf_wm_event (gf_wm_t *m)
 
     if (curr_win_id == 0)
     {
-        GF_LOG_WARN ("[EVENT] No active window");
+        GF_LOG_RATELIMIT (GF_LOG_WARN, 10, "[EVENT] No active window");
         return;
     }
 
@@ -255,12 +315,12 @@ gf_wm_event (gf_wm_t *m)
     if (!focused)
     {
         if (!wm_is_excluded (m, curr_win_id))
-            GF_LOG_WARN ("[EVENT] Active window %lu not tracked yet", curr_win_id);
+            GF_LOG_RATELIMIT (GF_LOG_WARN, 10,
+                              "[EVENT] Active window %lu not tracked yet", curr_win_id);
         return;
     }
 
-    bool now_maximized = platform->window_is_maximized
-                         && platform->window_is_maximized (display, curr_win_id);
+    bool now_maximized = (wm_window_state (m, curr_win_id) & GF_WIN_STATE_MAXIMIZED) != 0;
     bool was_maximized = focused->is_maximized;
 
     if (now_maximized && !was_maximized)
@@ -1,6 +1,7 @@
 #ifndef GF_CORE_INTERNAL_H
 #define GF_CORE_INTERNAL_H
 
+#include "../ipc/wire.h"
 #include "layout.h"
 #include "wm.h"
 
@@ -64,9 +65,24 @@ void sync_workspaces (gf_wm_t *m);
 bool ws_has_capacity (gf_ws_info_t *ws, uint32_t max_per_ws);
 bool ws_is_valid (gf_ws_list_t *workspaces, gf_ws_id_t id);
 
+/* --- Change Tracking --- */
+void gf_wm_changes_init (gf_wm_t *m);
+// Stamp what changed since the last sweep with a new generation
+void gf_wm_changes_sweep (gf_wm_t *m);
+// Delta header for a client holding `since`; the removed keys are scratch
+// memory (see gf_scratch_alloc)
+void gf_wm_changes_since (const gf_wm_t *m, const gf_wm_changes_t *changes,
+                          uint64_t since, gf_wire_delta_t *delta);
+void gf_wm_changes_cleanup (gf_wm_t *m);
+// Push "<topic> <details>" to the IPC subscribers of topic, if any; key names
+// the subject (window, monitor, workspace) so a backlog keeps only its latest
+void gf_wm_notify (gf_wm_t *m, uint32_t topic, uint64_t key, const char *fmt, ...);
+
 /* --- Window Management --- */
+uint32_t wm_window_state (gf_wm_t *m, gf_handle_t w);
 void detect_minimize_changes (gf_wm_t *m, gf_ws_id_t current_workspace);
 int find_maximized_ws_index (gf_win_info_t *windows, uint32_t count, gf_handle_t handle);
+// Result is scratch memory (see gf_scratch_alloc).
 uint32_t find_maximized_windows (gf_wm_t *m, gf_win_info_t **out_windows);
 gf_monitor_id_t find_active_monitor (gf_wm_t *m);
 void enforce_fullscreen (gf_wm_t *m);
@@ -79,9 +95,12 @@ void restore_workspace_windows (gf_wm_t *m, gf_ws_id_t ws_id, gf_handle_t active
 bool win_has_assigned_workspace (gf_win_info_t *win, gf_ws_list_t *workspaces);
 
 /* --- Layout & Rendering --- */
-void gf_wm_apply_layout (gf_wm_t *m, gf_win_info_t *windows, gf_rect_t *geometry,
-                         uint32_t window_count);
-gf_err_t gf_wm_calculate_layout (gf_wm_t *m, gf_win_info_t *windows,
+// Both take pointers into the live window list (see gf_ws_iter_t). Returns how
+// many windows were placed.
+uint32_t gf_wm_apply_layout (gf_wm_t *m, gf_win_info_t *const *windows,
+                             const gf_rect_t *geometry, uint32_t window_count);
+// The geometry array is scratch memory (see gf_scratch_alloc).
+gf_err_t gf_wm_calculate_layout (gf_wm_t *m, gf_win_info_t *const *windows,
                                  uint32_t window_count, gf_monitor_id_t mon_id,
                                  gf_rect_t **out_geometries);
 gf_err_t gf_wm_layout_rebalance (gf_wm_t *m);
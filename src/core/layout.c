@@ -1,3 +1,5 @@
+#define GF_MEM_TAG GF_MEM_TAG_LAYOUT
+
 #include "layout.h"
 #include "../utils/memory.h"
 #include <string.h>
@@ -39,7 +41,7 @@ get_min_size (const gf_layout_engine_t *engine)
 }
 
 static void
-split_layout (const gf_win_info_t *windows, uint32_t count, const gf_rect_t *area,
+split_layout (gf_win_info_t *const *windows, uint32_t count, const gf_rect_t *area,
               gf_rect_t *out, uint32_t padding, uint32_t min_size, int depth)
 {
     if (count == 0)
@@ -84,7 +86,7 @@ split_layout (const gf_win_info_t *windows, uint32_t count, const gf_rect_t *are
 }
 
 static void
-apply_layout (const gf_layout_engine_t *engine, const gf_win_info_t *windows,
+apply_layout (const gf_layout_engine_t *engine, gf_win_info_t *const *windows,
               uint32_t count, const gf_rect_t *bounds, gf_rect_t *out)
 {
     uint32_t padding = get_padding (engine);
@@ -94,7 +96,7 @@ apply_layout (const gf_layout_engine_t *engine, const gf_win_info_t *windows,
 }
 
 static void
-grid_apply_layout (const gf_layout_engine_t *engine, const gf_win_info_t *windows,
+grid_apply_layout (const gf_layout_engine_t *engine, gf_win_info_t *const *windows,
                    uint32_t count, const gf_rect_t *bounds, gf_rect_t *out)
 {
     (void)windows;
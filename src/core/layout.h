@@ -8,9 +8,10 @@
 typedef struct gf_layout_engine gf_layout_engine_t;
 struct gf_layout_engine
 {
-    void (*apply_layout) (const gf_layout_engine_t *engine, const gf_win_info_t *windows,
-                          uint32_t count, const gf_rect_t *workspace_bounds,
-                          gf_rect_t *out_rects);
+    // windows points at the live records being placed, in cell order
+    void (*apply_layout) (const gf_layout_engine_t *engine,
+                          gf_win_info_t *const *windows, uint32_t count,
+                          const gf_rect_t *workspace_bounds, gf_rect_t *out_rects);
 
     void (*set_padding) (gf_layout_engine_t *engine, uint32_t padding);
     void (*set_min_size) (gf_layout_engine_t *engine, uint32_t min_size);
@@ -86,6 +86,8 @@
  * corner to wherever you drag the middle, changing its width and height
  * together -- the same edge logic as above, just done on both axes at once.
  */
+#define GF_MEM_TAG GF_MEM_TAG_LAYOUT
+
 #include "../platform/platform.h"
 #include "../utils/logger.h"
 #include "../utils/memory.h"
@@ -0,0 +1,184 @@
+#include "../platform/platform.h"
+#include "../utils/logger.h"
+#include "../utils/trace.h"
+#include "internal.h"
+#include "wm.h"
+
+/*
+ * Platform vtable decorator. While tracing, every entry of the live
+ * gf_platform_t is swapped for a wrapper that records a span around the
+ * original, so all callers are covered without touching them. The originals
+ * are kept in g_trace_inner and put back when tracing stops, leaving no
+ * overhead behind.
+ */
+static gf_platform_t g_trace_inner;
+static gf_platform_t *g_trace_target;
+
+#define GF_TRACED(ret, fn, params, args)                                               \
+    static ret _traced_##fn params                                                     \
+    {                                                                                  \
+        uint64_t start = gf_trace_begin ();                                            \
+        ret result = g_trace_inner.fn args;                                            \
+        gf_trace_end (GF_TRACE_PLATFORM, #fn, start);                                  \
+        return result;                                                                 \
+    }
+
+#define GF_TRACED_VOID(fn, params, args)                                               \
+    static void _traced_##fn params                                                    \
+    {                                                                                  \
+        uint64_t start = gf_trace_begin ();                                            \
+        g_trace_inner.fn args;                                                         \
+        gf_trace_end (GF_TRACE_PLATFORM, #fn, start);                                  \
+    }
+
+GF_TRACED (gf_err_t, init, (gf_platform_t *p, gf_display_t *d), (p, d))
+GF_TRACED_VOID (cleanup, (gf_display_t d, gf_platform_t *p), (d, p))
+GF_TRACED (gf_err_t, window_enumerate,
+           (gf_display_t d, gf_ws_id_t *ws, gf_win_info_t **w, uint32_t *n),
+           (d, ws, w, n))
+GF_TRACED (gf_err_t, window_enumerate_all, (gf_display_t d, gf_win_buckets_t *b), (d, b))
+GF_TRACED (gf_err_t, window_changes, (gf_platform_t *p, gf_win_info_t **w, uint32_t *n),
+           (p, w, n))
+GF_TRACED (gf_handle_t, window_get_focused, (gf_display_t d), (d))
+GF_TRACED_VOID (window_get_class, (gf_display_t d, gf_handle_t h, char *buf, size_t size),
+                (d, h, buf, size))
+GF_TRACED (gf_err_t, window_get_geometry, (gf_display_t d, gf_handle_t h, gf_rect_t *r),
+           (d, h, r))
+GF_TRACED (gf_err_t, window_get_state, (gf_display_t d, gf_handle_t h, uint32_t *s),
+           (d, h, s))
+GF_TRACED (bool, window_is_excluded, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (bool, window_is_fullscreen, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (bool, window_is_hidden, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (bool, window_is_maximized, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (bool, window_is_minimized, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (bool, window_is_valid, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (gf_err_t, window_minimize, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (gf_err_t, window_set_geometry,
+           (gf_display_t d, gf_handle_t h, const gf_rect_t *r, gf_geom_flags_t f,
+            gf_config_t *c),
+           (d, h, r, f, c))
+GF_TRACED (gf_err_t, window_unminimize, (gf_display_t d, gf_handle_t h), (d, h))
+GF_TRACED (gf_err_t, screen_get_bounds, (gf_display_t d, gf_rect_t *r), (d, r))
+GF_TRACED (uint32_t, workspace_get_count, (gf_display_t d), (d))
+GF_TRACED (uint32_t, monitor_get_count, (gf_platform_t *p), (p))
+GF_TRACED (gf_err_t, monitor_enumerate, (gf_platform_t *p, gf_monitor_t *m, uint32_t *n),
+           (p, m, n))
+GF_TRACED (gf_monitor_id_t, monitor_from_window, (gf_platform_t *p, gf_handle_t h),
+           (p, h))
+GF_TRACED (gf_err_t, screen_get_bounds_for_monitor,
+           (gf_display_t d, gf_monitor_id_t id, gf_rect_t *r), (d, id, r))
+GF_TRACED_VOID (border_add, (gf_platform_t *p, gf_handle_t h, gf_color_t c, int t),
+                (p, h, c, t))
+GF_TRACED_VOID (border_cleanup, (gf_platform_t *p), (p))
+GF_TRACED_VOID (border_remove, (gf_platform_t *p, gf_handle_t h), (p, h))
+GF_TRACED_VOID (border_update, (gf_platform_t *p, const gf_config_t *c), (p, c))
+GF_TRACED_VOID (dock_hide, (gf_platform_t *p), (p))
+GF_TRACED_VOID (dock_restore, (gf_platform_t *p), (p))
+GF_TRACED (gf_err_t, keymap_init, (gf_platform_t *p, gf_display_t d), (p, d))
+GF_TRACED_VOID (keymap_cleanup, (gf_platform_t *p), (p))
+GF_TRACED (gf_key_action_t, keymap_poll, (gf_platform_t *p, gf_display_t d), (p, d))
+GF_TRACED (gf_err_t, resize_hook_install, (gf_platform_t *p), (p))
+GF_TRACED_VOID (resize_hook_uninstall, (gf_platform_t *p), (p))
+GF_TRACED (bool, resize_poll, (gf_platform_t *p, gf_resize_event_t *e), (p, e))
+GF_TRACED (int, event_fd, (gf_platform_t *p), (p))
+GF_TRACED (bool, event_dispatch, (gf_platform_t *p), (p))
+
+// Optional entries stay NULL so callers still see them as unsupported
+#define GF_TRACE_SWAP(p, fn)                                                           \
+    do                                                                                 \
+    {                                                                                  \
+        if ((p)->fn)                                                                   \
+            (p)->fn = _traced_##fn;                                                    \
+    } while (0)
+
+static void
+trace_attach (gf_platform_t *p)
+{
+    g_trace_inner = *p;
+    g_trace_target = p;
+
+    GF_TRACE_SWAP (p, init);
+    GF_TRACE_SWAP (p, cleanup);
+    GF_TRACE_SWAP (p, window_enumerate);
+    GF_TRACE_SWAP (p, window_enumerate_all);
+    GF_TRACE_SWAP (p, window_changes);
+    GF_TRACE_SWAP (p, window_get_focused);
+    GF_TRACE_SWAP (p, window_get_class);
+    GF_TRACE_SWAP (p, window_get_geometry);
+    GF_TRACE_SWAP (p, window_get_state);
+    GF_TRACE_SWAP (p, window_is_excluded);
+    GF_TRACE_SWAP (p, window_is_fullscreen);
+    GF_TRACE_SWAP (p, window_is_hidden);
+    GF_TRACE_SWAP (p, window_is_maximized);
+    GF_TRACE_SWAP (p, window_is_minimized);
+    GF_TRACE_SWAP (p, window_is_valid);
+    GF_TRACE_SWAP (p, window_minimize);
+    GF_TRACE_SWAP (p, window_set_geometry);
+    GF_TRACE_SWAP (p, window_unminimize);
+    GF_TRACE_SWAP (p, screen_get_bounds);
+    GF_TRACE_SWAP (p, workspace_get_count);
+    GF_TRACE_SWAP (p, monitor_get_count);
+    GF_TRACE_SWAP (p, monitor_enumerate);
+    GF_TRACE_SWAP (p, monitor_from_window);
+    GF_TRACE_SWAP (p, screen_get_bounds_for_monitor);
+    GF_TRACE_SWAP (p, border_add);
+    GF_TRACE_SWAP (p, border_cleanup);
+    GF_TRACE_SWAP (p, border_remove);
+    GF_TRACE_SWAP (p, border_update);
+    GF_TRACE_SWAP (p, dock_hide);
+    GF_TRACE_SWAP (p, dock_restore);
+    GF_TRACE_SWAP (p, keymap_init);
+    GF_TRACE_SWAP (p, keymap_cleanup);
+    GF_TRACE_SWAP (p, keymap_poll);
+    GF_TRACE_SWAP (p, resize_hook_install);
+    GF_TRACE_SWAP (p, resize_hook_uninstall);
+    GF_TRACE_SWAP (p, resize_poll);
+    GF_TRACE_SWAP (p, event_fd);
+    GF_TRACE_SWAP (p, event_dispatch);
+}
+
+// The wrappers never touch platform_data, so restoring the copy is enough
+static void
+trace_detach (void)
+{
+    if (!g_trace_target)
+        return;
+
+    void *data = g_trace_target->platform_data;
+    *g_trace_target = g_trace_inner;
+    g_trace_target->platform_data = data;
+    g_trace_target = NULL;
+}
+
+gf_err_t
+gf_wm_trace_start (gf_wm_t *m, uint32_t capacity)
+{
+    if (!m || !wm_platform (m))
+        return GF_ERROR_INVALID_PARAMETER;
+
+    gf_err_t result = gf_trace_start (capacity);
+    if (result != GF_SUCCESS)
+        return result;
+
+    if (g_trace_target != wm_platform (m))
+    {
+        trace_detach ();
+        trace_attach (wm_platform (m));
+    }
+
+    GF_LOG_INFO ("Tracing started");
+    return GF_SUCCESS;
+}
+
+void
+gf_wm_trace_stop (gf_wm_t *m)
+{
+    (void)m;
+
+    if (!gf_trace_active ())
+        return;
+
+    gf_trace_stop ();
+    trace_detach ();
+    GF_LOG_INFO ("Tracing stopped, %u events buffered", gf_trace_count ());
+}
@@ -46,12 +46,13 @@ typedef void (*gf_window_destroy_callback_t) (gf_handle_t window, void *user_dat
 
 // Constants
 #define GF_MAX_WINDOWS_PER_WORKSPACE 10
-#define GF_MAX_WORKSPACES 32
+#define GF_DEFAULT_WORKSPACES 32
 #define GF_MAX_MONITORS 16
 #define GF_FIRST_WORKSPACE_ID 1
 #define GF_DEFAULT_PADDING 8
 #define GF_BORDER_WIDTH 4
 #define GF_MIN_WINDOW_SIZE 50
+#define GF_WIN_NAME_MAX 256
 
 // Error codes
 typedef enum
@@ -94,6 +95,14 @@ typedef struct
     bool is_primary;
 } gf_monitor_t;
 
+// Interned string id (utils/intern.h); 0 is the empty string.
+typedef uint32_t gf_str_id_t;
+#define GF_STR_NONE 0u
+
+// Only the fields scanned every tick live inline; the name is an interned
+// string id (utils/intern.h), which keeps a record within one cache line.
+// digest and generation belong to the change tracker (core/changes.c): the
+// lists zero them for new records and keep them across updates.
 typedef struct
 {
     gf_handle_t id;
@@ -104,8 +113,10 @@ typedef struct
     bool is_minimized;
     bool needs_update;
     bool is_valid;
+    gf_str_id_t name_id; // GF_STR_NONE until resolved; read via gf_win_name
+    uint32_t digest;     // hash of the client-visible fields at the last sweep
     time_t last_modified;
-    char name[256];
+    uint64_t generation; // state generation of the last visible change
 } gf_win_info_t;
 
 typedef struct
@@ -136,6 +147,8 @@ typedef struct
     bool has_maximized_state;
     bool is_custom_layout;
     bool has_rule;
+    uint32_t digest;     // change tracking, as for gf_win_info_t
+    uint64_t generation;
 } gf_ws_info_t;
 
 // Resize direction flags (bitmask for corner drags)
@@ -1,5 +1,6 @@
 #include "../config/config.h"
 #include "../platform/platform_compat.h"
+#include "../utils/intern.h"
 #include "../utils/list.h"
 #include "../utils/logger.h"
 #include "../utils/memory.h"
@@ -14,6 +15,36 @@
 #include <string.h>
 #include <time.h>
 
+// gf_win_state_t bits for a window: one window_get_state call where the
+// platform offers it, otherwise assembled from the individual predicates.
+uint32_t
+wm_window_state (gf_wm_t *m, gf_handle_t w)
+{
+    gf_platform_t *p = wm_platform (m);
+    gf_display_t display = *wm_display (m);
+    uint32_t state = 0;
+
+    if (p->window_get_state)
+        return p->window_get_state (display, w, &state) == GF_SUCCESS ? state : 0;
+
+    if (!wm_is_valid (m, w))
+        return 0;
+
+    state = GF_WIN_STATE_VALID;
+    if (p->window_is_maximized && p->window_is_maximized (display, w))
+        state |= GF_WIN_STATE_MAXIMIZED;
+    if (p->window_is_minimized && p->window_is_minimized (display, w))
+        state |= GF_WIN_STATE_MINIMIZED;
+    if (p->window_is_fullscreen && p->window_is_fullscreen (display, w))
+        state |= GF_WIN_STATE_FULLSCREEN;
+    if (p->window_is_hidden && p->window_is_hidden (display, w))
+        state |= GF_WIN_STATE_HIDDEN;
+    if (wm_is_excluded (m, w))
+        state |= GF_WIN_STATE_EXCLUDED;
+
+    return state;
+}
+
 static void
 remove_stale_windows (gf_wm_t *m, gf_win_list_t *windows)
 {
@@ -23,12 +54,10 @@ remove_stale_windows (gf_wm_t *m, gf_win_list_t *windows)
     for (uint32_t i = 0; i < windows->count;)
     {
         gf_win_info_t *win = &windows->items[i];
-        bool excluded = wm_is_excluded (m, win->id);
-        bool invalid = !wm_is_valid (m, win->id);
-        bool hidden = m->platform->window_is_hidden
-                      && m->platform->window_is_hidden (m->display, win->id);
+        uint32_t state = wm_window_state (m, win->id);
 
-        if (excluded || invalid || hidden)
+        if (!(state & GF_WIN_STATE_VALID)
+            || (state & (GF_WIN_STATE_EXCLUDED | GF_WIN_STATE_HIDDEN)))
         {
             if (win->is_maximized)
             {
@@ -63,21 +92,19 @@ gf_wm_window_class (const gf_wm_t *m, gf_handle_t handle, char *buffer, size_t s
 }
 
 /* Use cached_name if it was already resolved; otherwise re-query the
- * platform. Callers pass NULL/"" for a never-seen window (always queries),
+ * platform. Callers pass GF_STR_NONE for a never-seen window (always queries),
  * or a previous name for a tracked window whose class may have arrived
- * late (e.g. GTK apps that set WM_CLASS a moment after mapping). */
-void
-gf_wm_resolve_window_name (const gf_wm_t *m, gf_handle_t handle, const char *cached_name,
-                           char *out_name, size_t out_size)
+ * late (e.g. GTK apps that set WM_CLASS a moment after mapping). The result
+ * is an interned id, stored in the window record as-is. */
+gf_str_id_t
+gf_wm_resolve_window_name (const gf_wm_t *m, gf_handle_t handle, gf_str_id_t cached_name)
 {
-    if (cached_name && cached_name[0] != '\0')
-    {
-        strncpy (out_name, cached_name, out_size - 1);
-        out_name[out_size - 1] = '\0';
-        return;
-    }
+    if (cached_name != GF_STR_NONE)
+        return cached_name;
 
-    gf_wm_window_class (m, handle, out_name, out_size);
+    char name[GF_WIN_NAME_MAX];
+    gf_wm_window_class (m, handle, name, sizeof (name));
+    return gf_intern (name);
 }
 
 gf_monitor_id_t
@@ -114,9 +141,12 @@ minimize_workspace_windows (gf_wm_t *m, gf_ws_id_t ws_id, gf_handle_t exclude_id
     gf_display_t display = *wm_display (m);
     gf_win_list_t *windows = wm_windows (m);
 
-    for (int32_t i = (int32_t)windows->count - 1; i >= 0; i--)
+    uint32_t n;
+    const uint32_t *slots = gf_window_list_members (windows, ws_id, &n);
+
+    for (uint32_t k = n; k-- > 0;)
     {
-        gf_win_info_t *win = &windows->items[i];
+        gf_win_info_t *win = &windows->items[gf_ws_slot (slots, k)];
 
         if (win->workspace_id != ws_id || win->id == exclude_id)
             continue;
@@ -138,26 +168,26 @@ restore_non_active_windows (gf_wm_t *m, gf_ws_id_t ws_id, gf_handle_t active_win
     gf_display_t display = *wm_display (m);
     gf_win_list_t *windows = wm_windows (m);
 
-    for (int32_t i = (int32_t)windows->count - 1; i >= 0; i--)
+    uint32_t n;
+    const uint32_t *slots = gf_window_list_members (windows, ws_id, &n);
+
+    for (uint32_t k = n; k-- > 0;)
     {
-        gf_win_info_t *win = &windows->items[i];
+        gf_win_info_t *win = &windows->items[gf_ws_slot (slots, k)];
 
         if (win->workspace_id != ws_id || is_maximized_ws)
             continue;
-        if (wm_is_excluded (m, win->id))
-            continue;
         if (active_monitor != (gf_monitor_id_t)-1 && win->monitor_id != active_monitor)
             continue;
-        if (platform->window_is_hidden && platform->window_is_hidden (display, win->id))
-            continue;
         if (active_window != 0 && win->id == active_window)
             continue;
+        if (wm_window_state (m, win->id) & (GF_WIN_STATE_EXCLUDED | GF_WIN_STATE_HIDDEN))
+            continue;
 
         platform->window_unminimize (display, win->id);
         win->is_minimized = false;
 
-        if (m->config->enable_borders && !win->is_maximized && platform->border_add
-            && !wm_is_excluded (m, win->id))
+        if (m->config->enable_borders && !win->is_maximized && platform->border_add)
             platform->border_add (platform, win->id, m->config->border_color,
                                   GF_BORDER_WIDTH);
     }
@@ -171,9 +201,12 @@ restore_active_window (gf_wm_t *m, gf_ws_id_t ws_id, gf_handle_t active_window,
     gf_display_t display = *wm_display (m);
     gf_win_list_t *windows = wm_windows (m);
 
-    for (int32_t i = (int32_t)windows->count - 1; i >= 0; i--)
+    uint32_t n;
+    const uint32_t *slots = gf_window_list_members (windows, ws_id, &n);
+
+    for (uint32_t k = n; k-- > 0;)
     {
-        gf_win_info_t *win = &windows->items[i];
+        gf_win_info_t *win = &windows->items[gf_ws_slot (slots, k)];
 
         if (win->workspace_id != ws_id || win->id != active_window)
             continue;
@@ -198,9 +231,12 @@ restore_fallback_window (gf_wm_t *m, gf_ws_id_t ws_id, gf_monitor_id_t active_mo
     gf_display_t display = *wm_display (m);
     gf_win_list_t *windows = wm_windows (m);
 
-    for (uint32_t i = 0; i < windows->count; i++)
+    uint32_t n;
+    const uint32_t *slots = gf_window_list_members (windows, ws_id, &n);
+
+    for (uint32_t k = 0; k < n; k++)
     {
-        gf_win_info_t *win = &windows->items[i];
+        gf_win_info_t *win = &windows->items[gf_ws_slot (slots, k)];
         if (win->workspace_id != ws_id || wm_is_excluded (m, win->id))
             continue;
         if (active_monitor != (gf_monitor_id_t)-1 && win->monitor_id != active_monitor)
@@ -230,20 +266,22 @@ restore_workspace_windows (gf_wm_t *m, gf_ws_id_t ws_id, gf_handle_t active_wind
 void
 detect_minimize_changes (gf_wm_t *m, gf_ws_id_t current_workspace)
 {
-    gf_platform_t *platform = wm_platform (m);
-    gf_display_t display = *wm_display (m);
     gf_win_list_t *windows = wm_windows (m);
+    uint32_t n;
+    const uint32_t *slots = gf_window_list_members (windows, current_workspace, &n);
 
-    for (uint32_t i = 0; i < windows->count; i++)
+    for (uint32_t k = 0; k < n; k++)
     {
-        gf_win_info_t *win = &windows->items[i];
+        gf_win_info_t *win = &windows->items[gf_ws_slot (slots, k)];
 
-        if (!win->is_valid || wm_is_excluded (m, win->id))
+        if (!win->is_valid || win->workspace_id != current_workspace)
             continue;
-        if (win->workspace_id != current_workspace)
+
+        uint32_t state = wm_window_state (m, win->id);
+        if (state & GF_WIN_STATE_EXCLUDED)
             continue;
 
-        bool currently_minimized = platform->window_is_minimized (display, win->id);
+        bool currently_minimized = (state & GF_WIN_STATE_MINIMIZED) != 0;
 
         if (win->is_minimized == currently_minimized)
             continue;
@@ -306,15 +344,8 @@ gf_wm_window_sync (gf_wm_t *m, gf_handle_t window, gf_ws_id_t workspace_id)
         .last_modified = time (NULL),
     };
 
-    if (existing)
-    {
-        strncpy (info.name, existing->name, sizeof (info.name) - 1);
-        info.name[sizeof (info.name) - 1] = '\0';
-    }
-    else
-    {
-        gf_wm_window_class (m, window, info.name, sizeof (info.name));
-    }
+    gf_str_id_t cached_name = existing ? existing->name_id : GF_STR_NONE;
+    info.name_id = gf_wm_resolve_window_name (m, window, cached_name);
 
     return existing ? gf_window_list_update (windows, &info)
                     : gf_window_list_add (windows, &info);
@@ -344,16 +375,7 @@ gf_wm_window_move (gf_wm_t *m, gf_handle_t window_id, gf_ws_id_t target_workspac
     gf_win_list_t *windows = wm_windows (m);
     gf_ws_list_t *workspaces = wm_workspaces (m);
 
-    gf_win_info_t *win = NULL;
-    for (uint32_t i = 0; i < windows->count; i++)
-    {
-        if (windows->items[i].id == window_id)
-        {
-            win = &windows->items[i];
-            break;
-        }
-    }
-
+    gf_win_info_t *win = gf_window_list_find_by_window_id (windows, window_id);
     if (!win)
         return GF_ERROR_INVALID_PARAMETER;
 
@@ -373,7 +395,7 @@ gf_wm_window_move (gf_wm_t *m, gf_handle_t window_id, gf_ws_id_t target_workspac
     if (target_ws->window_count >= m->config->max_windows_per_workspace)
         return GF_ERROR_WORKSPACE_FULL;
 
-    win->workspace_id = target_workspace;
+    gf_window_list_set_workspace (windows, win, target_workspace);
 
     recount_workspace_windows (m, workspaces, windows,
                                m->config->max_windows_per_workspace);
@@ -403,7 +425,7 @@ find_maximized_windows (gf_wm_t *m, gf_win_info_t **out_windows)
         return 0;
     }
 
-    gf_win_info_t *result = gf_malloc (total * sizeof (gf_win_info_t));
+    gf_win_info_t *result = gf_scratch_alloc (total * sizeof (gf_win_info_t));
     if (!result)
     {
         *out_windows = NULL;
@@ -416,16 +438,11 @@ find_maximized_windows (gf_wm_t *m, gf_win_info_t **out_windows)
         if (!workspaces->items[i].has_maximized_state)
             continue;
 
-        gf_win_info_t *ws_wins = NULL;
-        uint32_t ws_count = 0;
-        if (gf_window_list_get_by_workspace (windows, workspaces->items[i].id, &ws_wins,
-                                             &ws_count)
-            == GF_SUCCESS)
-        {
-            for (uint32_t j = 0; j < ws_count && idx < total; j++)
-                result[idx++] = ws_wins[j];
-            gf_free (ws_wins);
-        }
+        gf_ws_iter_t it;
+        gf_win_info_t *win;
+        gf_ws_iter_init (&it, windows, workspaces->items[i].id, NULL, NULL);
+        while (idx < total && (win = gf_ws_iter_next (&it)))
+            result[idx++] = *win;
     }
 
     *out_windows = result;
@@ -4,10 +4,12 @@
 #include "../utils/list.h"
 #include "../utils/logger.h"
 #include "../utils/memory.h"
+#include "../utils/trace.h"
 #include "border.h"
 #include "internal.h"
 #include "layout.h"
 #include "types.h"
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -15,6 +17,19 @@
 #include <string.h>
 #include <time.h>
 
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// Set by gf_wm_request_stop, possibly from a signal handler. The reactor also
+// gets a byte on the wake pipe so a stop never waits out the poll timeout.
+static volatile sig_atomic_t g_wm_stop;
+static volatile sig_atomic_t g_wm_wake_fd = -1;
+static int g_wm_wake_read = -1;
+
 static void
 handle_max_windows_change (gf_wm_t *m, const gf_config_t *old, const gf_config_t *new)
 {
@@ -45,28 +60,142 @@ wm_reset_monitor_state (gf_wm_t *m)
 }
 
 static void
-wm_tick (gf_wm_t *m)
+wm_phase_resize (gf_wm_t *m)
 {
-    gf_wm_load_cfg (m);
-    gf_wm_watch (m);
-
     gf_wm_resize_event (m);
+}
+
+static void
+wm_phase_rebalance (gf_wm_t *m)
+{
     gf_wm_layout_rebalance (m);
-    gf_wm_layout_apply (m);
-    gf_wm_event (m);
+}
 
-    /*
-     * Keymap must run AFTER gf_wm_event so that a workspace switch is not
-     * immediately undone by gf_wm_event reading the old focused window and
-     * switching back.
-     */
-    gf_wm_keymap_event (m);
+static void
+wm_phase_layout_apply (gf_wm_t *m)
+{
+    gf_wm_layout_apply (m);
+}
 
+static void
+wm_phase_border_update (gf_wm_t *m)
+{
     if (m->config->enable_borders && m->platform->border_update)
         m->platform->border_update (m->platform, m->config);
+}
 
-    if (m->ipc_handle >= 0)
-        gf_ipc_server_process (m->ipc_handle, m);
+static void
+wm_phase_ipc (gf_wm_t *m)
+{
+    if (m->ipc_handle < 0)
+        return;
+
+    // A handled command may have changed state: follow up with a state pass
+    if (gf_ipc_server_process (m->ipc_handle, m))
+        m->state.pending_sources |= GF_WM_SOURCE_DISPLAY;
+
+    // Events a subscriber's socket could not take when they were published
+    gf_ipc_server_flush (m->ipc_handle);
+}
+
+/*
+ * Phase table in execution order. Keymap must run AFTER gf_wm_event so that a
+ * workspace switch is not immediately undone by gf_wm_event reading the old
+ * focused window and switching back.
+ */
+static void (*const wm_phases[GF_WM_PHASE_COUNT]) (gf_wm_t *m) = {
+    [GF_WM_PHASE_LOAD_CFG] = gf_wm_load_cfg,
+    [GF_WM_PHASE_WATCH] = gf_wm_watch,
+    [GF_WM_PHASE_RESIZE] = wm_phase_resize,
+    [GF_WM_PHASE_REBALANCE] = wm_phase_rebalance,
+    [GF_WM_PHASE_LAYOUT_APPLY] = wm_phase_layout_apply,
+    [GF_WM_PHASE_EVENT] = gf_wm_event,
+    [GF_WM_PHASE_KEYMAP] = gf_wm_keymap_event,
+    [GF_WM_PHASE_BORDER_UPDATE] = wm_phase_border_update,
+    [GF_WM_PHASE_IPC] = wm_phase_ipc,
+};
+
+static const char *const wm_phase_names[GF_WM_PHASE_COUNT] = {
+    [GF_WM_PHASE_LOAD_CFG] = "load_cfg",
+    [GF_WM_PHASE_WATCH] = "watch",
+    [GF_WM_PHASE_RESIZE] = "resize",
+    [GF_WM_PHASE_REBALANCE] = "rebalance",
+    [GF_WM_PHASE_LAYOUT_APPLY] = "layout_apply",
+    [GF_WM_PHASE_EVENT] = "event",
+    [GF_WM_PHASE_KEYMAP] = "keymap",
+    [GF_WM_PHASE_BORDER_UPDATE] = "border_update",
+    [GF_WM_PHASE_IPC] = "ipc",
+};
+
+const char *
+gf_wm_phase_name (gf_wm_phase_t phase)
+{
+    return (phase >= 0 && phase < GF_WM_PHASE_COUNT) ? wm_phase_names[phase] : "?";
+}
+
+// Every phase that runs is timed into its histogram and, while tracing, the
+// trace ring; one clock read per boundary keeps this cheap enough to stay on.
+// Display-server calls made by the platform layer are charged to the phase
+// running at the time.
+static void
+wm_tick (gf_wm_t *m, uint32_t phases)
+{
+    uint64_t tick_start = gf_prof_now_ns ();
+    uint64_t start = tick_start;
+    uint64_t allocs = gf_mem_alloc_count ();
+
+    for (int i = 0; i < GF_WM_PHASE_COUNT; i++)
+    {
+        if (!(phases & GF_WM_PHASE_BIT (i)))
+            continue;
+
+        gf_prof_set_scope ((uint32_t)i);
+        wm_phases[i](m);
+
+        uint64_t end = gf_prof_now_ns ();
+        gf_prof_record (&m->stats.phases[i], end - start);
+        gf_trace_record (GF_TRACE_TICK, wm_phase_names[i], start, end - start);
+        start = end;
+    }
+
+    gf_prof_set_scope (GF_PROF_SCOPE_IDLE);
+    gf_prof_record (&m->stats.tick, start - tick_start);
+    gf_trace_record (GF_TRACE_TICK, "tick", tick_start, start - tick_start);
+
+    // Stamp whatever the phases changed for delta queries
+    gf_wm_changes_sweep (m);
+
+    // Transient buffers from this tick are dead now
+    gf_scratch_reset ();
+    m->stats.last_tick_allocs = gf_mem_alloc_count () - allocs;
+    m->stats.tick_allocs += m->stats.last_tick_allocs;
+}
+
+// Map ready sources to the phases that have work to do. The heartbeat runs
+// everything; display input runs the state phases; a readable IPC socket only
+// needs the server itself.
+static uint32_t
+wm_phases_for_sources (uint32_t sources)
+{
+    if (sources & GF_WM_SOURCE_TIMER)
+        return GF_WM_PHASE_ALL;
+
+    uint32_t phases = 0;
+
+    if (sources & GF_WM_SOURCE_DISPLAY)
+        phases |= GF_WM_PHASE_ALL
+                  & ~(GF_WM_PHASE_BIT (GF_WM_PHASE_LOAD_CFG)
+                      | GF_WM_PHASE_BIT (GF_WM_PHASE_IPC));
+
+    if (sources & GF_WM_SOURCE_IPC)
+        phases |= GF_WM_PHASE_BIT (GF_WM_PHASE_IPC);
+
+    // A reload can change borders, workspaces and limits, so the state phases
+    // follow it
+    if (sources & GF_WM_SOURCE_CONFIG)
+        phases |= GF_WM_PHASE_ALL & ~GF_WM_PHASE_BIT (GF_WM_PHASE_IPC);
+
+    return phases;
 }
 
 gf_err_t
@@ -82,6 +211,9 @@ gf_wm_create (gf_wm_t **manager, gf_platform_t *platform, gf_layout_engine_t *la
     (*manager)->platform = platform;
     (*manager)->layout = layout;
     (*manager)->ipc_handle = -1;
+    (*manager)->config_watch.fd = -1;
+    (*manager)->stats.since_ns = gf_prof_now_ns ();
+    gf_wm_changes_init (*manager);
 
     if (gf_window_list_init (wm_windows (*manager), 16) != GF_SUCCESS)
         goto fail;
@@ -106,6 +238,7 @@ gf_wm_destroy (gf_wm_t *m)
 
     gf_window_list_cleanup (wm_windows (m));
     gf_workspace_list_cleanup (wm_workspaces (m));
+    gf_wm_changes_cleanup (m);
     gf_free (m);
 }
 
@@ -121,7 +254,7 @@ gf_wm_init (gf_wm_t *m)
     if (err != GF_SUCCESS)
         return err;
 
-    m->state.last_scan_time = time (NULL);
+    m->state.last_scan_time = 0; // first watch does a full scan
     m->state.last_cleanup_time = time (NULL);
     m->state.initialized = true;
 
@@ -142,6 +275,11 @@ gf_wm_init (gf_wm_t *m)
     if (m->ipc_handle < 0)
         GF_LOG_WARN ("Failed to create IPC server - client commands will not work");
 
+    const char *config_path = gf_config_get_path ();
+    if (!config_path
+        || gf_config_watch_init (&m->config_watch, config_path) != GF_SUCCESS)
+        GF_LOG_INFO ("Config watch unavailable, polling the config file instead");
+
     if (platform->dock_restore)
         platform->dock_restore (platform);
 
@@ -163,8 +301,8 @@ gf_wm_cleanup (gf_wm_t *m)
     GF_LOG_INFO ("Clearing %u windows and %u workspaces from memory", windows->count,
                  workspaces->count);
 
-    windows->count = 0;
-    workspaces->count = 0;
+    gf_window_list_clear (windows);
+    gf_workspace_list_clear (workspaces);
 
     wm_reset_monitor_state (m);
 
@@ -190,6 +328,8 @@ gf_wm_cleanup (gf_wm_t *m)
         m->ipc_handle = -1;
     }
 
+    gf_config_watch_cleanup (&m->config_watch);
+
     GF_LOG_INFO ("Window manager cleaned up");
 }
 
@@ -202,6 +342,12 @@ gf_wm_load_cfg (gf_wm_t *m)
         return;
     }
 
+    // With a watch in place nothing can have changed unless it said so; the
+    // mtime is still compared when polling.
+    bool watched = gf_config_watch_fd (&m->config_watch) >= 0;
+    if (watched && !m->state.config_dirty)
+        return;
+
     const char *path = gf_config_get_path ();
     if (!path)
     {
@@ -216,8 +362,11 @@ gf_wm_load_cfg (gf_wm_t *m)
         return;
     }
 
-    if (st.st_mtime <= m->config->last_modified)
+    // Several saves within one second share an mtime, so a notified change
+    // is reloaded regardless
+    if (!m->state.config_dirty && st.st_mtime <= m->config->last_modified)
         return;
+    m->state.config_dirty = false;
 
     gf_config_t old_cfg = *m->config;
     gf_config_t new_cfg = load_or_create_config (path);
@@ -235,20 +384,187 @@ gf_wm_load_cfg (gf_wm_t *m)
     gf_border_handle_toggle (m, &old_cfg, &new_cfg);
     sync_workspaces (m);
     handle_max_windows_change (m, &old_cfg, &new_cfg);
+    gf_wm_notify (m, GF_IPC_TOPIC_CONFIG_RELOADED, 0, NULL);
     gf_wm_debug_stats (m);
 }
 
+#ifndef _WIN32
+static int64_t
+wm_monotonic_ms (void)
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Block until the display, the IPC socket or the config watch is readable, or
+// the timeout expires. Returns the set of ready sources.
+static uint32_t
+wm_wait (gf_wm_t *m, int timeout_ms)
+{
+    gf_platform_t *platform = wm_platform (m);
+    struct pollfd fds[4];
+    nfds_t nfds = 0;
+    nfds_t ipc_slot = 0, config_slot = 0;
+    uint32_t sources = 0;
+
+    // Events Xlib already buffered never show up as fd readiness
+    if (platform->event_dispatch (platform))
+    {
+        sources |= GF_WM_SOURCE_DISPLAY;
+        timeout_ms = 0;
+    }
+
+    fds[nfds].fd = platform->event_fd (platform);
+    fds[nfds].events = POLLIN;
+    nfds++;
+
+    int ipc_fd = m->ipc_handle >= 0 ? gf_ipc_server_poll_fd (m->ipc_handle) : -1;
+    if (ipc_fd >= 0)
+    {
+        ipc_slot = nfds;
+        fds[nfds].fd = ipc_fd;
+        fds[nfds].events = POLLIN;
+        nfds++;
+    }
+
+    int config_fd = gf_config_watch_fd (&m->config_watch);
+    if (config_fd >= 0)
+    {
+        config_slot = nfds;
+        fds[nfds].fd = config_fd;
+        fds[nfds].events = POLLIN;
+        nfds++;
+    }
+
+    // Only wakes the poll; the loop checks g_wm_stop itself
+    if (g_wm_wake_read >= 0)
+    {
+        fds[nfds].fd = g_wm_wake_read;
+        fds[nfds].events = POLLIN;
+        nfds++;
+    }
+
+    int ready = poll (fds, nfds, timeout_ms);
+    if (ready < 0)
+    {
+        if (errno != EINTR)
+            GF_LOG_WARN ("poll failed: %s", strerror (errno));
+        return sources;
+    }
+
+    if (fds[0].revents && platform->event_dispatch (platform))
+        sources |= GF_WM_SOURCE_DISPLAY;
+
+    if (ipc_slot && fds[ipc_slot].revents)
+        sources |= GF_WM_SOURCE_IPC;
+
+    if (config_slot && fds[config_slot].revents
+        && gf_config_watch_drain (&m->config_watch))
+    {
+        m->state.config_dirty = true;
+        sources |= GF_WM_SOURCE_CONFIG;
+    }
+
+    return sources;
+}
+
+// Reactor loop: sleep in poll() and run only the phases the ready sources
+// need, with a heartbeat for pruning (and config polling without a watch).
+static gf_err_t
+wm_run_reactor (gf_wm_t *m)
+{
+    int64_t next_heartbeat = 0;
+    int wake[2];
+
+    GF_LOG_INFO ("Event loop: reactor mode (heartbeat %d ms)", GF_WM_HEARTBEAT_MS);
+
+    if (pipe2 (wake, O_NONBLOCK | O_CLOEXEC) == 0)
+    {
+        g_wm_wake_read = wake[0];
+        g_wm_wake_fd = wake[1];
+    }
+    else
+    {
+        // A stop still lands, just on the next wakeup instead of at once
+        GF_LOG_WARN ("pipe2 failed: %s", strerror (errno));
+    }
+
+    while (!g_wm_stop)
+    {
+        int64_t now = wm_monotonic_ms ();
+        uint32_t sources = m->state.pending_sources;
+        m->state.pending_sources = 0;
+
+        if (now >= next_heartbeat)
+        {
+            sources |= GF_WM_SOURCE_TIMER;
+            next_heartbeat = now + GF_WM_HEARTBEAT_MS;
+        }
+
+        int timeout_ms = sources ? 0 : (int)(next_heartbeat - now);
+        sources |= wm_wait (m, timeout_ms);
+        if (!sources || g_wm_stop)
+            continue;
+
+        m->state.loop_counter++;
+        wm_tick (m, wm_phases_for_sources (sources));
+
+        if (sources & GF_WM_SOURCE_TIMER)
+        {
+            gf_wm_prune (m);
+            m->state.last_cleanup_time = time (NULL);
+        }
+    }
+
+    if (g_wm_wake_read >= 0)
+    {
+        g_wm_wake_fd = -1;
+        close (wake[1]);
+        close (wake[0]);
+        g_wm_wake_read = -1;
+    }
+
+    return GF_SUCCESS;
+}
+#endif
+
+void
+gf_wm_request_stop (void)
+{
+    g_wm_stop = 1;
+
+#ifndef _WIN32
+    int fd = g_wm_wake_fd;
+    if (fd >= 0)
+    {
+        int saved_errno = errno;
+        ssize_t written = write (fd, "", 1);
+        (void)written; // a full pipe already has a wakeup pending
+        errno = saved_errno;
+    }
+#endif
+}
+
 gf_err_t
 gf_wm_run (gf_wm_t *m)
 {
     if (!m || !m->state.initialized)
         return GF_ERROR_INVALID_PARAMETER;
 
-    while (true)
+#ifndef _WIN32
+    gf_platform_t *platform = wm_platform (m);
+    if (platform->event_fd && platform->event_dispatch
+        && platform->event_fd (platform) >= 0)
+        return wm_run_reactor (m);
+#endif
+
+    // Fixed-interval polling for platforms without a pollable event source
+    while (!g_wm_stop)
     {
         m->state.loop_counter++;
 
-        wm_tick (m);
+        wm_tick (m, GF_WM_PHASE_ALL);
 
         if (time (NULL) - m->state.last_cleanup_time >= 1)
         {
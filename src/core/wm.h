@@ -4,32 +4,114 @@
 #include "layout.h"
 
 #include "../config/config.h"
+#include "../config/watch.h"
 #include "../ipc/ipc.h"
 #include "../platform/platform.h"
 #include "../utils/list.h"
+#include "../utils/profiler.h"
+
+// Stages of a manager tick, in execution order.
+typedef enum
+{
+    GF_WM_PHASE_LOAD_CFG = 0,
+    GF_WM_PHASE_WATCH,
+    GF_WM_PHASE_RESIZE,
+    GF_WM_PHASE_REBALANCE,
+    GF_WM_PHASE_LAYOUT_APPLY,
+    GF_WM_PHASE_EVENT,
+    GF_WM_PHASE_KEYMAP,
+    GF_WM_PHASE_BORDER_UPDATE,
+    GF_WM_PHASE_IPC,
+    GF_WM_PHASE_COUNT,
+} gf_wm_phase_t;
+
+#define GF_WM_PHASE_BIT(phase) (1u << (phase))
+#define GF_WM_PHASE_ALL (GF_WM_PHASE_BIT (GF_WM_PHASE_COUNT) - 1u)
+
+// Readiness sources that wake the event loop.
+typedef enum
+{
+    GF_WM_SOURCE_DISPLAY = (1 << 0),
+    GF_WM_SOURCE_IPC = (1 << 1),
+    GF_WM_SOURCE_TIMER = (1 << 2),
+    GF_WM_SOURCE_CONFIG = (1 << 3),
+} gf_wm_source_t;
+
+// Heartbeat for the reactor loop: pruning and anything the display does not
+// announce with an event (and config polling when no watch is available).
+#define GF_WM_HEARTBEAT_MS 1000
+
+// Seconds between full window rescans when the platform tracks changes
+// incrementally; the rescan is a consistency check, not the primary source.
+#define GF_WM_RESCAN_INTERVAL 5
+
+// Removals remembered for delta queries; older ones are forgotten and raise
+// the floor instead.
+#define GF_WM_TOMBSTONES 128
+
+typedef struct
+{
+    uint64_t key; // window handle or workspace id, as in wire.h
+    uint64_t generation;
+} gf_wm_tombstone_t;
+
+// Change tracking for one record list (core/changes.c)
+typedef struct
+{
+    gf_wm_tombstone_t removed[GF_WM_TOMBSTONES]; // ring, oldest overwritten
+    uint32_t removed_next;
+    uint32_t removed_count;
+    uint64_t floor;       // a delta from before this generation needs a reset
+    uint64_t *keys;       // records present at the last sweep
+    uint32_t key_count;
+    uint32_t key_capacity;
+    // List-level state at the last sweep: the active workspace per monitor for
+    // the workspace list, the focused window per monitor for the window list
+    uint32_t active[GF_MAX_MONITORS];
+    gf_handle_t focus[GF_MAX_MONITORS];
+} gf_wm_changes_t;
 
 typedef struct
 {
     gf_win_list_t windows;
     gf_ws_list_t workspaces;
+    // Bumped by every sweep that sees a window or workspace change; records
+    // carry the generation of their own last change
+    uint64_t generation;
+    gf_wm_changes_t window_changes;
+    gf_wm_changes_t workspace_changes;
     time_t last_scan_time;
     time_t last_cleanup_time;
     uint32_t loop_counter;
+    uint32_t pending_sources;
     gf_handle_t last_active_window[GF_MAX_MONITORS];
     gf_ws_id_t last_active_workspace[GF_MAX_MONITORS];
     bool initialized;
     bool dock_hidden;
     bool keymap_initialized;
     bool resize_active;
+    bool config_dirty; // the config watch saw the file change
 } gf_wm_state_t;
 
+// Tick profile: wall time of every phase that ran and of whole ticks.
+typedef struct
+{
+    gf_prof_hist_t phases[GF_WM_PHASE_COUNT];
+    gf_prof_hist_t tick;
+    uint64_t tick_allocs;      // heap allocations made inside ticks
+    uint64_t last_tick_allocs; // 0 once the scratch arena has warmed up
+    uint64_t since_ns;         // start of the sampling window
+} gf_wm_stats_t;
+
 typedef struct
 {
     gf_wm_state_t state;
+    gf_wm_stats_t stats;
     gf_platform_t *platform;
     gf_layout_engine_t *layout;
     gf_display_t display;
     gf_config_t *config;
+    gf_config_watch_t config_watch;
     gf_ipc_handle_t ipc_handle;
 } gf_wm_t;
 
@@ -43,6 +125,10 @@ void gf_wm_init_window_list (gf_wm_t *m);
 void gf_wm_load_cfg (gf_wm_t *manager);
 gf_err_t gf_wm_run (gf_wm_t *manager);
 
+// Make gf_wm_run return once the current tick is done. Async-signal-safe: it
+// only sets a flag and wakes the reactor's poll.
+void gf_wm_request_stop (void);
+
 // --- Event Handling ---
 void gf_wm_event (gf_wm_t *manager);
 void gf_wm_watch (gf_wm_t *m);
@@ -50,9 +136,12 @@ void gf_wm_keymap_event (gf_wm_t *m);
 void gf_wm_resize_event (gf_wm_t *m);
 
 // --- Layout Management ---
-void gf_wm_apply_layout (gf_wm_t *m, gf_win_info_t *windows, gf_rect_t *geometry,
-                         uint32_t window_count);
-gf_err_t gf_wm_calculate_layout (gf_wm_t *m, gf_win_info_t *windows,
+// Both take pointers into the live window list (see gf_ws_iter_t). Returns how
+// many windows were placed.
+uint32_t gf_wm_apply_layout (gf_wm_t *m, gf_win_info_t *const *windows,
+                             const gf_rect_t *geometry, uint32_t window_count);
+// The geometry array is scratch memory (see gf_scratch_alloc).
+gf_err_t gf_wm_calculate_layout (gf_wm_t *m, gf_win_info_t *const *windows,
                                  uint32_t window_count, gf_monitor_id_t mon_id,
                                  gf_rect_t **out_geometries);
 gf_err_t gf_wm_layout_apply (gf_wm_t *manager);
@@ -63,8 +152,9 @@ void gf_wm_prune (gf_wm_t *manager);
 gf_err_t gf_wm_window_move (gf_wm_t *m, gf_handle_t window_id,
                             gf_ws_id_t target_workspace);
 void gf_wm_window_class (const gf_wm_t *m, gf_handle_t handle, char *buffer, size_t size);
-void gf_wm_resolve_window_name (const gf_wm_t *m, gf_handle_t handle,
-                                const char *cached_name, char *out_name, size_t out_size);
+// Interned name id: the cached one when set, otherwise the window's class.
+gf_str_id_t gf_wm_resolve_window_name (const gf_wm_t *m, gf_handle_t handle,
+                                       gf_str_id_t cached_name);
 gf_err_t gf_wm_window_sync (gf_wm_t *manager, gf_handle_t window,
                             gf_ws_id_t workspace_id);
 
@@ -74,5 +164,14 @@ gf_err_t gf_wm_workspace_unlock (gf_wm_t *m, gf_ws_id_t workspace_id);
 
 // --- Debugging ---
 void gf_wm_debug_stats (const gf_wm_t *manager);
+const char *gf_wm_phase_name (gf_wm_phase_t phase);
+size_t gf_wm_stats_format (const gf_wm_t *m, char *buffer, size_t size);
+void gf_wm_stats_reset (gf_wm_t *m);
+size_t gf_wm_memory_format (char *buffer, size_t size);
+
+// Record tick phases, platform calls and IPC commands into the trace ring
+// (see utils/trace.h). capacity 0 picks the default ring size.
+gf_err_t gf_wm_trace_start (gf_wm_t *m, uint32_t capacity);
+void gf_wm_trace_stop (gf_wm_t *m);
 
 #endif // GF_CORE_WINDOW_MANAGER_H
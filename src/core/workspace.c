@@ -1,5 +1,6 @@
 #include "../config/config.h"
 #include "../config/rules.h"
+#include "../utils/intern.h"
 #include "../utils/list.h"
 #include "../utils/logger.h"
 #include "../utils/memory.h"
@@ -28,9 +29,9 @@ workspace_is_rule_target (const gf_config_t *cfg, gf_ws_id_t ws_id)
 }
 
 static bool
-window_has_rule (const gf_config_t *cfg, const char *wm_class)
+window_has_rule (gf_config_t *cfg, gf_str_id_t name_id)
 {
-    return gf_rules_find (cfg, wm_class) != NULL;
+    return gf_rules_match (cfg, name_id) != NULL;
 }
 
 /* Evict a non-rule window from a workspace to make room for a rule-bound window */
@@ -41,13 +42,16 @@ evict_non_rule_window (gf_wm_t *m, gf_ws_id_t ws_id)
     gf_ws_list_t *workspaces = wm_workspaces (m);
     uint32_t max_per_ws = m->config->max_windows_per_workspace;
 
-    for (uint32_t i = 0; i < windows->count; i++)
+    uint32_t n;
+    const uint32_t *slots = gf_window_list_members (windows, ws_id, &n);
+
+    for (uint32_t k = 0; k < n; k++)
     {
-        gf_win_info_t *win = &windows->items[i];
+        gf_win_info_t *win = &windows->items[gf_ws_slot (slots, k)];
         if (win->workspace_id != ws_id || !win->is_valid)
             continue;
 
-        if (window_has_rule (m->config, win->name))
+        if (window_has_rule (m->config, win->name_id))
             continue;
 
         gf_ws_id_t dst_id = -1;
@@ -69,8 +73,8 @@ evict_non_rule_window (gf_wm_t *m, gf_ws_id_t ws_id)
         if (dst_id >= 0)
         {
             GF_LOG_INFO ("Evicting window %p (%s) from workspace %d to %d for rule",
-                         (void *)win->id, win->name, ws_id, dst_id);
-            win->workspace_id = dst_id;
+                         (void *)win->id, gf_win_name (win), ws_id, dst_id);
+            gf_window_list_set_workspace (windows, win, dst_id);
             recount_workspace_windows (m, workspaces, windows, max_per_ws);
         }
         return;
@@ -95,11 +99,7 @@ cleanup_unused_workspace (gf_wm_t *m, gf_ws_list_t *list, uint32_t index)
     if (workspace_is_rule_target (m->config, ws_id))
         return;
 
-    memmove (&list->items[index], &list->items[index + 1],
-             (list->count - index - 1) * sizeof (gf_ws_info_t));
-
-    list->count--;
-    memset (&list->items[list->count], 0, sizeof (gf_ws_info_t));
+    gf_workspace_list_remove_at (list, index);
 }
 
 bool
@@ -123,7 +123,7 @@ move_window_to_workspace (gf_wm_t *m, gf_win_info_t *win, gf_ws_id_t new_ws_id)
     gf_workspace_list_remove_window (old, windows, win->id);
     gf_workspace_list_add_window (new, windows, win->id);
 
-    win->workspace_id = new_ws_id;
+    gf_window_list_set_workspace (windows, win, new_ws_id);
 }
 
 bool
@@ -307,10 +307,10 @@ assign_unassigned_windows (gf_wm_t *m, uint32_t max_per_ws)
         if (!win->is_valid || win_has_assigned_workspace (win, workspaces))
             continue;
 
-        const gf_window_rule_t *rule = gf_rules_find (m->config, win->name);
+        const gf_window_rule_t *rule = gf_rules_match (m->config, win->name_id);
         if (rule)
         {
-            win->workspace_id = rule->workspace_id;
+            gf_window_list_set_workspace (windows, win, rule->workspace_id);
             continue;
         }
 
@@ -327,7 +327,7 @@ assign_unassigned_windows (gf_wm_t *m, uint32_t max_per_ws)
         }
 
         gf_workspace_list_ensure (workspaces, ws_id, max_per_ws);
-        win->workspace_id = ws_id;
+        gf_window_list_set_workspace (windows, win, ws_id);
         slot++;
 
         if (slot >= max_per_ws)
@@ -415,10 +415,7 @@ lookup_or_create_ws (gf_wm_t *m)
 gf_ws_id_t
 assign_window_workspace (gf_wm_t *m, gf_win_info_t *win, gf_ws_info_t *current_ws)
 {
-    gf_platform_t *platform = wm_platform (m);
-    gf_display_t display = *wm_display (m);
-
-    if (platform->window_is_maximized && platform->window_is_maximized (display, win->id))
+    if (wm_window_state (m, win->id) & GF_WIN_STATE_MAXIMIZED)
     {
         win->is_maximized = true;
         return lookup_or_create_maximized_ws (m);
@@ -515,18 +512,15 @@ finalize_window_registration (gf_wm_t *m, gf_win_info_t *win)
 void
 register_new_window (gf_wm_t *m, gf_win_info_t *win, gf_ws_info_t *current_ws)
 {
-    gf_platform_t *platform = wm_platform (m);
-    gf_display_t display = *wm_display (m);
-
-    gf_wm_resolve_window_name (m, win->id, NULL, win->name, sizeof (win->name));
+    win->name_id = gf_wm_resolve_window_name (m, win->id, GF_STR_NONE);
 
-    if (platform->window_is_maximized && platform->window_is_maximized (display, win->id))
+    if (wm_window_state (m, win->id) & GF_WIN_STATE_MAXIMIZED)
     {
         assign_maximized_window (m, win);
     }
     else
     {
-        const gf_window_rule_t *rule = gf_rules_find (m->config, win->name);
+        const gf_window_rule_t *rule = gf_rules_match (m->config, win->name_id);
         if (rule)
             apply_rule_to_window (m, win, rule);
         else
@@ -537,7 +531,7 @@ register_new_window (gf_wm_t *m, gf_win_info_t *win, gf_ws_info_t *current_ws)
         current_ws->is_custom_layout = false;
 
     GF_LOG_INFO ("New window %p → workspace %u (%s)", (void *)win->id, win->workspace_id,
-                 win->name);
+                 gf_win_name (win));
 
     finalize_window_registration (m, win);
 }
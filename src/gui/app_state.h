@@ -15,6 +15,12 @@ typedef struct
     GtkWidget *workspace_table; // scrolled window hosting the workspace cards
     GtkWidget *server_btn;      // persistent start/stop toggle in the header
     gf_gui_platform_t *platform;
+    // Last lists fetched and the generation each reply brought them to, so a
+    // refresh only asks the daemon for what changed since
+    gf_ws_list_t *workspaces;
+    gf_win_list_t *windows;
+    uint64_t workspaces_generation;
+    uint64_t windows_generation;
 #ifdef _WIN32
     gboolean operation_in_progress;
     void *tray_data;
@@ -1,6 +1,11 @@
+#define GF_MEM_TAG GF_MEM_TAG_GUI
+
 #include "refresh.h"
+#include "../../utils/memory.h"
 #include "../widgets/workspace_card.h"
 #include "ipc_client.h"
+#include <inttypes.h>
+#include <string.h>
 
 static GtkWidget *
 build_card_list (gf_ws_list_t *workspaces, const gf_win_list_t *windows,
@@ -19,51 +24,297 @@ build_card_list (gf_ws_list_t *workspaces, const gf_win_list_t *windows,
     return list;
 }
 
+static void
+drop_cache (gf_app_state_t *app)
+{
+    if (app->workspaces)
+        gf_free_workspace_list (app->workspaces);
+    if (app->windows)
+        gf_free_window_list (app->windows);
+    app->workspaces = NULL;
+    app->windows = NULL;
+    app->workspaces_generation = 0;
+    app->windows_generation = 0;
+}
+
+static gboolean
+delta_removes (const gf_wire_delta_t *delta, uint64_t key)
+{
+    for (uint32_t i = 0; i < delta->removed_count; i++)
+    {
+        if (delta->removed[i] == key)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * Folding a delta into a cached list: removed records drop out, changed ones
+ * replace theirs in place and new ones go to the end, so cards keep their
+ * order. Lists here are a handful of workspaces and a few dozen windows, so
+ * the pairwise scans are cheaper than building an index. Both functions take
+ * ownership of changed.
+ */
+static gboolean
+apply_window_delta (gf_app_state_t *app, gf_win_list_t *changed,
+                    const gf_wire_delta_t *delta)
+{
+    app->windows_generation = delta->generation;
+    if (delta->reset || !app->windows)
+    {
+        if (app->windows)
+            gf_free_window_list (app->windows);
+        app->windows = changed;
+        return TRUE;
+    }
+
+    if (delta->removed_count == 0 && changed->count == 0)
+    {
+        gf_free_window_list (changed);
+        return FALSE;
+    }
+
+    gf_win_list_t *cache = app->windows;
+    uint32_t total = cache->count + changed->count;
+    gf_win_info_t *items = gf_malloc ((total ? total : 1) * sizeof (gf_win_info_t));
+    gboolean *taken = g_new0 (gboolean, changed->count + 1);
+    if (!items)
+    {
+        g_free (taken);
+        gf_free_window_list (changed);
+        drop_cache (app);
+        return FALSE;
+    }
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < cache->count; i++)
+    {
+        const gf_win_info_t *win = &cache->items[i];
+        if (delta_removes (delta, (uint64_t)(uintptr_t)win->id))
+            continue;
+
+        items[n] = *win;
+        for (uint32_t j = 0; j < changed->count; j++)
+        {
+            if (!taken[j] && changed->items[j].id == win->id)
+            {
+                items[n] = changed->items[j];
+                taken[j] = TRUE;
+                break;
+            }
+        }
+        n++;
+    }
+    for (uint32_t j = 0; j < changed->count; j++)
+    {
+        if (!taken[j])
+            items[n++] = changed->items[j];
+    }
+
+    g_free (taken);
+    gf_free_window_list (changed);
+    gf_free (cache->items);
+    cache->items = items;
+    cache->count = n;
+    cache->capacity = total;
+    return TRUE;
+}
+
 static gboolean
-fetch_responses (gf_app_state_t *app, gf_ipc_response_t *ws_resp,
+apply_workspace_delta (gf_app_state_t *app, gf_ws_list_t *changed,
+                       const gf_wire_delta_t *delta)
+{
+    app->workspaces_generation = delta->generation;
+    if (delta->reset || !app->workspaces)
+    {
+        if (app->workspaces)
+            gf_free_workspace_list (app->workspaces);
+        app->workspaces = changed;
+        return TRUE;
+    }
+
+    gf_ws_list_t *cache = app->workspaces;
+    gboolean active_moved = memcmp (cache->active_workspace, changed->active_workspace,
+                                    sizeof (cache->active_workspace))
+                            != 0;
+    memcpy (cache->active_workspace, changed->active_workspace,
+            sizeof (cache->active_workspace));
+
+    if (delta->removed_count == 0 && changed->count == 0)
+    {
+        gf_free_workspace_list (changed);
+        return active_moved;
+    }
+
+    uint32_t total = cache->count + changed->count;
+    gf_ws_info_t *items = gf_malloc ((total ? total : 1) * sizeof (gf_ws_info_t));
+    gboolean *taken = g_new0 (gboolean, changed->count + 1);
+    if (!items)
+    {
+        g_free (taken);
+        gf_free_workspace_list (changed);
+        drop_cache (app);
+        return FALSE;
+    }
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < cache->count; i++)
+    {
+        const gf_ws_info_t *ws = &cache->items[i];
+        if (delta_removes (delta, (uint32_t)ws->id))
+            continue;
+
+        items[n] = *ws;
+        for (uint32_t j = 0; j < changed->count; j++)
+        {
+            if (!taken[j] && changed->items[j].id == ws->id)
+            {
+                items[n] = changed->items[j];
+                taken[j] = TRUE;
+                break;
+            }
+        }
+        n++;
+    }
+    for (uint32_t j = 0; j < changed->count; j++)
+    {
+        if (!taken[j])
+            items[n++] = changed->items[j];
+    }
+
+    g_free (taken);
+    gf_free_workspace_list (changed);
+    gf_free (cache->items);
+    cache->items = items;
+    cache->count = n;
+    cache->capacity = total;
+    return TRUE;
+}
+
+// Replies the Windows background refresh already fetched, if any
+static gboolean
+take_prefetched (gf_app_state_t *app, gf_ipc_response_t *ws_resp,
                  gf_ipc_response_t *win_resp)
 {
 #ifdef _WIN32
-    gf_ipc_response_t *ws_ptr = g_object_get_data (G_OBJECT (app->window), "ws_response");
+    // Stolen, not cleared: the copies now own any heap payloads
+    gf_ipc_response_t *ws_ptr
+        = g_object_steal_data (G_OBJECT (app->window), "ws_response");
     gf_ipc_response_t *win_ptr
-        = g_object_get_data (G_OBJECT (app->window), "win_response");
+        = g_object_steal_data (G_OBJECT (app->window), "win_response");
     if (ws_ptr && win_ptr)
     {
         *ws_resp = *ws_ptr;
         *win_resp = *win_ptr;
-        g_object_set_data (G_OBJECT (app->window), "ws_response", NULL);
-        g_object_set_data (G_OBJECT (app->window), "win_response", NULL);
+        g_free (ws_ptr);
+        g_free (win_ptr);
         return TRUE;
     }
-#endif
+    if (ws_ptr)
+        gf_ipc_response_release (ws_ptr);
+    if (win_ptr)
+        gf_ipc_response_release (win_ptr);
+    g_free (ws_ptr);
+    g_free (win_ptr);
+#else
     (void)app;
-    *ws_resp = gf_run_client_command ("query workspaces");
-    *win_resp = gf_run_client_command ("query windows");
+    (void)ws_resp;
+    (void)win_resp;
+#endif
+    return FALSE;
+}
+
+// Prefetched replies are full lists; they replace the cache outright
+static gboolean
+apply_full (gf_app_state_t *app, gf_ipc_response_t *ws_resp, gf_ipc_response_t *win_resp)
+{
+    gf_ws_list_t *workspaces = NULL;
+    gf_win_list_t *windows = NULL;
+    if (ws_resp->status == GF_IPC_SUCCESS && win_resp->status == GF_IPC_SUCCESS)
+    {
+        workspaces = gf_parse_workspace_list (gf_ipc_response_data (ws_resp),
+                                              ws_resp->length);
+        windows = gf_parse_window_list (gf_ipc_response_data (win_resp),
+                                        win_resp->length);
+    }
+    gf_ipc_response_release (ws_resp);
+    gf_ipc_response_release (win_resp);
+
+    // Without a generation to go with them, the next delta has to start over
+    drop_cache (app);
+    if (!workspaces || !windows)
+    {
+        if (workspaces)
+            gf_free_workspace_list (workspaces);
+        if (windows)
+            gf_free_window_list (windows);
+        return FALSE;
+    }
+
+    app->workspaces = workspaces;
+    app->windows = windows;
     return TRUE;
 }
 
-void
-gf_refresh_workspaces (gf_app_state_t *app)
+static gboolean
+fetch_deltas (gf_app_state_t *app)
 {
-    gf_ipc_response_t ws_resp, win_resp;
-    fetch_responses (app, &ws_resp, &win_resp);
-    if (ws_resp.status != GF_IPC_SUCCESS || win_resp.status != GF_IPC_SUCCESS)
-        return;
+    char command[64];
+    snprintf (command, sizeof (command), "query workspaces since %" PRIu64,
+              app->workspaces_generation);
+    gf_ipc_response_t ws_resp = gf_run_client_command (command);
+    snprintf (command, sizeof (command), "query windows since %" PRIu64,
+              app->windows_generation);
+    gf_ipc_response_t win_resp = gf_run_client_command (command);
+
+    gf_wire_delta_t ws_delta, win_delta;
+    gf_ws_list_t *workspaces = NULL;
+    gf_win_list_t *windows = NULL;
+    if (ws_resp.status == GF_IPC_SUCCESS && win_resp.status == GF_IPC_SUCCESS)
+    {
+        workspaces = gf_parse_workspace_delta (gf_ipc_response_data (&ws_resp),
+                                               ws_resp.length, &ws_delta);
+        windows = gf_parse_window_delta (gf_ipc_response_data (&win_resp),
+                                         win_resp.length, &win_delta);
+    }
+    gf_ipc_response_release (&ws_resp);
+    gf_ipc_response_release (&win_resp);
 
-    gf_ws_list_t *workspaces = gf_parse_workspace_list (ws_resp.message);
-    gf_win_list_t *windows = gf_parse_window_list (win_resp.message);
     if (!workspaces || !windows)
     {
         if (workspaces)
-            gf_workspace_list_cleanup (workspaces);
+        {
+            gf_wire_delta_release (&ws_delta);
+            gf_free_workspace_list (workspaces);
+        }
         if (windows)
-            gf_window_list_cleanup (windows);
-        return;
+        {
+            gf_wire_delta_release (&win_delta);
+            gf_free_window_list (windows);
+        }
+        drop_cache (app);
+        return FALSE;
     }
 
-    GtkWidget *list = build_card_list (workspaces, windows, app);
-    gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (app->workspace_table), list);
+    gboolean changed = apply_workspace_delta (app, workspaces, &ws_delta);
+    changed = apply_window_delta (app, windows, &win_delta) || changed;
+    gf_wire_delta_release (&ws_delta);
+    gf_wire_delta_release (&win_delta);
+    return changed;
+}
+
+void
+gf_refresh_workspaces (gf_app_state_t *app)
+{
+    gf_ipc_response_t ws_resp, win_resp;
+    gboolean changed = take_prefetched (app, &ws_resp, &win_resp)
+                           ? apply_full (app, &ws_resp, &win_resp)
+                           : fetch_deltas (app);
 
-    gf_workspace_list_cleanup (workspaces);
-    gf_window_list_cleanup (windows);
+    // Nothing moved since the last poll: leave the cards as they are
+    if (!changed || !app->workspaces || !app->windows)
+        return;
+
+    GtkWidget *list = build_card_list (app->workspaces, app->windows, app);
+    gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (app->workspace_table), list);
 }
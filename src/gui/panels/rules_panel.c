@@ -171,6 +171,8 @@ refresh_rules_list (rules_ctx_t *ctx)
         return;
 
     gf_config_t config = load_or_create_config (path);
+    gtk_spin_button_set_range (GTK_SPIN_BUTTON (ctx->ws_spin), 1, config.max_workspaces);
+
     uint32_t n = config.window_rules_count;
     if (n == 0)
     {
@@ -262,7 +264,7 @@ build_add_form (rules_ctx_t *ctx)
     build_app_dropdown (ctx);
     gtk_box_append (GTK_BOX (form), ctx->app_dropdown);
 
-    ctx->ws_spin = gtk_spin_button_new_with_range (1, GF_MAX_WORKSPACES, 1);
+    ctx->ws_spin = gtk_spin_button_new_with_range (1, GF_DEFAULT_WORKSPACES, 1);
     gtk_spin_button_set_value (GTK_SPIN_BUTTON (ctx->ws_spin), 1);
     gtk_box_append (GTK_BOX (form), ctx->ws_spin);
 
@@ -54,6 +54,7 @@ handle_command_response (gpointer user_data)
         platform_run_refresh (data->app);
     }
 
+    gf_ipc_response_release (&data->response);
     g_free (data);
     return G_SOURCE_REMOVE;
 }
@@ -77,6 +78,14 @@ run_command_thread (gpointer user_data)
     return NULL;
 }
 
+// Replaced before the refresh consumed it; refresh steals it otherwise
+static void
+free_response (gpointer data)
+{
+    gf_ipc_response_release (data);
+    g_free (data);
+}
+
 static gboolean
 handle_refresh_response (gpointer user_data)
 {
@@ -96,9 +105,9 @@ run_refresh_thread (gpointer user_data)
     gf_ipc_response_t win_resp = gf_run_client_command ("query windows");
 
     g_object_set_data_full (G_OBJECT (data->app->window), "ws_response",
-                            g_memdup2 (&ws_resp, sizeof (ws_resp)), g_free);
+                            g_memdup2 (&ws_resp, sizeof (ws_resp)), free_response);
     g_object_set_data_full (G_OBJECT (data->app->window), "win_response",
-                            g_memdup2 (&win_resp, sizeof (win_resp)), g_free);
+                            g_memdup2 (&win_resp, sizeof (win_resp)), free_response);
 
     gf_refresh_task_t *res = g_new0 (gf_refresh_task_t, 1);
     res->app = data->app;
@@ -140,6 +149,7 @@ platform_run_command (gf_app_state_t *app, const char *command, gboolean refresh
         GtkAlertDialog *ad = gtk_alert_dialog_new ("%s", text);
         gtk_alert_dialog_show (ad, GTK_WINDOW (app->window));
     }
+    gf_ipc_response_release (&resp);
     if (refresh)
     {
         gf_refresh_workspaces (app);
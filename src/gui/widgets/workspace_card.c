@@ -1,4 +1,5 @@
 #include "workspace_card.h"
+#include "../../utils/intern.h"
 #include "../platform/async.h"
 #include <ctype.h>
 #include <stdio.h>
@@ -77,7 +78,7 @@ chip_icon (gf_app_state_t *app, const gf_win_info_t *win)
         if (p)
             return p;
     }
-    return icon_from_theme (win->name);
+    return icon_from_theme (gf_win_name (win));
 }
 
 static GdkContentProvider *
@@ -158,10 +159,10 @@ chip_label_text (gf_app_state_t *app, const gf_win_info_t *win, char *scratch, s
 {
     const char *friendly = NULL;
     if (app->platform && app->platform->get_friendly_name)
-        friendly = app->platform->get_friendly_name (app->platform, win->name);
+        friendly = app->platform->get_friendly_name (app->platform, gf_win_name (win));
     if (friendly && friendly[0])
         return friendly;
-    prettify_name (win->name, scratch, n);
+    prettify_name (gf_win_name (win), scratch, n);
     return scratch;
 }
 
@@ -203,7 +204,7 @@ build_chip (gf_app_state_t *app, const gf_win_info_t *win, bool draggable)
 static gboolean
 window_in_workspace (const gf_win_info_t *win, gf_ws_id_t ws)
 {
-    return win->is_valid && win->workspace_id == ws && win->name[0] != '\0';
+    return win->is_valid && win->workspace_id == ws && gf_win_name (win)[0] != '\0';
 }
 
 static GtkWidget *
@@ -17,6 +17,7 @@ healthcheck_tick (gpointer user_data)
 
     gf_ipc_response_t resp = gf_run_client_command ("query workspaces");
     gboolean healthy = (resp.status == GF_IPC_SUCCESS);
+    gf_ipc_response_release (&resp);
 
     if (healthy)
     {
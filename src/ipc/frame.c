@@ -0,0 +1,103 @@
+#define GF_MEM_TAG GF_MEM_TAG_IPC
+
+#include "../utils/memory.h"
+#include "ipc.h"
+#include <string.h>
+
+void
+gf_ipc_frame_init (gf_ipc_frame_t *frame, uint16_t status, uint32_t request_id,
+                   uint32_t length)
+{
+    memcpy (frame->magic, GF_IPC_MAGIC, sizeof (frame->magic));
+    frame->version = GF_IPC_VERSION;
+    frame->status = status;
+    frame->request_id = request_id;
+    frame->length = length;
+}
+
+bool
+gf_ipc_frame_valid (const gf_ipc_frame_t *frame)
+{
+    return memcmp (frame->magic, GF_IPC_MAGIC, sizeof (frame->magic)) == 0
+           && frame->version == GF_IPC_VERSION;
+}
+
+const char *
+gf_ipc_request_parse (char *buffer, size_t len, gf_ipc_frame_t *frame, bool *framed)
+{
+    *framed = len >= sizeof (frame->magic)
+              && memcmp (buffer, GF_IPC_MAGIC, sizeof (frame->magic)) == 0;
+
+    if (!*framed)
+    {
+        memset (frame, 0, sizeof (*frame));
+        buffer[len] = '\0';
+        return buffer;
+    }
+
+    if (len < sizeof (*frame))
+        return NULL;
+
+    memcpy (frame, buffer, sizeof (*frame));
+    if (!gf_ipc_frame_valid (frame) || frame->length != len - sizeof (*frame))
+        return NULL;
+
+    buffer[len] = '\0';
+    return buffer + sizeof (*frame);
+}
+
+char *
+gf_ipc_response_reserve (gf_ipc_response_t *response, size_t length)
+{
+    gf_ipc_response_release (response);
+    if (length >= UINT32_MAX)
+        return NULL;
+
+    char *data = response->message;
+    if (length >= sizeof (response->message))
+    {
+        data = gf_malloc (length + 1);
+        if (!data)
+            return NULL;
+        response->payload = data;
+    }
+
+    data[length] = '\0';
+    response->length = (uint32_t)length;
+    return data;
+}
+
+const char *
+gf_ipc_response_data (const gf_ipc_response_t *response)
+{
+    return response->payload ? response->payload : response->message;
+}
+
+uint32_t
+gf_ipc_response_length (const gf_ipc_response_t *response)
+{
+    if (response->length || response->payload)
+        return response->length;
+
+    const char *end = memchr (response->message, '\0', sizeof (response->message));
+    return end ? (uint32_t)(end - response->message + 1) : GF_IPC_MSG_SIZE;
+}
+
+void
+gf_ipc_response_flatten (gf_ipc_response_t *response)
+{
+    if (!response->payload)
+        return;
+
+    memcpy (response->message, response->payload, sizeof (response->message));
+    gf_ipc_response_release (response);
+    response->length = GF_IPC_MSG_SIZE;
+}
+
+void
+gf_ipc_response_release (gf_ipc_response_t *response)
+{
+    gf_free (response->payload);
+    response->payload = NULL;
+    response->length = 0;
+}
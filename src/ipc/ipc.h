@@ -2,10 +2,35 @@
 #define GRIDFLUX_IPC_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define GF_IPC_MSG_SIZE 8192
 
+/*
+ * Wire protocol, version 1: every request and reply is a gf_ipc_frame_t
+ * followed by exactly `length` payload bytes. A request carries the command
+ * string (no terminator); a reply carries whatever the command produced, with
+ * no size cap. A connection may carry any number of requests, pipelined or
+ * not; replies come back in order, each with its request's id. Fields are in
+ * host byte order, as the socket never leaves the machine.
+ *
+ * A request that does not open with GF_IPC_MAGIC comes from a legacy client:
+ * a bare command string, answered with the whole gf_ipc_response_t up to
+ * GF_IPC_LEGACY_SIZE. Replies too big for that layout are cut short there.
+ */
+#define GF_IPC_MAGIC "GFIP"
+#define GF_IPC_VERSION 1
+
+typedef struct
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t status;
+    uint32_t request_id;
+    uint32_t length;
+} gf_ipc_frame_t;
+
 typedef enum
 {
     GF_IPC_SUCCESS = 0,
@@ -15,24 +40,133 @@ typedef enum
     GF_IPC_ERROR_PERMISSION,
 } gf_ipc_status_t;
 
+/*
+ * Event topics for "subscribe <topics>". After the reply to that command the
+ * daemon keeps the connection and pushes one frame per event, with request id
+ * 0 and a single line of text as payload (no terminator):
+ *
+ *   window_added <window> <workspace>
+ *   window_removed <window>
+ *   window_moved <window> <workspace> <x> <y> <width> <height>
+ *   workspace_switched <monitor> <workspace>
+ *   focus_changed <monitor> <window>
+ *   config_reloaded
+ *   layout_applied <workspace> <windows placed>
+ *   overflow <count>
+ *
+ * Windows are handles in hex with a 0x prefix, as the CLI prints them; 0x0
+ * means none (focus_changed on a monitor with nothing focused).
+ *
+ * A subscriber that falls behind has pending events of the same kind and
+ * subject merged into the newest one; past that, new events are dropped and
+ * an "overflow" line counts them once there is room again. A client that
+ * sees one should resync with a query.
+ */
+#define GF_IPC_TOPIC_WINDOW_ADDED (1u << 0)
+#define GF_IPC_TOPIC_WINDOW_REMOVED (1u << 1)
+#define GF_IPC_TOPIC_WINDOW_MOVED (1u << 2)
+#define GF_IPC_TOPIC_WORKSPACE_SWITCHED (1u << 3)
+#define GF_IPC_TOPIC_FOCUS_CHANGED (1u << 4)
+#define GF_IPC_TOPIC_CONFIG_RELOADED (1u << 5)
+#define GF_IPC_TOPIC_LAYOUT_APPLIED (1u << 6)
+#define GF_IPC_TOPIC_ALL ((1u << 7) - 1)
+
+// Only the latest state matters for these, so queued ones can be merged
+#define GF_IPC_TOPIC_COALESCE                                                          \
+    (GF_IPC_TOPIC_WINDOW_MOVED | GF_IPC_TOPIC_WORKSPACE_SWITCHED                       \
+     | GF_IPC_TOPIC_FOCUS_CHANGED | GF_IPC_TOPIC_CONFIG_RELOADED                       \
+     | GF_IPC_TOPIC_LAYOUT_APPLIED)
+
+#define GF_IPC_EVENT_SIZE 128 // longest event line, terminator included
+#define GF_IPC_QUEUE_DEPTH 64 // events pending per subscriber
+#define GF_IPC_MAX_SUBSCRIBERS 16
+
 typedef struct
 {
     gf_ipc_status_t status;
     char message[GF_IPC_MSG_SIZE];
+    // Payload size. Replies that outgrow message[] live in `payload` instead;
+    // read either through gf_ipc_response_data and free with
+    // gf_ipc_response_release.
+    uint32_t length;
+    char *payload;
+    // Set by the transport before dispatch: the client predates framing and
+    // expects the fixed-record query layout
+    bool legacy;
+    // Set by the handler: after the reply, keep the connection open and push
+    // it events on these topics
+    uint32_t subscribe;
 } gf_ipc_response_t;
 
+// status and message[]: the reply as legacy clients expect it
+#define GF_IPC_LEGACY_SIZE (sizeof (gf_ipc_status_t) + GF_IPC_MSG_SIZE)
+
 typedef intptr_t gf_ipc_handle_t;
 
 // --- Server Operations ---
 gf_ipc_handle_t gf_ipc_server_create (void);
 void gf_ipc_server_destroy (gf_ipc_handle_t handle);
 bool gf_ipc_server_process (gf_ipc_handle_t handle, void *user_data);
+int gf_ipc_server_poll_fd (gf_ipc_handle_t handle);
+
+// --- Subscriptions ---
+// Whether a "subscribe" can be taken on
+bool gf_ipc_server_accepts_subscriber (gf_ipc_handle_t handle);
+// Whether anyone listens to topic, so callers can skip formatting the event
+bool gf_ipc_server_subscribed (gf_ipc_handle_t handle, uint32_t topic);
+// Queue an event for every subscriber of topic and write out what the sockets
+// take without blocking. key names the event's subject for coalescing.
+void gf_ipc_server_publish (gf_ipc_handle_t handle, uint32_t topic, uint64_t key,
+                            const char *event);
+// Retry whatever earlier publishes could not write
+void gf_ipc_server_flush (gf_ipc_handle_t handle);
 
 // --- Client Operations ---
 gf_ipc_handle_t gf_ipc_client_connect (void);
 void gf_ipc_client_disconnect (gf_ipc_handle_t handle);
 bool gf_ipc_client_send (gf_ipc_handle_t handle, const char *command,
                          gf_ipc_response_t *response);
+// Block for the next event on a subscribed connection and store its line,
+// NUL-terminated, in buffer. False once the daemon goes away.
+bool gf_ipc_client_next_event (gf_ipc_handle_t handle, char *buffer, size_t size);
+
+// --- Framing ---
+void gf_ipc_frame_init (gf_ipc_frame_t *frame, uint16_t status, uint32_t request_id,
+                        uint32_t length);
+bool gf_ipc_frame_valid (const gf_ipc_frame_t *frame);
+// Command string of a request held in buffer[0, len), which must have room for
+// a terminator at buffer[len]. *framed tells which protocol to answer in;
+// NULL when a framed request is malformed or incomplete.
+const char *gf_ipc_request_parse (char *buffer, size_t len, gf_ipc_frame_t *frame,
+                                  bool *framed);
+
+// Room for a `length` byte payload, NUL-terminated one past the end: message[]
+// when it fits, a heap block otherwise. NULL when the block cannot be had.
+char *gf_ipc_response_reserve (gf_ipc_response_t *response, size_t length);
+const char *gf_ipc_response_data (const gf_ipc_response_t *response);
+// Handlers that leave length at 0 have written a string into message[].
+uint32_t gf_ipc_response_length (const gf_ipc_response_t *response);
+// Copy as much of a heap payload as fits into message[] for a legacy reply.
+void gf_ipc_response_flatten (gf_ipc_response_t *response);
+void gf_ipc_response_release (gf_ipc_response_t *response);
+
+// --- Event Queues ---
+// A subscriber's pending event frames, oldest first (ipc/subscribe.c)
+typedef struct gf_ipc_queue gf_ipc_queue_t;
+
+gf_ipc_queue_t *gf_ipc_queue_create (void);
+void gf_ipc_queue_destroy (gf_ipc_queue_t *queue);
+void gf_ipc_queue_push (gf_ipc_queue_t *queue, uint32_t topic, uint64_t key,
+                        const char *event);
+// Unwritten bytes of the oldest frame, NULL when nothing is pending. Write
+// them and report how many went out with gf_ipc_queue_consume.
+const void *gf_ipc_queue_peek (const gf_ipc_queue_t *queue, size_t *len);
+void gf_ipc_queue_consume (gf_ipc_queue_t *queue, size_t len);
+
+// Comma or space separated topic names into a GF_IPC_TOPIC_* mask. "window"
+// stands for the three window topics; an empty list or "all" for every topic.
+bool gf_ipc_topics_parse (const char *list, uint32_t *topics);
+const char *gf_ipc_topic_name (uint32_t topic);
 
 // --- Misc Operations ---
 void gf_handle_client_message (const char *message, gf_ipc_response_t *response,
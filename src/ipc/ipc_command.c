@@ -1,24 +1,64 @@
+#define GF_MEM_TAG GF_MEM_TAG_IPC
+
 #include "ipc_command.h"
 #include "../config/rules.h"
 #include "../core/internal.h"
 #include "../core/wm.h"
+#include "../utils/intern.h"
 #include "../utils/logger.h"
 #include "../utils/memory.h"
+#include "../utils/trace.h"
 #include "ipc.h"
+#include "wire.h"
 #include <ctype.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// How many fixed-layout records fit in the reply payload after a header of
-// `header_bytes`. Used to cap every list we marshal into response->message so a
-// large window/workspace count can never overrun the fixed buffer.
-static uint32_t
-gf_ipc_max_records (size_t header_bytes, size_t record_size)
+// Text replies carry the type and the used part of the message only; the
+// client sees the rest of gf_command_response_t zeroed.
+static void
+gf_ipc_reply (gf_ipc_response_t *response, const gf_command_response_t *resp)
 {
-    if (record_size == 0 || GF_IPC_MSG_SIZE <= header_bytes)
-        return 0;
-    return (uint32_t)((GF_IPC_MSG_SIZE - header_bytes) / record_size);
+    const char *end = memchr (resp->message, '\0', sizeof (resp->message));
+    size_t text = end ? (size_t)(end - resp->message) : sizeof (resp->message) - 1;
+    size_t length = offsetof (gf_command_response_t, message) + text + 1;
+
+    memcpy (response->message, resp, length - 1);
+    response->message[length - 1] = '\0';
+    response->length = (uint32_t)length;
+}
+
+// A reserve failure leaves an error the client can still parse.
+static char *
+gf_ipc_reserve_list (gf_ipc_response_t *response, size_t length)
+{
+    char *data = gf_ipc_response_reserve (response, length);
+    if (!data)
+    {
+        response->status = GF_IPC_ERROR_INVALID_COMMAND;
+        gf_command_response_t resp = { .type = 1 };
+        snprintf (resp.message, sizeof (resp.message), "Out of memory");
+        gf_ipc_reply (response, &resp);
+    }
+    return data;
+}
+
+static void
+gf_win_to_wire (const gf_win_info_t *win, gf_win_wire_t *wire)
+{
+    memset (wire, 0, sizeof (*wire));
+    wire->id = win->id;
+    wire->workspace_id = win->workspace_id;
+    wire->monitor_id = win->monitor_id;
+    wire->geometry = win->geometry;
+    wire->is_maximized = win->is_maximized;
+    wire->is_minimized = win->is_minimized;
+    wire->needs_update = win->needs_update;
+    wire->is_valid = win->is_valid;
+    wire->last_modified = win->last_modified;
+    strncpy (wire->name, gf_win_name (win), sizeof (wire->name) - 1);
 }
 
 static void
@@ -41,6 +81,79 @@ gf_parse_command (const char *input, char *command, char *args, size_t args_size
     args[args_size - 1] = '\0';
 }
 
+// Pre-framing layout: a count, the list capacity and one gf_win_wire_t per
+// window. Legacy replies stop at GF_IPC_MSG_SIZE, and those clients clamp the
+// count to what arrived.
+static void
+gf_query_windows_legacy (const gf_win_list_t *windows, gf_ipc_response_t *response)
+{
+    size_t length = 2 * sizeof (uint32_t) + windows->count * sizeof (gf_win_wire_t);
+    char *data = gf_ipc_reserve_list (response, length);
+    if (!data)
+        return;
+
+    size_t offset = 0;
+    memcpy (data + offset, &windows->count, sizeof (uint32_t));
+    offset += sizeof (uint32_t);
+    memcpy (data + offset, &windows->capacity, sizeof (uint32_t));
+    offset += sizeof (uint32_t);
+    for (uint32_t i = 0; i < windows->count; i++)
+    {
+        gf_win_wire_t wire;
+        gf_win_to_wire (&windows->items[i], &wire);
+        memcpy (data + offset, &wire, sizeof (wire));
+        offset += sizeof (wire);
+    }
+}
+
+// Pre-framing layout: count, capacity, the first monitor's active workspace
+// and one gf_ws_wire_t per workspace.
+static void
+gf_query_workspaces_legacy (const gf_ws_list_t *workspaces, gf_ipc_response_t *response)
+{
+    size_t length = 2 * sizeof (uint32_t) + sizeof (gf_ws_id_t)
+                    + workspaces->count * sizeof (gf_ws_wire_t);
+    char *data = gf_ipc_reserve_list (response, length);
+    if (!data)
+        return;
+
+    size_t offset = 0;
+    memcpy (data + offset, &workspaces->count, sizeof (uint32_t));
+    offset += sizeof (uint32_t);
+    memcpy (data + offset, &workspaces->capacity, sizeof (uint32_t));
+    offset += sizeof (uint32_t);
+    memcpy (data + offset, &workspaces->active_workspace, sizeof (gf_ws_id_t));
+    offset += sizeof (gf_ws_id_t);
+    for (uint32_t i = 0; i < workspaces->count; i++)
+    {
+        const gf_ws_info_t *ws = &workspaces->items[i];
+        gf_ws_wire_t wire = {
+            .id = ws->id,
+            .window_count = ws->window_count,
+            .max_windows = ws->max_windows,
+            .available_space = ws->available_space,
+            .is_locked = ws->is_locked,
+            .has_maximized_state = ws->has_maximized_state,
+            .is_custom_layout = ws->is_custom_layout,
+            .has_rule = ws->has_rule,
+        };
+        memcpy (data + offset, &wire, sizeof (wire));
+        offset += sizeof (wire);
+    }
+}
+
+// "since <generation>" asks for a delta instead of the full list
+static bool
+gf_parse_since (const char *args, uint64_t *since)
+{
+    unsigned long long value;
+    if (!args || sscanf (args, "since %llu", &value) != 1)
+        return false;
+
+    *since = value;
+    return true;
+}
+
 static void
 gf_cmd_query_windows (const char *args, gf_ipc_response_t *response, void *user_data)
 {
@@ -53,26 +166,33 @@ gf_cmd_query_windows (const char *args, gf_ipc_response_t *response, void *user_
     for (uint32_t i = 0; i < windows->count; i++)
     {
         gf_win_info_t *w = &windows->items[i];
-        if (!w->name[0])
-        {
-            gf_wm_window_class (m, w->id, w->name, sizeof (w->name) - 1);
-        }
+        if (w->name_id == GF_STR_NONE)
+            w->name_id = gf_wm_resolve_window_name (m, w->id, GF_STR_NONE);
     }
 
-    uint32_t max_items
-        = gf_ipc_max_records (2 * sizeof (uint32_t), sizeof (gf_win_info_t));
-    uint32_t send_count = (windows->count < max_items) ? windows->count : max_items;
-    if (send_count < windows->count)
-        GF_LOG_WARN ("query windows: truncating %u -> %u to fit IPC buffer",
-                     windows->count, send_count);
+    if (response->legacy)
+    {
+        gf_query_windows_legacy (windows, response);
+        return;
+    }
 
-    size_t offset = 0;
-    memcpy (response->message + offset, &send_count, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
-    memcpy (response->message + offset, &windows->capacity, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
-    memcpy (response->message + offset, windows->items,
-            send_count * sizeof (gf_win_info_t));
+    uint64_t since;
+    if (gf_parse_since (args, &since))
+    {
+        gf_wire_delta_t delta;
+        gf_wm_changes_sweep (m);
+        gf_wm_changes_since (m, &m->state.window_changes, since, &delta);
+
+        char *data = gf_ipc_reserve_list (
+            response, gf_wire_encode_windows_since (windows, since, &delta, NULL));
+        if (data)
+            gf_wire_encode_windows_since (windows, since, &delta, data);
+        return;
+    }
+
+    char *data = gf_ipc_reserve_list (response, gf_wire_encode_windows (windows, NULL));
+    if (data)
+        gf_wire_encode_windows (windows, data);
 }
 
 static void
@@ -89,20 +209,30 @@ gf_cmd_query_workspaces (const char *args, gf_ipc_response_t *response, void *us
         return;
     }
 
-    size_t header = 2 * sizeof (uint32_t) + sizeof (gf_ws_id_t);
-    uint32_t max_items = gf_ipc_max_records (header, sizeof (gf_ws_info_t));
-    uint32_t send_count = (workspaces->count < max_items) ? workspaces->count : max_items;
+    if (response->legacy)
+    {
+        gf_query_workspaces_legacy (workspaces, response);
+        return;
+    }
 
-    size_t offset = 0;
-    memcpy (response->message + offset, &send_count, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
-    memcpy (response->message + offset, &workspaces->capacity, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
-    memcpy (response->message + offset, &workspaces->active_workspace,
-            sizeof (gf_ws_id_t));
-    offset += sizeof (gf_ws_id_t);
-    memcpy (response->message + offset, workspaces->items,
-            send_count * sizeof (gf_ws_info_t));
+    uint64_t since;
+    if (gf_parse_since (args, &since))
+    {
+        gf_wire_delta_t delta;
+        gf_wm_changes_sweep (m);
+        gf_wm_changes_since (m, &m->state.workspace_changes, since, &delta);
+
+        char *data = gf_ipc_reserve_list (
+            response, gf_wire_encode_workspaces_since (workspaces, since, &delta, NULL));
+        if (data)
+            gf_wire_encode_workspaces_since (workspaces, since, &delta, data);
+        return;
+    }
+
+    char *data
+        = gf_ipc_reserve_list (response, gf_wire_encode_workspaces (workspaces, NULL));
+    if (data)
+        gf_wire_encode_workspaces (workspaces, data);
 }
 
 static void
@@ -127,7 +257,7 @@ gf_cmd_query_count (const char *args, gf_ipc_response_t *response, void *user_da
                   windows->count);
     }
 
-    memcpy (response->message, &resp, sizeof (resp));
+    gf_ipc_reply (response, &resp);
 }
 
 static void
@@ -146,7 +276,7 @@ gf_cmd_move_window (const char *args, gf_ipc_response_t *response, void *user_da
         resp.type = 1;
         snprintf (resp.message, sizeof (resp.message),
                   "Usage: move <window_id> <workspace_id>");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -182,7 +312,7 @@ gf_cmd_move_window (const char *args, gf_ipc_response_t *response, void *user_da
         break;
     }
 
-    memcpy (response->message, &resp, sizeof (resp));
+    gf_ipc_reply (response, &resp);
 }
 
 static void
@@ -198,7 +328,7 @@ gf_cmd_lock_workspace (const char *args, gf_ipc_response_t *response, void *user
         response->status = GF_IPC_ERROR_INVALID_COMMAND;
         resp.type = 1;
         snprintf (resp.message, sizeof (resp.message), "Usage: lock <workspace_id>");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -231,7 +361,7 @@ gf_cmd_lock_workspace (const char *args, gf_ipc_response_t *response, void *user
         break;
     }
 
-    memcpy (response->message, &resp, sizeof (resp));
+    gf_ipc_reply (response, &resp);
 }
 
 static void
@@ -247,7 +377,7 @@ gf_cmd_unlock_workspace (const char *args, gf_ipc_response_t *response, void *us
         response->status = GF_IPC_ERROR_INVALID_COMMAND;
         resp.type = 1;
         snprintf (resp.message, sizeof (resp.message), "Usage: unlock <workspace_id>");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -280,7 +410,7 @@ gf_cmd_unlock_workspace (const char *args, gf_ipc_response_t *response, void *us
         break;
     }
 
-    memcpy (response->message, &resp, sizeof (resp));
+    gf_ipc_reply (response, &resp);
 }
 
 static void
@@ -298,7 +428,7 @@ gf_cmd_rule_add (const char *args, gf_ipc_response_t *response, void *user_data)
         resp.type = 1;
         snprintf (resp.message, sizeof (resp.message),
                   "Usage: rule add <wm_class> <workspace_id>");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -310,7 +440,7 @@ gf_cmd_rule_add (const char *args, gf_ipc_response_t *response, void *user_data)
         resp.type = 1;
         snprintf (resp.message, sizeof (resp.message),
                   "Cannot add rule to a maximized workspace");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -332,7 +462,7 @@ gf_cmd_rule_add (const char *args, gf_ipc_response_t *response, void *user_data)
             snprintf (resp.message, sizeof (resp.message),
                       "Cannot add rule: Workspace %d would exceed max windows limit (%d)",
                       workspace_id, m->config->max_windows_per_workspace);
-            memcpy (response->message, &resp, sizeof (resp));
+            gf_ipc_reply (response, &resp);
             return;
         }
     }
@@ -347,7 +477,7 @@ gf_cmd_rule_add (const char *args, gf_ipc_response_t *response, void *user_data)
         snprintf (resp.message, sizeof (resp.message), "Failed to add rule (error %d)",
                   result);
 
-    memcpy (response->message, &resp, sizeof (resp));
+    gf_ipc_reply (response, &resp);
 }
 
 static void
@@ -363,7 +493,7 @@ gf_cmd_rule_remove (const char *args, gf_ipc_response_t *response, void *user_da
         response->status = GF_IPC_ERROR_INVALID_COMMAND;
         resp.type = 1;
         snprintf (resp.message, sizeof (resp.message), "Usage: rule remove <wm_class>");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -375,7 +505,7 @@ gf_cmd_rule_remove (const char *args, gf_ipc_response_t *response, void *user_da
     else
         snprintf (resp.message, sizeof (resp.message), "No rule found for: %s", wm_class);
 
-    memcpy (response->message, &resp, sizeof (resp));
+    gf_ipc_reply (response, &resp);
 }
 
 static void
@@ -390,7 +520,7 @@ gf_cmd_rule_list (const char *args, gf_ipc_response_t *response, void *user_data
     if (count == 0)
     {
         snprintf (resp.message, sizeof (resp.message), "No window rules configured");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -409,7 +539,7 @@ gf_cmd_rule_list (const char *args, gf_ipc_response_t *response, void *user_data
                          m->config->window_rules[i].workspace_id);
     }
 
-    memcpy (response->message, &resp, sizeof (resp));
+    gf_ipc_reply (response, &resp);
 }
 
 static void
@@ -421,8 +551,9 @@ gf_cmd_query_apps (const char *args, gf_ipc_response_t *response, void *user_dat
     gf_command_response_t resp;
     resp.type = 0;
 
-    // Collect unique class names from tracked windows
-    char classes[128][128];
+    // Collect unique class names from tracked windows; classes are interned, so
+    // duplicates are found by id
+    gf_str_id_t classes[128];
     uint32_t class_count = 0;
 
     for (uint32_t i = 0; i < windows->count && class_count < 128; i++)
@@ -430,14 +561,14 @@ gf_cmd_query_apps (const char *args, gf_ipc_response_t *response, void *user_dat
         char name[128];
         gf_wm_window_class (m, windows->items[i].id, name, sizeof (name));
 
-        if (name[0] == '\0')
+        gf_str_id_t class_id = gf_intern (name);
+        if (class_id == GF_STR_NONE)
             continue;
 
-        // Check for duplicate
         bool found = false;
         for (uint32_t j = 0; j < class_count; j++)
         {
-            if (strcmp (classes[j], name) == 0)
+            if (classes[j] == class_id)
             {
                 found = true;
                 break;
@@ -445,17 +576,13 @@ gf_cmd_query_apps (const char *args, gf_ipc_response_t *response, void *user_dat
         }
 
         if (!found)
-        {
-            strncpy (classes[class_count], name, 127);
-            classes[class_count][127] = '\0';
-            class_count++;
-        }
+            classes[class_count++] = class_id;
     }
 
     if (class_count == 0)
     {
         snprintf (resp.message, sizeof (resp.message), "No applications found");
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
         return;
     }
 
@@ -463,10 +590,121 @@ gf_cmd_query_apps (const char *args, gf_ipc_response_t *response, void *user_dat
     for (uint32_t i = 0; i < class_count && pos < sizeof (resp.message) - 130; i++)
     {
         pos += snprintf (resp.message + pos, sizeof (resp.message) - pos, "%s\n",
-                         classes[i]);
+                         gf_intern_str (classes[i]));
+    }
+
+    gf_ipc_reply (response, &resp);
+}
+
+// Plain-text reply: the table is larger than gf_command_response_t can carry.
+static void
+gf_cmd_stats (const char *args, gf_ipc_response_t *response, void *user_data)
+{
+    gf_wm_t *m = (gf_wm_t *)user_data;
+
+    if (args && strcmp (args, "reset") == 0)
+    {
+        gf_wm_stats_reset (m);
+        snprintf (response->message, sizeof (response->message), "Stats reset\n");
+        return;
     }
 
-    memcpy (response->message, &resp, sizeof (resp));
+    if (args && strcmp (args, "memory") == 0)
+    {
+        gf_wm_memory_format (response->message, sizeof (response->message));
+        return;
+    }
+
+    gf_wm_stats_format (m, response->message, sizeof (response->message));
+}
+
+// trace start [EVENTS] | stop | dump [PATH]. The dump is written by the
+// daemon, so a relative PATH resolves against its working directory.
+static void
+gf_cmd_trace (const char *args, gf_ipc_response_t *response, void *user_data)
+{
+    gf_wm_t *m = (gf_wm_t *)user_data;
+    gf_command_response_t resp;
+    char subcommand[64] = { 0 };
+    char subargs[256] = { 0 };
+
+    gf_parse_command (args, subcommand, subargs, sizeof (subargs));
+    resp.type = 0;
+
+    if (strcmp (subcommand, "start") == 0)
+    {
+        unsigned int capacity = 0;
+        if (subargs[0])
+            sscanf (subargs, "%u", &capacity);
+
+        gf_err_t result = gf_wm_trace_start (m, capacity);
+        resp.type = (result == GF_SUCCESS) ? 0 : 1;
+        if (result == GF_SUCCESS)
+            snprintf (resp.message, sizeof (resp.message), "Tracing started");
+        else
+            snprintf (resp.message, sizeof (resp.message), "Failed to start tracing: %d",
+                      result);
+    }
+    else if (strcmp (subcommand, "stop") == 0)
+    {
+        gf_wm_trace_stop (m);
+        snprintf (resp.message, sizeof (resp.message),
+                  "Tracing stopped, %u events buffered", gf_trace_count ());
+    }
+    else if (strcmp (subcommand, "dump") == 0)
+    {
+        char path[512];
+        gf_err_t result = gf_trace_write (subargs, path, sizeof (path));
+        resp.type = (result == GF_SUCCESS) ? 0 : 1;
+        if (result == GF_SUCCESS)
+            snprintf (resp.message, sizeof (resp.message), "Wrote %u events to %s",
+                      gf_trace_count (), path);
+        else
+            snprintf (resp.message, sizeof (resp.message), "Failed to write %s", path);
+    }
+    else
+    {
+        response->status = GF_IPC_ERROR_INVALID_COMMAND;
+        resp.type = 1;
+        snprintf (resp.message, sizeof (resp.message),
+                  "Usage: trace start [events] | stop | dump [path]");
+    }
+
+    gf_ipc_reply (response, &resp);
+}
+
+// subscribe [TOPICS]. The transport keeps the connection once the reply is
+// out, so everything that could stop that is checked here first.
+static void
+gf_cmd_subscribe (const char *args, gf_ipc_response_t *response, void *user_data)
+{
+    gf_wm_t *m = (gf_wm_t *)user_data;
+    gf_command_response_t resp = { .type = 1 };
+    uint32_t topics;
+
+    if (!gf_ipc_topics_parse (args, &topics))
+        snprintf (resp.message, sizeof (resp.message),
+                  "Unknown topic in '%s'; topics: window_added window_removed "
+                  "window_moved workspace_switched focus_changed config_reloaded "
+                  "layout_applied, or window / all",
+                  args);
+    else if (response->legacy)
+        snprintf (resp.message, sizeof (resp.message),
+                  "subscribe needs a client that speaks the framed protocol");
+    else if (!gf_ipc_server_accepts_subscriber (m->ipc_handle))
+        snprintf (resp.message, sizeof (resp.message),
+                  "No room for another subscriber (at most %d; none on Windows)",
+                  GF_IPC_MAX_SUBSCRIBERS);
+    else
+    {
+        resp.type = 0;
+        response->subscribe = topics;
+        snprintf (resp.message, sizeof (resp.message), "Subscribed");
+    }
+
+    if (resp.type)
+        response->status = GF_IPC_ERROR_INVALID_COMMAND;
+    gf_ipc_reply (response, &resp);
 }
 
 void
@@ -475,6 +713,7 @@ gf_handle_client_message (const char *message, gf_ipc_response_t *response,
 {
     char command[64] = { 0 };
     char args[256] = { 0 };
+    uint64_t trace_start = gf_trace_begin ();
 
     gf_parse_command (message, command, args, sizeof (args));
 
@@ -507,7 +746,7 @@ gf_handle_client_message (const char *message, gf_ipc_response_t *response,
             resp.type = 1;
             snprintf (resp.message, sizeof (resp.message), "Unknown query: %s",
                       subcommand);
-            memcpy (response->message, &resp, sizeof (resp));
+            gf_ipc_reply (response, &resp);
         }
     }
     else if (strcmp (command, "move") == 0)
@@ -531,7 +770,7 @@ gf_handle_client_message (const char *message, gf_ipc_response_t *response,
             gf_command_response_t resp;
             resp.type = 1;
             snprintf (resp.message, sizeof (resp.message), "WM not initialized");
-            memcpy (response->message, &resp, sizeof (resp));
+            gf_ipc_reply (response, &resp);
         }
         else
         {
@@ -545,9 +784,21 @@ gf_handle_client_message (const char *message, gf_ipc_response_t *response,
             resp.type = 0;
             snprintf (resp.message, sizeof (resp.message), "Borders %s",
                       m->config->enable_borders ? "enabled" : "disabled");
-            memcpy (response->message, &resp, sizeof (resp));
+            gf_ipc_reply (response, &resp);
         }
     }
+    else if (strcmp (command, "stats") == 0)
+    {
+        gf_cmd_stats (args, response, user_data);
+    }
+    else if (strcmp (command, "trace") == 0)
+    {
+        gf_cmd_trace (args, response, user_data);
+    }
+    else if (strcmp (command, "subscribe") == 0)
+    {
+        gf_cmd_subscribe (args, response, user_data);
+    }
     else if (strcmp (command, "rule") == 0)
     {
         char subcommand[64] = { 0 };
@@ -573,7 +824,7 @@ gf_handle_client_message (const char *message, gf_ipc_response_t *response,
             resp.type = 1;
             snprintf (resp.message, sizeof (resp.message), "Unknown rule command: %s",
                       subcommand);
-            memcpy (response->message, &resp, sizeof (resp));
+            gf_ipc_reply (response, &resp);
         }
     }
     else
@@ -582,86 +833,46 @@ gf_handle_client_message (const char *message, gf_ipc_response_t *response,
         gf_command_response_t resp;
         resp.type = 1;
         snprintf (resp.message, sizeof (resp.message), "Unknown command: %s", command);
-        memcpy (response->message, &resp, sizeof (resp));
+        gf_ipc_reply (response, &resp);
     }
+
+    gf_trace_end (GF_TRACE_IPC, message, trace_start);
 }
 
 gf_ws_list_t *
-gf_parse_workspace_list (const char *buffer)
+gf_parse_workspace_list (const char *buffer, size_t length)
 {
-    if (!buffer)
-        return NULL;
-
-    gf_ws_list_t *list = gf_malloc (sizeof (gf_ws_list_t));
-    if (!list)
-        return NULL;
-
-    size_t offset = 0;
-    memcpy (&list->count, buffer + offset, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
-    memcpy (&list->capacity, buffer + offset, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
-    memcpy (&list->active_workspace, buffer + offset, sizeof (gf_ws_id_t));
-    offset += sizeof (gf_ws_id_t);
-
-    // Never trust the peer-supplied count: clamp it to what the fixed reply
-    // buffer can actually hold before allocating/copying.
-    uint32_t max_items = gf_ipc_max_records (offset, sizeof (gf_ws_info_t));
-    if (list->count > max_items)
-        list->count = max_items;
-    if (list->count == 0)
-    {
-        list->items = NULL;
-        return list;
-    }
-
-    list->items = gf_malloc (list->count * sizeof (gf_ws_info_t));
-    if (!list->items)
-    {
-        gf_free (list);
-        return NULL;
-    }
-
-    memcpy (list->items, buffer + offset, list->count * sizeof (gf_ws_info_t));
-
-    return list;
+    return gf_wire_decode_workspaces (buffer, length);
 }
 
 gf_win_list_t *
-gf_parse_window_list (const char *buffer)
+gf_parse_window_list (const char *buffer, size_t length)
 {
-    if (!buffer)
-        return NULL;
-
-    gf_win_list_t *list = gf_malloc (sizeof (gf_win_list_t));
-    if (!list)
-        return NULL;
-
-    size_t offset = 0;
-    memcpy (&list->count, buffer + offset, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
-    memcpy (&list->capacity, buffer + offset, sizeof (uint32_t));
-    offset += sizeof (uint32_t);
+    return gf_wire_decode_windows (buffer, length);
+}
 
-    // Never trust the peer-supplied count: clamp it to what the fixed reply
-    // buffer can actually hold before allocating/copying.
-    uint32_t max_items = gf_ipc_max_records (offset, sizeof (gf_win_info_t));
-    if (list->count > max_items)
-        list->count = max_items;
-    if (list->count == 0)
-    {
-        list->items = NULL;
-        return list;
-    }
+gf_ws_list_t *
+gf_parse_workspace_delta (const char *buffer, size_t length, gf_wire_delta_t *delta)
+{
+    return gf_wire_decode_workspaces_since (buffer, length, delta);
+}
 
-    list->items = gf_malloc (list->count * sizeof (gf_win_info_t));
-    if (!list->items)
-    {
-        gf_free (list);
-        return NULL;
-    }
+gf_win_list_t *
+gf_parse_window_delta (const char *buffer, size_t length, gf_wire_delta_t *delta)
+{
+    return gf_wire_decode_windows_since (buffer, length, delta);
+}
 
-    memcpy (list->items, buffer + offset, list->count * sizeof (gf_win_info_t));
+void
+gf_free_workspace_list (gf_ws_list_t *list)
+{
+    gf_workspace_list_cleanup (list);
+    gf_free (list);
+}
 
-    return list;
+void
+gf_free_window_list (gf_win_list_t *list)
+{
+    gf_window_list_cleanup (list);
+    gf_free (list);
 }
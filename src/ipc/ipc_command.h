@@ -2,6 +2,7 @@
 #define GF_IPC_COMMAND_H
 
 #include "../utils/list.h"
+#include "wire.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -11,8 +12,47 @@ typedef struct
     char message[256];
 } gf_command_response_t;
 
-gf_ws_list_t *gf_parse_workspace_list (const char *json_str);
-gf_win_list_t *gf_parse_window_list (const char *json_str);
+// Window record as sent to legacy (unframed) clients. The name travels
+// inline; the layout is that of gf_win_info_t before names were interned.
+// Framed clients get the compact encoding from wire.h instead.
+typedef struct
+{
+    gf_handle_t id;
+    gf_ws_id_t workspace_id;
+    gf_monitor_id_t monitor_id;
+    gf_rect_t geometry;
+    bool is_maximized;
+    bool is_minimized;
+    bool needs_update;
+    bool is_valid;
+    time_t last_modified;
+    char name[GF_WIN_NAME_MAX];
+} gf_win_wire_t;
+
+// Workspace record as sent to legacy clients: gf_ws_info_t before it gained
+// change-tracking fields.
+typedef struct
+{
+    gf_ws_id_t id;
+    uint32_t window_count;
+    uint32_t max_windows;
+    int32_t available_space;
+    bool is_locked;
+    bool has_maximized_state;
+    bool is_custom_layout;
+    bool has_rule;
+} gf_ws_wire_t;
+
+// Decode a query reply payload of `length` bytes (gf_ipc_response_data).
+// Release the result with gf_free_workspace_list / gf_free_window_list.
+gf_ws_list_t *gf_parse_workspace_list (const char *buffer, size_t length);
+gf_win_list_t *gf_parse_window_list (const char *buffer, size_t length);
+// Replies to "query ... since <generation>"; release delta with
+// gf_wire_delta_release as well.
+gf_ws_list_t *gf_parse_workspace_delta (const char *buffer, size_t length,
+                                        gf_wire_delta_t *delta);
+gf_win_list_t *gf_parse_window_delta (const char *buffer, size_t length,
+                                      gf_wire_delta_t *delta);
 void gf_free_workspace_list (gf_ws_list_t *list);
 void gf_free_window_list (gf_win_list_t *list);
 
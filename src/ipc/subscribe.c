@@ -0,0 +1,202 @@
+#define GF_MEM_TAG GF_MEM_TAG_IPC
+
+#include "../utils/memory.h"
+#include "ipc.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Per-subscriber event queue. Each entry holds a ready-to-send frame, so the
+ * transport only ever writes bytes out of the oldest one; `offset` says how
+ * much of it a short write already got through. The queue is a fixed ring:
+ * publishing never allocates and never waits on a slow reader.
+ */
+typedef struct
+{
+    uint32_t topic;
+    uint64_t key;
+    uint32_t length; // frame header plus event text
+    char data[sizeof (gf_ipc_frame_t) + GF_IPC_EVENT_SIZE];
+} gf_ipc_queued_t;
+
+struct gf_ipc_queue
+{
+    gf_ipc_queued_t entries[GF_IPC_QUEUE_DEPTH];
+    uint32_t head;
+    uint32_t count;
+    uint32_t offset;  // bytes of the head entry already written
+    uint32_t dropped; // events lost since the last overflow notice
+};
+
+static const struct
+{
+    uint32_t topic;
+    const char *name;
+} g_ipc_topics[] = {
+    { GF_IPC_TOPIC_WINDOW_ADDED, "window_added" },
+    { GF_IPC_TOPIC_WINDOW_REMOVED, "window_removed" },
+    { GF_IPC_TOPIC_WINDOW_MOVED, "window_moved" },
+    { GF_IPC_TOPIC_WORKSPACE_SWITCHED, "workspace_switched" },
+    { GF_IPC_TOPIC_FOCUS_CHANGED, "focus_changed" },
+    { GF_IPC_TOPIC_CONFIG_RELOADED, "config_reloaded" },
+    { GF_IPC_TOPIC_LAYOUT_APPLIED, "layout_applied" },
+};
+
+#define GF_IPC_TOPIC_COUNT (sizeof (g_ipc_topics) / sizeof (g_ipc_topics[0]))
+
+gf_ipc_queue_t *
+gf_ipc_queue_create (void)
+{
+    return gf_calloc (1, sizeof (gf_ipc_queue_t));
+}
+
+void
+gf_ipc_queue_destroy (gf_ipc_queue_t *queue)
+{
+    gf_free (queue);
+}
+
+static void
+_queue_fill (gf_ipc_queued_t *entry, uint32_t topic, uint64_t key, const char *event)
+{
+    const char *end = memchr (event, '\0', GF_IPC_EVENT_SIZE - 1);
+    size_t text = end ? (size_t)(end - event) : GF_IPC_EVENT_SIZE - 1;
+    gf_ipc_frame_t frame;
+
+    // Request id 0: nobody asked, this is a pushed event
+    gf_ipc_frame_init (&frame, GF_IPC_SUCCESS, 0, (uint32_t)text);
+    memcpy (entry->data, &frame, sizeof (frame));
+    memcpy (entry->data + sizeof (frame), event, text);
+
+    entry->topic = topic;
+    entry->key = key;
+    entry->length = (uint32_t)(sizeof (frame) + text);
+}
+
+static void
+_queue_append (gf_ipc_queue_t *queue, uint32_t topic, uint64_t key, const char *event)
+{
+    uint32_t slot = (queue->head + queue->count) % GF_IPC_QUEUE_DEPTH;
+    _queue_fill (&queue->entries[slot], topic, key, event);
+    queue->count++;
+}
+
+// A pending event about the same subject takes the new text. The head entry
+// is off limits once part of it has been written.
+static bool
+_queue_coalesce (gf_ipc_queue_t *queue, uint32_t topic, uint64_t key, const char *event)
+{
+    for (uint32_t i = queue->offset ? 1 : 0; i < queue->count; i++)
+    {
+        gf_ipc_queued_t *entry = &queue->entries[(queue->head + i) % GF_IPC_QUEUE_DEPTH];
+        if (entry->topic == topic && entry->key == key)
+        {
+            _queue_fill (entry, topic, key, event);
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+gf_ipc_queue_push (gf_ipc_queue_t *queue, uint32_t topic, uint64_t key,
+                   const char *event)
+{
+    if ((topic & GF_IPC_TOPIC_COALESCE) && _queue_coalesce (queue, topic, key, event))
+        return;
+
+    // The notice needs a slot of its own ahead of the event
+    uint32_t needed = queue->dropped ? 2 : 1;
+    if (queue->count + needed > GF_IPC_QUEUE_DEPTH)
+    {
+        queue->dropped++;
+        return;
+    }
+
+    if (queue->dropped)
+    {
+        char notice[GF_IPC_EVENT_SIZE];
+        snprintf (notice, sizeof (notice), "overflow %u", queue->dropped);
+        _queue_append (queue, 0, 0, notice);
+        queue->dropped = 0;
+    }
+
+    _queue_append (queue, topic, key, event);
+}
+
+const void *
+gf_ipc_queue_peek (const gf_ipc_queue_t *queue, size_t *len)
+{
+    if (queue->count == 0)
+        return NULL;
+
+    const gf_ipc_queued_t *entry = &queue->entries[queue->head];
+    *len = entry->length - queue->offset;
+    return entry->data + queue->offset;
+}
+
+void
+gf_ipc_queue_consume (gf_ipc_queue_t *queue, size_t len)
+{
+    if (queue->count == 0)
+        return;
+
+    queue->offset += (uint32_t)len;
+    if (queue->offset < queue->entries[queue->head].length)
+        return;
+
+    queue->offset = 0;
+    queue->head = (queue->head + 1) % GF_IPC_QUEUE_DEPTH;
+    queue->count--;
+}
+
+bool
+gf_ipc_topics_parse (const char *list, uint32_t *topics)
+{
+    *topics = 0;
+
+    while (list && *list)
+    {
+        size_t len = strcspn (list, ", ");
+        if (len == 0)
+        {
+            list++;
+            continue;
+        }
+
+        uint32_t topic = 0;
+        if (len == 3 && strncmp (list, "all", len) == 0)
+            topic = GF_IPC_TOPIC_ALL;
+        else if (len == 6 && strncmp (list, "window", len) == 0)
+            topic = GF_IPC_TOPIC_WINDOW_ADDED | GF_IPC_TOPIC_WINDOW_REMOVED
+                    | GF_IPC_TOPIC_WINDOW_MOVED;
+
+        for (size_t i = 0; i < GF_IPC_TOPIC_COUNT && !topic; i++)
+        {
+            if (strlen (g_ipc_topics[i].name) == len
+                && strncmp (list, g_ipc_topics[i].name, len) == 0)
+                topic = g_ipc_topics[i].topic;
+        }
+
+        if (!topic)
+            return false;
+
+        *topics |= topic;
+        list += len;
+    }
+
+    if (*topics == 0)
+        *topics = GF_IPC_TOPIC_ALL;
+    return true;
+}
+
+const char *
+gf_ipc_topic_name (uint32_t topic)
+{
+    for (size_t i = 0; i < GF_IPC_TOPIC_COUNT; i++)
+    {
+        if (g_ipc_topics[i].topic == topic)
+            return g_ipc_topics[i].name;
+    }
+    return "unknown";
+}
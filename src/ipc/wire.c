@@ -0,0 +1,473 @@
+#define GF_MEM_TAG GF_MEM_TAG_IPC
+
+#include "wire.h"
+#include "../utils/intern.h"
+#include "../utils/memory.h"
+#include <string.h>
+
+// Smallest encoding of one record (every field a single byte), used to bound
+// the count a peer may claim before anything is allocated
+#define GF_WIRE_WIN_MIN_BYTES 10
+#define GF_WIRE_WS_MIN_BYTES 5
+
+typedef struct
+{
+    uint8_t *data; // NULL while measuring
+    size_t pos;
+} gf_wire_writer_t;
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    bool failed;
+} gf_wire_reader_t;
+
+static void
+_wire_put_byte (gf_wire_writer_t *w, uint8_t byte)
+{
+    if (w->data)
+        w->data[w->pos] = byte;
+    w->pos++;
+}
+
+static void
+_wire_put_uvar (gf_wire_writer_t *w, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        _wire_put_byte (w, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    _wire_put_byte (w, (uint8_t)value);
+}
+
+static void
+_wire_put_svar (gf_wire_writer_t *w, int64_t value)
+{
+    uint64_t sign = value < 0 ? ~(uint64_t)0 : 0;
+    _wire_put_uvar (w, ((uint64_t)value << 1) ^ sign);
+}
+
+static void
+_wire_put_bytes (gf_wire_writer_t *w, const void *bytes, size_t len)
+{
+    if (w->data)
+        memcpy (w->data + w->pos, bytes, len);
+    w->pos += len;
+}
+
+static uint8_t
+_wire_get_byte (gf_wire_reader_t *r)
+{
+    if (r->pos >= r->size)
+    {
+        r->failed = true;
+        return 0;
+    }
+    return r->data[r->pos++];
+}
+
+static uint64_t
+_wire_get_uvar (gf_wire_reader_t *r)
+{
+    uint64_t value = 0;
+
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t byte = _wire_get_byte (r);
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+
+    r->failed = true;
+    return 0;
+}
+
+static int64_t
+_wire_get_svar (gf_wire_reader_t *r)
+{
+    uint64_t raw = _wire_get_uvar (r);
+    return (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+}
+
+// Record count, rejected when the rest of the payload cannot hold that many
+static uint32_t
+_wire_get_count (gf_wire_reader_t *r, size_t min_bytes)
+{
+    uint64_t count = _wire_get_uvar (r);
+    if (r->failed || count > (r->size - r->pos) / min_bytes)
+    {
+        r->failed = true;
+        return 0;
+    }
+    return (uint32_t)count;
+}
+
+static void
+_wire_put_window (gf_wire_writer_t *w, const gf_win_info_t *win)
+{
+    const char *name = gf_win_name (win);
+    size_t name_len = strnlen (name, GF_WIN_NAME_MAX - 1);
+
+    uint8_t flags = (win->is_maximized ? GF_WIRE_WIN_MAXIMIZED : 0)
+                    | (win->is_minimized ? GF_WIRE_WIN_MINIMIZED : 0)
+                    | (win->needs_update ? GF_WIRE_WIN_NEEDS_UPDATE : 0)
+                    | (win->is_valid ? GF_WIRE_WIN_VALID : 0);
+
+    _wire_put_uvar (w, (uint64_t)(uintptr_t)win->id);
+    _wire_put_svar (w, win->workspace_id);
+    _wire_put_uvar (w, win->monitor_id);
+    _wire_put_svar (w, win->geometry.x);
+    _wire_put_svar (w, win->geometry.y);
+    _wire_put_uvar (w, win->geometry.width);
+    _wire_put_uvar (w, win->geometry.height);
+    _wire_put_byte (w, flags);
+    _wire_put_svar (w, (int64_t)win->last_modified);
+    _wire_put_uvar (w, name_len);
+    _wire_put_bytes (w, name, name_len);
+}
+
+static void
+_wire_put_workspace (gf_wire_writer_t *w, const gf_ws_info_t *ws)
+{
+    uint8_t flags = (ws->is_locked ? GF_WIRE_WS_LOCKED : 0)
+                    | (ws->has_maximized_state ? GF_WIRE_WS_MAXIMIZED_STATE : 0)
+                    | (ws->is_custom_layout ? GF_WIRE_WS_CUSTOM_LAYOUT : 0)
+                    | (ws->has_rule ? GF_WIRE_WS_HAS_RULE : 0);
+
+    _wire_put_svar (w, ws->id);
+    _wire_put_uvar (w, ws->window_count);
+    _wire_put_uvar (w, ws->max_windows);
+    _wire_put_svar (w, ws->available_space);
+    _wire_put_byte (w, flags);
+}
+
+// Monitors past the last one with an active workspace are left off
+static void
+_wire_put_active (gf_wire_writer_t *w, const gf_ws_list_t *workspaces)
+{
+    uint32_t monitors = GF_MAX_MONITORS;
+    while (monitors > 0 && workspaces->active_workspace[monitors - 1] == 0)
+        monitors--;
+
+    _wire_put_uvar (w, monitors);
+    for (uint32_t i = 0; i < monitors; i++)
+        _wire_put_uvar (w, workspaces->active_workspace[i]);
+}
+
+static void
+_wire_put_delta (gf_wire_writer_t *w, const gf_wire_delta_t *delta)
+{
+    _wire_put_byte (w, GF_WIRE_VERSION);
+    _wire_put_uvar (w, delta->generation);
+    _wire_put_byte (w, delta->reset ? GF_WIRE_DELTA_RESET : 0);
+    _wire_put_uvar (w, delta->removed_count);
+    for (uint32_t i = 0; i < delta->removed_count; i++)
+        _wire_put_uvar (w, delta->removed[i]);
+}
+
+size_t
+gf_wire_encode_windows (const gf_win_list_t *windows, void *out)
+{
+    gf_wire_writer_t w = { .data = out };
+
+    _wire_put_byte (&w, GF_WIRE_VERSION);
+    _wire_put_uvar (&w, windows->count);
+    for (uint32_t i = 0; i < windows->count; i++)
+        _wire_put_window (&w, &windows->items[i]);
+
+    return w.pos;
+}
+
+size_t
+gf_wire_encode_workspaces (const gf_ws_list_t *workspaces, void *out)
+{
+    gf_wire_writer_t w = { .data = out };
+
+    _wire_put_byte (&w, GF_WIRE_VERSION);
+    _wire_put_active (&w, workspaces);
+    _wire_put_uvar (&w, workspaces->count);
+    for (uint32_t i = 0; i < workspaces->count; i++)
+        _wire_put_workspace (&w, &workspaces->items[i]);
+
+    return w.pos;
+}
+
+size_t
+gf_wire_encode_windows_since (const gf_win_list_t *windows, uint64_t since,
+                              const gf_wire_delta_t *delta, void *out)
+{
+    gf_wire_writer_t w = { .data = out };
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < windows->count; i++)
+        if (delta->reset || windows->items[i].generation > since)
+            count++;
+
+    _wire_put_delta (&w, delta);
+    _wire_put_uvar (&w, count);
+    for (uint32_t i = 0; i < windows->count; i++)
+        if (delta->reset || windows->items[i].generation > since)
+            _wire_put_window (&w, &windows->items[i]);
+
+    return w.pos;
+}
+
+size_t
+gf_wire_encode_workspaces_since (const gf_ws_list_t *workspaces, uint64_t since,
+                                 const gf_wire_delta_t *delta, void *out)
+{
+    gf_wire_writer_t w = { .data = out };
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < workspaces->count; i++)
+        if (delta->reset || workspaces->items[i].generation > since)
+            count++;
+
+    _wire_put_delta (&w, delta);
+    _wire_put_active (&w, workspaces);
+    _wire_put_uvar (&w, count);
+    for (uint32_t i = 0; i < workspaces->count; i++)
+        if (delta->reset || workspaces->items[i].generation > since)
+            _wire_put_workspace (&w, &workspaces->items[i]);
+
+    return w.pos;
+}
+
+static void
+_wire_get_window (gf_wire_reader_t *r, gf_win_info_t *win)
+{
+    memset (win, 0, sizeof (*win));
+    win->id = (gf_handle_t)(uintptr_t)_wire_get_uvar (r);
+    win->workspace_id = (gf_ws_id_t)_wire_get_svar (r);
+    win->monitor_id = (gf_monitor_id_t)_wire_get_uvar (r);
+    win->geometry.x = (gf_coordinate_t)_wire_get_svar (r);
+    win->geometry.y = (gf_coordinate_t)_wire_get_svar (r);
+    win->geometry.width = (gf_dimension_t)_wire_get_uvar (r);
+    win->geometry.height = (gf_dimension_t)_wire_get_uvar (r);
+
+    uint8_t flags = _wire_get_byte (r);
+    win->is_maximized = (flags & GF_WIRE_WIN_MAXIMIZED) != 0;
+    win->is_minimized = (flags & GF_WIRE_WIN_MINIMIZED) != 0;
+    win->needs_update = (flags & GF_WIRE_WIN_NEEDS_UPDATE) != 0;
+    win->is_valid = (flags & GF_WIRE_WIN_VALID) != 0;
+    win->last_modified = (time_t)_wire_get_svar (r);
+
+    uint64_t name_len = _wire_get_uvar (r);
+    if (r->failed || name_len >= GF_WIN_NAME_MAX || name_len > r->size - r->pos)
+    {
+        r->failed = true;
+        return;
+    }
+
+    char name[GF_WIN_NAME_MAX];
+    memcpy (name, r->data + r->pos, name_len);
+    name[name_len] = '\0';
+    r->pos += name_len;
+    win->name_id = gf_intern (name);
+}
+
+static void
+_wire_get_workspace (gf_wire_reader_t *r, gf_ws_info_t *ws)
+{
+    memset (ws, 0, sizeof (*ws));
+    ws->id = (gf_ws_id_t)_wire_get_svar (r);
+    ws->window_count = (uint32_t)_wire_get_uvar (r);
+    ws->max_windows = (uint32_t)_wire_get_uvar (r);
+    ws->available_space = (int32_t)_wire_get_svar (r);
+
+    uint8_t flags = _wire_get_byte (r);
+    ws->is_locked = (flags & GF_WIRE_WS_LOCKED) != 0;
+    ws->has_maximized_state = (flags & GF_WIRE_WS_MAXIMIZED_STATE) != 0;
+    ws->is_custom_layout = (flags & GF_WIRE_WS_CUSTOM_LAYOUT) != 0;
+    ws->has_rule = (flags & GF_WIRE_WS_HAS_RULE) != 0;
+}
+
+static void
+_wire_get_active (gf_wire_reader_t *r, gf_ws_list_t *list)
+{
+    uint64_t monitors = _wire_get_uvar (r);
+    if (monitors > GF_MAX_MONITORS)
+    {
+        r->failed = true;
+        return;
+    }
+
+    for (uint32_t i = 0; i < monitors && !r->failed; i++)
+        list->active_workspace[i] = (uint32_t)_wire_get_uvar (r);
+}
+
+static void
+_wire_get_delta (gf_wire_reader_t *r, gf_wire_delta_t *delta)
+{
+    memset (delta, 0, sizeof (*delta));
+    if (_wire_get_byte (r) != GF_WIRE_VERSION)
+    {
+        r->failed = true;
+        return;
+    }
+
+    delta->generation = _wire_get_uvar (r);
+    delta->reset = (_wire_get_byte (r) & GF_WIRE_DELTA_RESET) != 0;
+
+    uint32_t count = _wire_get_count (r, 1);
+    if (r->failed || count == 0)
+        return;
+
+    delta->removed = gf_malloc (count * sizeof (uint64_t));
+    if (!delta->removed)
+    {
+        r->failed = true;
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+        delta->removed[i] = _wire_get_uvar (r);
+    delta->removed_count = count;
+}
+
+static gf_win_list_t *
+_wire_get_windows (gf_wire_reader_t *r)
+{
+    uint32_t count = _wire_get_count (r, GF_WIRE_WIN_MIN_BYTES);
+    if (r->failed)
+        return NULL;
+
+    gf_win_list_t *list = gf_calloc (1, sizeof (gf_win_list_t));
+    if (!list)
+        return NULL;
+
+    if (count > 0)
+    {
+        list->items = gf_malloc (count * sizeof (gf_win_info_t));
+        if (!list->items)
+        {
+            gf_free (list);
+            return NULL;
+        }
+    }
+
+    for (uint32_t i = 0; i < count && !r->failed; i++)
+        _wire_get_window (r, &list->items[i]);
+
+    if (r->failed)
+    {
+        gf_free (list->items);
+        gf_free (list);
+        return NULL;
+    }
+
+    list->count = count;
+    list->capacity = count;
+    return list;
+}
+
+// The active workspaces go into list, which the records are appended to
+static gf_ws_list_t *
+_wire_get_workspaces (gf_wire_reader_t *r, gf_ws_list_t *list)
+{
+    uint32_t count = _wire_get_count (r, GF_WIRE_WS_MIN_BYTES);
+    if (r->failed)
+        return NULL;
+
+    if (count > 0)
+    {
+        list->items = gf_malloc (count * sizeof (gf_ws_info_t));
+        if (!list->items)
+            return NULL;
+    }
+
+    for (uint32_t i = 0; i < count && !r->failed; i++)
+        _wire_get_workspace (r, &list->items[i]);
+
+    if (r->failed)
+    {
+        gf_free (list->items);
+        list->items = NULL;
+        return NULL;
+    }
+
+    list->count = count;
+    list->capacity = count;
+    return list;
+}
+
+gf_win_list_t *
+gf_wire_decode_windows (const void *data, size_t length)
+{
+    gf_wire_reader_t r = { .data = data, .size = length };
+
+    if (!data || _wire_get_byte (&r) != GF_WIRE_VERSION)
+        return NULL;
+
+    return _wire_get_windows (&r);
+}
+
+gf_ws_list_t *
+gf_wire_decode_workspaces (const void *data, size_t length)
+{
+    gf_wire_reader_t r = { .data = data, .size = length };
+
+    if (!data || _wire_get_byte (&r) != GF_WIRE_VERSION)
+        return NULL;
+
+    gf_ws_list_t *list = gf_calloc (1, sizeof (gf_ws_list_t));
+    if (!list)
+        return NULL;
+
+    _wire_get_active (&r, list);
+    if (r.failed || !_wire_get_workspaces (&r, list))
+    {
+        gf_free (list);
+        return NULL;
+    }
+    return list;
+}
+
+gf_win_list_t *
+gf_wire_decode_windows_since (const void *data, size_t length, gf_wire_delta_t *delta)
+{
+    gf_wire_reader_t r = { .data = data, .size = length };
+
+    if (!data)
+        return NULL;
+
+    _wire_get_delta (&r, delta);
+    gf_win_list_t *list = r.failed ? NULL : _wire_get_windows (&r);
+    if (!list)
+        gf_wire_delta_release (delta);
+    return list;
+}
+
+gf_ws_list_t *
+gf_wire_decode_workspaces_since (const void *data, size_t length, gf_wire_delta_t *delta)
+{
+    gf_wire_reader_t r = { .data = data, .size = length };
+
+    if (!data)
+        return NULL;
+
+    _wire_get_delta (&r, delta);
+    gf_ws_list_t *list = r.failed ? NULL : gf_calloc (1, sizeof (gf_ws_list_t));
+    if (list)
+        _wire_get_active (&r, list);
+
+    if (!list || r.failed || !_wire_get_workspaces (&r, list))
+    {
+        gf_free (list);
+        gf_wire_delta_release (delta);
+        return NULL;
+    }
+    return list;
+}
+
+void
+gf_wire_delta_release (gf_wire_delta_t *delta)
+{
+    gf_free (delta->removed);
+    delta->removed = NULL;
+    delta->removed_count = 0;
+}
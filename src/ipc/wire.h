@@ -0,0 +1,78 @@
+#ifndef GF_IPC_WIRE_H
+#define GF_IPC_WIRE_H
+
+#include "../utils/list.h"
+#include <stddef.h>
+
+/*
+ * Compact encoding of the window and workspace query replies. A payload is a
+ * version byte, a varint record count and the records back to back:
+ *
+ *   window:    id, workspace, monitor, x, y, width, height, flags,
+ *              last_modified, name length, name bytes
+ *   workspace: id, window count, max windows, available space, flags
+ *
+ * The workspace set opens, ahead of its count, with the number of monitors
+ * that have an active workspace followed by their ids. Integers are LEB128
+ * varints (signed ones zigzagged), flags a single byte and names unpadded,
+ * so a window costs a few dozen bytes rather than a fixed struct with a
+ * 256-byte name buffer.
+ *
+ * A delta ("query ... since <gen>") opens with the version byte, the state
+ * generation it brings the client to, a flags byte and the keys of records
+ * removed since the client's generation; then come the monitors' active
+ * workspaces (workspace deltas only) and the added or changed records in the
+ * layout above. Keys are window handles, or workspace ids as uint32_t.
+ * Clients drop removed keys before upserting records, as a key can be
+ * removed and reused between two polls. With GF_WIRE_DELTA_RESET set the
+ * records are a full snapshot that replaces whatever the client holds.
+ */
+#define GF_WIRE_VERSION 1
+
+#define GF_WIRE_WIN_MAXIMIZED (1u << 0)
+#define GF_WIRE_WIN_MINIMIZED (1u << 1)
+#define GF_WIRE_WIN_NEEDS_UPDATE (1u << 2)
+#define GF_WIRE_WIN_VALID (1u << 3)
+
+#define GF_WIRE_WS_LOCKED (1u << 0)
+#define GF_WIRE_WS_MAXIMIZED_STATE (1u << 1)
+#define GF_WIRE_WS_CUSTOM_LAYOUT (1u << 2)
+#define GF_WIRE_WS_HAS_RULE (1u << 3)
+
+#define GF_WIRE_DELTA_RESET (1u << 0)
+
+typedef struct
+{
+    uint64_t generation; // state the reply brings the client up to
+    bool reset;          // records replace everything the client holds
+    uint64_t *removed;   // keys gone since the client's generation
+    uint32_t removed_count;
+} gf_wire_delta_t;
+
+// Encode into out, or only measure when out is NULL. Returns the byte count
+// either way, so a caller sizes the buffer with one pass and fills it with
+// the next.
+size_t gf_wire_encode_windows (const gf_win_list_t *windows, void *out);
+size_t gf_wire_encode_workspaces (const gf_ws_list_t *workspaces, void *out);
+
+// Delta replies: records whose generation is past `since` (all of them on a
+// reset) plus the header in delta.
+size_t gf_wire_encode_windows_since (const gf_win_list_t *windows, uint64_t since,
+                                     const gf_wire_delta_t *delta, void *out);
+size_t gf_wire_encode_workspaces_since (const gf_ws_list_t *workspaces, uint64_t since,
+                                        const gf_wire_delta_t *delta, void *out);
+
+// A freshly allocated list, or NULL when data is not a complete record set of
+// this version. Names are interned in the calling process; the daemon sends
+// window classes, so the pool stays bounded by the applications seen.
+gf_win_list_t *gf_wire_decode_windows (const void *data, size_t length);
+gf_ws_list_t *gf_wire_decode_workspaces (const void *data, size_t length);
+// The list holds the added and changed records; delta->removed is allocated
+// and freed with gf_wire_delta_release.
+gf_win_list_t *gf_wire_decode_windows_since (const void *data, size_t length,
+                                             gf_wire_delta_t *delta);
+gf_ws_list_t *gf_wire_decode_workspaces_since (const void *data, size_t length,
+                                               gf_wire_delta_t *delta);
+void gf_wire_delta_release (gf_wire_delta_t *delta);
+
+#endif // GF_IPC_WIRE_H
@@ -11,6 +11,30 @@
 
 typedef struct gf_platform gf_platform_t;
 
+// Every client from one enumeration pass, grouped by desktop. Windows on
+// desktop d (0-based) are items[offsets[d] .. offsets[d + 1]); sticky windows,
+// and any claiming a desktop that does not exist, follow as
+// items[offsets[desktop_count] .. count). Both arrays are scratch
+// memory (see gf_scratch_alloc) and live until the end of the tick.
+typedef struct
+{
+    gf_win_info_t *items;
+    uint32_t count;
+    uint32_t *offsets;
+    uint32_t desktop_count;
+} gf_win_buckets_t;
+
+// Window state reported by window_get_state, all of it read in one go.
+typedef enum
+{
+    GF_WIN_STATE_VALID = (1 << 0),
+    GF_WIN_STATE_MAXIMIZED = (1 << 1),
+    GF_WIN_STATE_MINIMIZED = (1 << 2),
+    GF_WIN_STATE_FULLSCREEN = (1 << 3),
+    GF_WIN_STATE_HIDDEN = (1 << 4),
+    GF_WIN_STATE_EXCLUDED = (1 << 5),
+} gf_win_state_t;
+
 typedef enum
 {
     GF_KEY_NONE = 0,
@@ -25,8 +49,16 @@ struct gf_platform
     void (*cleanup) (gf_display_t display, gf_platform_t *platform);
 
     // --- Window Enumeration & Info ---
+    // Enumeration results are scratch memory: valid until the end of the
+    // tick, never passed to gf_free.
     gf_err_t (*window_enumerate) (gf_display_t display, gf_ws_id_t *workspace_id,
                                   gf_win_info_t **windows, uint32_t *count);
+    // Optional. Single-pass enumeration of all clients grouped by desktop.
+    gf_err_t (*window_enumerate_all) (gf_display_t display, gf_win_buckets_t *buckets);
+    // Optional. Windows that appeared or changed since the previous call, as
+    // recorded from display events. Without it the core rescans every tick.
+    gf_err_t (*window_changes) (gf_platform_t *platform, gf_win_info_t **windows,
+                                uint32_t *count);
     gf_handle_t (*window_get_focused) (gf_display_t display);
     void (*window_get_class) (gf_display_t display, gf_handle_t win, char *buffer,
                               size_t bufsize);
@@ -34,6 +66,10 @@ struct gf_platform
     // --- Window Geometry & State ---
     gf_err_t (*window_get_geometry) (gf_display_t display, gf_handle_t window,
                                      gf_rect_t *geometry);
+    // Optional. gf_win_state_t bits for the window in one query; the
+    // window_is_* predicates below remain for single checks.
+    gf_err_t (*window_get_state) (gf_display_t display, gf_handle_t window,
+                                  uint32_t *state);
     bool (*window_is_excluded) (gf_display_t display, gf_handle_t window);
     bool (*window_is_fullscreen) (gf_display_t display, gf_handle_t window);
     bool (*window_is_hidden) (gf_display_t display, gf_handle_t window);
@@ -80,6 +116,13 @@ struct gf_platform
     void (*resize_hook_uninstall) (gf_platform_t *platform);
     bool (*resize_poll) (gf_platform_t *platform, gf_resize_event_t *event);
 
+    // --- Event Loop ---
+    // Optional. event_fd exposes a pollable descriptor that becomes readable when
+    // the display has input; event_dispatch drains queued events and reports
+    // whether any of them warrant a tick.
+    int (*event_fd) (gf_platform_t *platform);
+    bool (*event_dispatch) (gf_platform_t *platform);
+
     void *platform_data;
 };
 
@@ -1,3 +1,5 @@
+#define GF_MEM_TAG GF_MEM_TAG_BORDER
+
 #include "../../utils/logger.h"
 #include "../../utils/memory.h"
 #include "internal.h"
@@ -205,7 +207,7 @@ get_toplevel_parent (Display *dpy, Window w)
 
     while (current != None)
     {
-        if (!XQueryTree (dpy, current, &root, &parent, &children, &nchildren))
+        if (!gf_x_query_tree (dpy, current, &root, &parent, &children, &nchildren))
             return w;
 
         if (children)
@@ -283,7 +285,7 @@ apply_shape_mask (Display *dpy, Window overlay, int w, int h, int thickness, int
 
     XWindowAttributes attrs;
     bool is_viewable = false;
-    if (XGetWindowAttributes (dpy, overlay, &attrs))
+    if (gf_x_get_window_attributes (dpy, overlay, &attrs))
         is_viewable = (attrs.map_state == IsViewable);
 
     // Apply the final bounding shape mask
@@ -293,9 +295,9 @@ apply_shape_mask (Display *dpy, Window overlay, int w, int h, int thickness, int
     {
         // Force Mutter compositor to refresh the shape of the override_redirect window
         XUnmapWindow (dpy, overlay);
-        XSync (dpy, False);
+        gf_x_sync (dpy, False);
         XMapWindow (dpy, overlay);
-        XSync (dpy, False);
+        gf_x_sync (dpy, False);
     }
 
     // Make the entire overlay click-through (empty input region).
@@ -304,7 +306,7 @@ apply_shape_mask (Display *dpy, Window overlay, int w, int h, int thickness, int
                              Unsorted);
 
     XDestroyRegion (final_reg);
-    XSync (dpy, False);
+    gf_x_sync (dpy, False);
 }
 
 void
@@ -351,7 +353,7 @@ create_border_overlay (Display *dpy, Window target, gf_color_t color, int thickn
 
     Window root = DefaultRootWindow (dpy);
     XWindowAttributes root_attrs;
-    if (!XGetWindowAttributes (dpy, root, &root_attrs))
+    if (!gf_x_get_window_attributes (dpy, root, &root_attrs))
         return None;
 
     XSetWindowAttributes swa;
@@ -378,6 +380,24 @@ create_border_overlay (Display *dpy, Window target, gf_color_t color, int thickn
     return overlay;
 }
 
+// Make room for one more border.
+static bool
+reserve_border_slot (gf_linux_platform_data_t *data)
+{
+    if (data->border_count < data->border_capacity)
+        return true;
+
+    int capacity = data->border_capacity ? data->border_capacity * 2 : 32;
+    gf_border_t **borders
+        = gf_realloc (data->borders, (size_t)capacity * sizeof (gf_border_t *));
+    if (!borders)
+        return false;
+
+    data->borders = borders;
+    data->border_capacity = capacity;
+    return true;
+}
+
 static gf_border_t *
 find_border_by_window (gf_linux_platform_data_t *data, Window window)
 {
@@ -402,28 +422,9 @@ update_border_color (Display *dpy, gf_border_t *border, gf_color_t color)
 static void
 fetch_border_rect (Display *dpy, Window window, gf_border_t *border)
 {
-    XWindowAttributes attrs;
-    if (!XGetWindowAttributes (dpy, window, &attrs))
-        return;
-
-    Window root = DefaultRootWindow (dpy), child;
-    int abs_x, abs_y;
-    XTranslateCoordinates (dpy, window, root, 0, 0, &abs_x, &abs_y, &child);
-
-    int le = 0, re = 0, te = 0, be = 0;
-    bool is_csd = false;
-    gf_platform_get_frame_extents (dpy, window, &le, &re, &te, &be, &is_csd);
-
-    if (is_csd)
-    {
-        border->last_rect = (gf_rect_t){ abs_x + le, abs_y + te, attrs.width - le - re,
-                                         attrs.height - te - be };
-    }
-    else
-    {
-        border->last_rect = (gf_rect_t){ abs_x - le, abs_y - te, attrs.width + le + re,
-                                         attrs.height + te + be };
-    }
+    gf_rect_t frame;
+    if (get_frame_geometry (dpy, window, &frame))
+        border->last_rect = frame;
 }
 
 static gf_border_t *
@@ -448,15 +449,9 @@ gf_border_add (gf_platform_t *platform, gf_handle_t window, gf_color_t color,
         return;
 
     gf_linux_platform_data_t *data = (gf_linux_platform_data_t *)platform->platform_data;
-    if (!data || !data->display || !data->borders)
+    if (!data || !data->display)
         return;
 
-    if (data->border_count >= GF_MAX_WINDOWS_PER_WORKSPACE * GF_MAX_WORKSPACES)
-    {
-        GF_LOG_WARN ("Border limit reached");
-        return;
-    }
-
     if (gf_window_is_excluded (data->display, (Window)window))
         return;
 
@@ -469,6 +464,12 @@ gf_border_add (gf_platform_t *platform, gf_handle_t window, gf_color_t color,
         return;
     }
 
+    if (!reserve_border_slot (data))
+    {
+        GF_LOG_WARN ("Failed to grow border array");
+        return;
+    }
+
     Window overlay = create_border_overlay (data->display, window, color, thickness);
     if (!overlay)
     {
@@ -487,7 +488,7 @@ gf_border_add (gf_platform_t *platform, gf_handle_t window, gf_color_t color,
     fetch_border_rect (data->display, (Window)window, border);
     data->borders[data->border_count++] = border;
 
-    XFlush (data->display);
+    gf_x_flush (data->display);
     GF_LOG_INFO ("Border added for window %lu (overlay %lu)", (unsigned long)window,
                  (unsigned long)overlay);
 }
@@ -657,28 +658,35 @@ update_single_border (Display *dpy, gf_linux_platform_data_t *data,
     if (!b || window_is_border_excluded (dpy, b->target))
         return;
 
-    XWindowAttributes attrs;
-    if (!XGetWindowAttributes (dpy, b->target, &attrs))
+    // Map state, geometry, state bits and frame extents all come from the
+    // property cache, so a steady-state update issues no queries.
+    const gf_window_props_t *props
+        = gf_prop_cache_get (dpy, b->target,
+                             GF_PROPS_ATTRS | GF_PROPS_GEOMETRY | GF_PROPS_STATE
+                                 | GF_PROPS_FRAME);
+    if (!props)
     {
         _border_remove_dead (dpy, data, i);
         return;
     }
 
-    if (attrs.map_state == IsUnmapped || gf_window_is_minimized (dpy, b->target)
-        || gf_window_is_maximized (dpy, b->target))
+    if (!props->mapped || gf_window_props_has_state (props, GF_NET_STATE_HIDDEN)
+        || gf_window_props_has_state (props, GF_NET_STATE_MAXIMIZED))
     {
         XUnmapWindow (dpy, b->overlay);
         return;
     }
 
+    gf_rect_t frame;
+    bool has_frame = frame_geometry_from_props (props, &frame);
+
     XMapWindow (dpy, b->overlay);
     border_stack_above_target (dpy, b);
 
     if (b->color != config->border_color)
         update_border_color (dpy, b, config->border_color);
 
-    gf_rect_t frame;
-    if (!get_frame_geometry (dpy, b->target, &frame))
+    if (!has_frame)
         return;
 
     int thick = b->thickness;
@@ -705,6 +713,10 @@ update_single_border (Display *dpy, gf_linux_platform_data_t *data,
 static unsigned long
 _read_net_wm_pid (Display *dpy, gf_platform_atoms_t *atoms, Window win)
 {
+    const gf_window_props_t *cached = gf_prop_cache_peek (win, GF_PROPS_PID);
+    if (cached)
+        return cached->has_pid ? cached->pid : 0;
+
     unsigned char *data = NULL;
     unsigned long nitems = 0, pid = 0;
     if (gf_platform_get_window_property (dpy, win, atoms->net_wm_pid, XA_CARDINAL, &data,
@@ -724,13 +736,13 @@ static bool
 _override_geometry (Display *dpy, Window win, gf_rect_t *out)
 {
     XWindowAttributes wa;
-    if (!XGetWindowAttributes (dpy, win, &wa) || wa.map_state != IsViewable
+    if (!gf_x_get_window_attributes (dpy, win, &wa) || wa.map_state != IsViewable
         || !wa.override_redirect)
         return false;
 
     int rx = 0, ry = 0;
     Window child;
-    XTranslateCoordinates (dpy, win, wa.root, 0, 0, &rx, &ry, &child);
+    gf_x_translate_coordinates (dpy, win, wa.root, 0, 0, &rx, &ry, &child);
     out->x = rx;
     out->y = ry;
     out->width = (gf_dimension_t)wa.width;
@@ -750,7 +762,8 @@ _collect_gui_popups (Display *dpy, gf_platform_atoms_t *atoms, unsigned long gui
 
     Window qroot, qparent, *children = NULL;
     unsigned int nchildren = 0;
-    if (!XQueryTree (dpy, root, &qroot, &qparent, &children, &nchildren) || !children)
+    if (!gf_x_query_tree (dpy, root, &qroot, &qparent, &children, &nchildren)
+        || !children)
         return;
     (void)qroot;
     (void)qparent;
@@ -791,8 +804,8 @@ _collect_gui_geoms (Display *dpy, gf_platform_atoms_t *atoms, const gf_config_t
                 gui_pid = _read_net_wm_pid (dpy, atoms, clients[i]);
 
             if (window_is_border_excluded (dpy, clients[i])
-                && !window_has_type (dpy, clients[i], atoms->net_wm_window_type_desktop)
-                && !window_has_type (dpy, clients[i], atoms->net_wm_window_type_dock))
+                && !window_has_type (dpy, clients[i], GF_NET_TYPE_DESKTOP)
+                && !window_has_type (dpy, clients[i], GF_NET_TYPE_DOCK))
             {
                 if (get_frame_geometry (dpy, clients[i], &gui_geoms[gui_count]))
                     gui_count++;
@@ -836,5 +849,5 @@ gf_border_update (gf_platform_t *platform, const gf_config_t *config)
         i++;
     }
 
-    XFlush (dpy);
+    gf_x_flush (dpy);
 }
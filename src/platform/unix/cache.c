@@ -0,0 +1,331 @@
+#define GF_MEM_TAG GF_MEM_TAG_PLATFORM
+
+#include "../../utils/memory.h"
+#include "internal.h"
+#include "platform.h"
+#include <string.h>
+
+/*
+ * Per-window property cache. Class, state, type, desktop, frame extents and
+ * pid only change when the client rewrites the property, and every cached
+ * window has GF_CLIENT_EVENT_MASK selected, so an entry stays valid until the
+ * matching PropertyNotify clears its group (or DestroyNotify drops it).
+ *
+ * Map state and root-relative geometry follow the structure events: the
+ * synthetic ConfigureNotify a reparenting WM sends after moving the frame
+ * carries root coordinates and is stored as-is, while a real one (parent-
+ * relative under a frame) only clears the geometry group for a refetch.
+ *
+ * Pointers returned by the lookups stay valid until the next cache call.
+ */
+
+static gf_prop_cache_entry_t *
+_cache_find (gf_linux_platform_data_t *data, Window w)
+{
+    int slot = gf_window_map_find (&data->prop_cache_map, data->prop_cache,
+                                   sizeof (gf_prop_cache_entry_t),
+                                   data->prop_cache_count, w);
+    return slot >= 0 ? &data->prop_cache[slot] : NULL;
+}
+
+static gf_prop_cache_entry_t *
+_cache_insert (gf_linux_platform_data_t *data, Window w)
+{
+    if (data->prop_cache_count >= data->prop_cache_capacity)
+    {
+        uint32_t new_capacity
+            = data->prop_cache_capacity ? data->prop_cache_capacity * 2 : 32;
+        gf_prop_cache_entry_t *grown = gf_realloc (
+            data->prop_cache, new_capacity * sizeof (gf_prop_cache_entry_t));
+        if (!grown)
+            return NULL;
+        data->prop_cache = grown;
+        data->prop_cache_capacity = new_capacity;
+    }
+
+    gf_prop_cache_entry_t *entry = &data->prop_cache[data->prop_cache_count];
+    memset (entry, 0, sizeof (*entry));
+    entry->window = w;
+    if (!gf_window_map_add (&data->prop_cache_map, data->prop_cache,
+                            sizeof (gf_prop_cache_entry_t), data->prop_cache_count))
+        return NULL;
+    data->prop_cache_count++;
+    return entry;
+}
+
+// Copy the fields belonging to the groups in mask from src to dst.
+static void
+_props_merge (gf_window_props_t *dst, const gf_window_props_t *src, uint32_t mask)
+{
+    if (mask & GF_PROPS_ATTRS)
+    {
+        dst->valid = src->valid;
+        dst->mapped = src->mapped;
+    }
+    if (mask & GF_PROPS_GEOMETRY)
+    {
+        dst->has_geometry = src->has_geometry;
+        dst->geometry = src->geometry;
+    }
+    if (mask & GF_PROPS_DESKTOP)
+    {
+        dst->has_desktop = src->has_desktop;
+        dst->desktop = src->desktop;
+    }
+    if (mask & GF_PROPS_PID)
+    {
+        dst->has_pid = src->has_pid;
+        dst->pid = src->pid;
+    }
+    if (mask & GF_PROPS_CLASS)
+    {
+        dst->has_class = src->has_class;
+        memcpy (dst->res_name, src->res_name, sizeof (dst->res_name));
+        memcpy (dst->res_class, src->res_class, sizeof (dst->res_class));
+    }
+    if (mask & GF_PROPS_STATE)
+        dst->states = src->states;
+    if (mask & GF_PROPS_TYPE)
+        dst->types = src->types;
+    if (mask & GF_PROPS_FRAME)
+    {
+        dst->has_frame_extents = src->has_frame_extents;
+        dst->frame_is_csd = src->frame_is_csd;
+        memcpy (dst->frame_extents, src->frame_extents, sizeof (dst->frame_extents));
+    }
+}
+
+// The root window keeps its own event mask and is never cached.
+static bool
+_cache_usable (gf_linux_platform_data_t *data, Window w)
+{
+    return data && w != None && w != data->root_window;
+}
+
+const gf_window_props_t *
+gf_prop_cache_get (Display *dpy, Window window, uint32_t need)
+{
+    static gf_window_props_t uncached;
+    gf_linux_platform_data_t *data = gf_platform_data_get_global ();
+
+    need &= GF_PROPS_CACHED;
+
+    if (!dpy)
+        return NULL;
+
+    if (!_cache_usable (data, window))
+    {
+        gf_window_props_query (dpy, &window, 1, need | GF_PROPS_ATTRS, &uncached);
+        return uncached.valid ? &uncached : NULL;
+    }
+
+    gf_prop_cache_entry_t *entry = _cache_find (data, window);
+    if (entry && (entry->cached & need) == need)
+        return &entry->props;
+
+    gf_window_props_t fresh;
+    if (!entry)
+    {
+        // Select before reading so a change racing the fetch still invalidates
+        XSelectInput (dpy, window, GF_CLIENT_EVENT_MASK);
+        gf_window_props_query (dpy, &window, 1, need | GF_PROPS_ATTRS, &fresh);
+        if (!fresh.valid)
+            return NULL;
+
+        entry = _cache_insert (data, window);
+        if (!entry)
+        {
+            uncached = fresh;
+            return &uncached;
+        }
+        need |= GF_PROPS_ATTRS;
+    }
+    else
+    {
+        gf_window_props_query (dpy, &window, 1, need & ~entry->cached, &fresh);
+    }
+
+    _props_merge (&entry->props, &fresh, need & ~entry->cached);
+    entry->cached |= need;
+    return &entry->props;
+}
+
+const gf_window_props_t *
+gf_prop_cache_peek (Window window, uint32_t need)
+{
+    gf_linux_platform_data_t *data = gf_platform_data_get_global ();
+    if (!_cache_usable (data, window))
+        return NULL;
+
+    gf_prop_cache_entry_t *entry = _cache_find (data, window);
+    if (!entry || (entry->cached & need) != need)
+        return NULL;
+
+    return &entry->props;
+}
+
+/*
+ * Snapshot a batch of windows. Whatever groups any of them lacks are fetched
+ * for the whole batch in a single pipelined query; fully cached batches cost
+ * no round-trip at all. Windows that turn out to be gone are dropped from the
+ * cache.
+ */
+void
+gf_window_props_fetch (Display *dpy, const Window *windows, uint32_t count,
+                       gf_window_props_t *out)
+{
+    gf_linux_platform_data_t *data = gf_platform_data_get_global ();
+    uint32_t missing = 0;
+
+    if (count == 0)
+        return;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!_cache_usable (data, windows[i]))
+        {
+            missing = GF_PROPS_CACHED;
+            continue;
+        }
+
+        gf_prop_cache_entry_t *entry = _cache_find (data, windows[i]);
+        if (entry)
+            missing |= GF_PROPS_CACHED & ~entry->cached;
+        else
+        {
+            XSelectInput (dpy, windows[i], GF_CLIENT_EVENT_MASK);
+            missing = GF_PROPS_CACHED;
+        }
+    }
+
+    // Reading the geometry also proves the window still exists
+    if (missing & GF_PROPS_GEOMETRY)
+        missing |= GF_PROPS_ATTRS;
+
+    gf_window_props_query (dpy, windows, count, missing, out);
+
+    if (!data)
+        return;
+
+    bool probed = (missing & GF_PROPS_ATTRS) != 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!_cache_usable (data, windows[i]))
+            continue;
+
+        if (probed && !out[i].valid)
+        {
+            gf_prop_cache_forget (data, windows[i]);
+            continue;
+        }
+
+        gf_prop_cache_entry_t *entry = _cache_find (data, windows[i]);
+        if (!entry)
+        {
+            entry = _cache_insert (data, windows[i]);
+            if (!entry)
+                continue;
+        }
+
+        // Refill what the entry lacked, answer the rest from the entry
+        _props_merge (&entry->props, &out[i], missing & ~entry->cached);
+        entry->cached |= missing;
+        _props_merge (&out[i], &entry->props, GF_PROPS_CACHED);
+    }
+}
+
+static void
+_cache_invalidate_property (gf_linux_platform_data_t *data, gf_prop_cache_entry_t *entry,
+                            Atom property)
+{
+    const gf_platform_atoms_t *atoms = &data->atoms;
+    uint32_t group = 0;
+
+    if (property == atoms->net_wm_desktop)
+        group = GF_PROPS_DESKTOP;
+    else if (property == atoms->wm_class)
+        group = GF_PROPS_CLASS;
+    else if (property == atoms->net_wm_state)
+        group = GF_PROPS_STATE;
+    else if (property == atoms->net_wm_window_type)
+        group = GF_PROPS_TYPE;
+    else if (property == atoms->net_frame_extents || property == atoms->gtk_frame_extents
+             || property == atoms->qt_frame_extents)
+        group = GF_PROPS_FRAME;
+    else if (property == atoms->net_wm_pid)
+        group = GF_PROPS_PID;
+
+    entry->cached &= ~group;
+}
+
+static void
+_cache_configure (gf_prop_cache_entry_t *entry, const XConfigureEvent *ev)
+{
+    if (!ev->send_event)
+    {
+        entry->cached &= ~GF_PROPS_GEOMETRY;
+        return;
+    }
+
+    entry->props.has_geometry = true;
+    entry->props.geometry = (gf_rect_t){ ev->x, ev->y, ev->width, ev->height };
+    entry->cached |= GF_PROPS_GEOMETRY;
+}
+
+void
+gf_prop_cache_handle_event (gf_linux_platform_data_t *data, const XEvent *ev)
+{
+    if (ev->type == DestroyNotify)
+    {
+        gf_prop_cache_forget (data, ev->xdestroywindow.window);
+        return;
+    }
+
+    gf_prop_cache_entry_t *entry = _cache_find (data, ev->xany.window);
+    if (!entry)
+        return;
+
+    switch (ev->type)
+    {
+    case PropertyNotify:
+        _cache_invalidate_property (data, entry, ev->xproperty.atom);
+        break;
+    case ConfigureNotify:
+        _cache_configure (entry, &ev->xconfigure);
+        break;
+    case MapNotify:
+        entry->props.mapped = true;
+        break;
+    case UnmapNotify:
+        entry->props.mapped = false;
+        break;
+    case ReparentNotify:
+        entry->cached &= ~GF_PROPS_GEOMETRY;
+        break;
+    default:
+        break;
+    }
+}
+
+void
+gf_prop_cache_forget (gf_linux_platform_data_t *data, Window window)
+{
+    gf_prop_cache_entry_t *entry = _cache_find (data, window);
+    if (!entry)
+        return;
+
+    gf_window_map_remove (&data->prop_cache_map, data->prop_cache,
+                          sizeof (gf_prop_cache_entry_t), data->prop_cache_count,
+                          (uint32_t)(entry - data->prop_cache));
+    *entry = data->prop_cache[--data->prop_cache_count];
+}
+
+void
+gf_prop_cache_cleanup (gf_linux_platform_data_t *data)
+{
+    gf_free (data->prop_cache);
+    gf_window_map_free (&data->prop_cache_map);
+    data->prop_cache = NULL;
+    data->prop_cache_count = data->prop_cache_capacity = 0;
+}
@@ -65,9 +65,9 @@ _dock_hide_from_client_list (Display *dpy, Window root, gf_platform_atoms_t *ato
     int actual_format;
     unsigned long bytes_after;
 
-    if (XGetWindowProperty (dpy, root, atoms->net_client_list, 0, 4096, False, XA_WINDOW,
-                            &actual_type, &actual_format, &clients_count, &bytes_after,
-                            &clients_data)
+    if (gf_x_get_window_property (dpy, root, atoms->net_client_list, 0, 4096, False,
+                                  XA_WINDOW, &actual_type, &actual_format, &clients_count,
+                                  &bytes_after, &clients_data)
             != Success
         || !clients_data)
         return;
@@ -76,7 +76,7 @@ _dock_hide_from_client_list (Display *dpy, Window root, gf_platform_atoms_t *ato
     for (unsigned long i = 0;
          i < clients_count && data->saved_dock_count < GF_MAX_DOCK_WINDOWS; i++)
     {
-        if (window_has_type (dpy, clients[i], atoms->net_wm_window_type_dock))
+        if (window_has_type (dpy, clients[i], GF_NET_TYPE_DOCK))
             _dock_save_and_hide (dpy, clients[i], data, "");
     }
 
@@ -92,7 +92,7 @@ _dock_hide_from_root_children (Display *dpy, Window root, gf_platform_atoms_t *a
     Window *children = NULL;
     unsigned int nchildren = 0;
 
-    if (!XQueryTree (dpy, root, &root_ret, &parent_ret, &children, &nchildren))
+    if (!gf_x_query_tree (dpy, root, &root_ret, &parent_ret, &children, &nchildren))
         return;
 
     for (unsigned int i = 0;
@@ -101,7 +101,7 @@ _dock_hide_from_root_children (Display *dpy, Window root, gf_platform_atoms_t *a
         if (_dock_already_saved (data, children[i]))
             continue;
 
-        if (window_has_type (dpy, children[i], atoms->net_wm_window_type_dock))
+        if (window_has_type (dpy, children[i], GF_NET_TYPE_DOCK))
             _dock_save_and_hide (dpy, children[i], data, " (root child)");
     }
 
@@ -134,7 +134,7 @@ gf_dock_hide (gf_platform_t *platform)
     _dock_hide_from_root_children (dpy, root, atoms, data);
 
     data->dock_hidden = true;
-    XFlush (dpy);
+    gf_x_flush (dpy);
     GF_LOG_INFO ("Dock auto-hidden (%d dock windows)", data->saved_dock_count);
 }
 
@@ -186,6 +186,6 @@ gf_dock_restore (gf_platform_t *platform)
 
     data->dock_hidden = false;
     data->saved_dock_count = 0;
-    XFlush (dpy);
+    gf_x_flush (dpy);
     GF_LOG_INFO ("Dock restored");
 }
@@ -0,0 +1,309 @@
+#define GF_MEM_TAG GF_MEM_TAG_PLATFORM
+
+#include "../../utils/logger.h"
+#include "../../utils/memory.h"
+#include "internal.h"
+#include "platform.h"
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <string.h>
+
+// Root properties whose change means the window or workspace picture moved.
+static bool
+_event_root_property_relevant (const gf_platform_atoms_t *atoms, Atom atom)
+{
+    return atom == atoms->net_client_list || atom == atoms->net_active_window
+           || atom == atoms->net_current_desktop
+           || atom == atoms->net_number_of_desktops || atom == atoms->net_workarea;
+}
+
+// Client properties that feed gf_win_info_t or the exclusion checks.
+static bool
+_event_client_property_relevant (const gf_platform_atoms_t *atoms, Atom atom)
+{
+    return atom == atoms->net_wm_state || atom == atoms->net_wm_desktop
+           || atom == atoms->net_wm_window_type || atom == atoms->wm_class
+           || atom == atoms->net_frame_extents || atom == atoms->gtk_frame_extents;
+}
+
+static int
+_tracker_index (const gf_window_set_t *set, Window w)
+{
+    return gf_window_map_find (&set->map, set->items, sizeof (Window), set->count, w);
+}
+
+// Append w to a window set unless it is already there.
+static bool
+_tracker_set_add (gf_window_set_t *set, Window w)
+{
+    if (_tracker_index (set, w) >= 0)
+        return true;
+
+    if (set->count >= set->capacity)
+    {
+        uint32_t new_capacity = set->capacity ? set->capacity * 2 : 32;
+        Window *grown = gf_realloc (set->items, new_capacity * sizeof (Window));
+        if (!grown)
+            return false;
+        set->items = grown;
+        set->capacity = new_capacity;
+    }
+
+    set->items[set->count] = w;
+    if (!gf_window_map_add (&set->map, set->items, sizeof (Window), set->count))
+        return false;
+    set->count++;
+    return true;
+}
+
+static void
+_tracker_set_remove_at (gf_window_set_t *set, uint32_t idx)
+{
+    gf_window_map_remove (&set->map, set->items, sizeof (Window), set->count, idx);
+    set->items[idx] = set->items[--set->count];
+}
+
+static void
+_tracker_set_remove (gf_window_set_t *set, Window w)
+{
+    int idx = _tracker_index (set, w);
+    if (idx >= 0)
+        _tracker_set_remove_at (set, (uint32_t)idx);
+}
+
+static void
+_tracker_set_free (gf_window_set_t *set)
+{
+    gf_free (set->items);
+    gf_window_map_free (&set->map);
+    memset (set, 0, sizeof (*set));
+}
+
+static void
+_tracker_mark_dirty (gf_linux_platform_data_t *data, Window w)
+{
+    if (!_tracker_set_add (&data->dirty_clients, w))
+    {
+        // Out of memory: fall back to re-reading the whole client list
+        data->client_list_dirty = true;
+    }
+}
+
+/*
+ * Reconcile the tracked set with _NET_CLIENT_LIST. New clients get our event
+ * mask and are reported once as changed; vanished clients are forgotten (the
+ * core prunes them from its own list).
+ */
+static void
+_tracker_sync_clients (gf_linux_platform_data_t *data)
+{
+    Display *dpy = data->display;
+    gf_window_set_t *tracked = &data->tracked_clients;
+    unsigned char *prop = NULL;
+    unsigned long nitems = 0;
+
+    data->client_list_dirty = false;
+
+    if (gf_platform_get_window_property (dpy, data->root_window,
+                                         data->atoms.net_client_list, XA_WINDOW, &prop,
+                                         &nitems)
+        != GF_SUCCESS)
+    {
+        nitems = 0;
+    }
+
+    Window *clients = (Window *)prop;
+
+    // Flag the tracked clients that are still listed; the rest are dropped
+    bool *listed = NULL;
+    if (tracked->count)
+    {
+        listed = gf_scratch_calloc (tracked->count, sizeof (bool));
+        if (!listed)
+        {
+            data->client_list_dirty = true;
+            if (prop)
+                XFree (prop);
+            return;
+        }
+    }
+
+    for (unsigned long j = 0; j < nitems; j++)
+    {
+        int idx = _tracker_index (tracked, clients[j]);
+        if (idx >= 0)
+            listed[idx] = true;
+    }
+
+    for (uint32_t i = 0; i < tracked->count;)
+    {
+        if (listed[i])
+        {
+            i++;
+            continue;
+        }
+
+        // The swap-remove pulls the last client (and its flag) into slot i
+        _tracker_set_remove (&data->dirty_clients, tracked->items[i]);
+        listed[i] = listed[tracked->count - 1];
+        _tracker_set_remove_at (tracked, i);
+    }
+
+    for (unsigned long j = 0; j < nitems; j++)
+    {
+        if (_tracker_index (tracked, clients[j]) >= 0)
+            continue;
+
+        if (!_tracker_set_add (tracked, clients[j]))
+        {
+            data->client_list_dirty = true;
+            break;
+        }
+
+        XSelectInput (dpy, clients[j], GF_CLIENT_EVENT_MASK);
+        _tracker_mark_dirty (data, clients[j]);
+    }
+
+    if (prop)
+        XFree (prop);
+}
+
+// Record a client-level event. Returns true if the client needs a refresh.
+static bool
+_tracker_handle_client_event (gf_linux_platform_data_t *data, const XEvent *ev)
+{
+    Window w = ev->xany.window;
+
+    if (_tracker_index (&data->tracked_clients, w) < 0)
+        return false;
+
+    switch (ev->type)
+    {
+    case PropertyNotify:
+        if (!_event_client_property_relevant (&data->atoms, ev->xproperty.atom))
+            return false;
+        break;
+    case ConfigureNotify:
+    case MapNotify:
+    case UnmapNotify:
+        break;
+    case DestroyNotify:
+        _tracker_set_remove (&data->tracked_clients, w);
+        _tracker_set_remove (&data->dirty_clients, w);
+        return true;
+    default:
+        return false;
+    }
+
+    _tracker_mark_dirty (data, w);
+    return true;
+}
+
+gf_err_t
+gf_event_get_changed_windows (gf_platform_t *platform, gf_win_info_t **windows,
+                              uint32_t *count)
+{
+    if (!platform || !platform->platform_data || !windows || !count)
+        return GF_ERROR_INVALID_PARAMETER;
+
+    gf_linux_platform_data_t *data = (gf_linux_platform_data_t *)platform->platform_data;
+
+    *windows = NULL;
+    *count = 0;
+
+    if (data->client_list_dirty)
+        _tracker_sync_clients (data);
+
+    gf_window_set_t *dirty = &data->dirty_clients;
+    if (dirty->count == 0)
+        return GF_SUCCESS;
+
+    gf_win_info_t *changed = gf_scratch_alloc (dirty->count * sizeof (gf_win_info_t));
+    if (!changed)
+        return GF_ERROR_MEMORY_ALLOCATION;
+
+    uint32_t changed_count
+        = query_window_infos (data->display, dirty->items, dirty->count, NULL, changed);
+    dirty->count = 0;
+    gf_window_map_clear (&dirty->map);
+
+    if (changed_count == 0)
+        return GF_SUCCESS;
+
+    *windows = changed;
+    *count = changed_count;
+    return GF_SUCCESS;
+}
+
+void
+gf_event_tracker_cleanup (gf_linux_platform_data_t *data)
+{
+    _tracker_set_free (&data->tracked_clients);
+    _tracker_set_free (&data->dirty_clients);
+}
+
+int
+gf_event_fd (gf_platform_t *platform)
+{
+    if (!platform || !platform->platform_data)
+        return -1;
+
+    gf_linux_platform_data_t *data = (gf_linux_platform_data_t *)platform->platform_data;
+    if (!data->display)
+        return -1;
+
+    return ConnectionNumber (data->display);
+}
+
+/*
+ * Drain everything Xlib has buffered. Every event has to be pulled off the
+ * queue here: anything left behind would never make the connection readable
+ * again and the loop would sleep through it. XInput2 key events are decoded
+ * for keymap_poll, client events feed the incremental tracker, and root
+ * property changes decide whether a tick is needed.
+ */
+bool
+gf_event_dispatch (gf_platform_t *platform)
+{
+    if (!platform || !platform->platform_data)
+        return false;
+
+    gf_linux_platform_data_t *data = (gf_linux_platform_data_t *)platform->platform_data;
+    Display *dpy = data->display;
+    if (!dpy)
+        return false;
+
+    bool activity = false;
+    XEvent ev;
+
+    while (XPending (dpy) > 0)
+    {
+        XNextEvent (dpy, &ev);
+
+        if (ev.type == GenericEvent)
+        {
+            if (gf_keymap_handle_event (platform, &ev))
+                activity = true;
+            continue;
+        }
+
+        if (ev.xany.window != data->root_window)
+        {
+            gf_prop_cache_handle_event (data, &ev);
+
+            if (_tracker_handle_client_event (data, &ev))
+                activity = true;
+            continue;
+        }
+
+        if (ev.type == PropertyNotify
+            && _event_root_property_relevant (&data->atoms, ev.xproperty.atom))
+        {
+            if (ev.xproperty.atom == data->atoms.net_client_list)
+                data->client_list_dirty = true;
+            activity = true;
+        }
+    }
+
+    return activity || data->pending_key_count > 0;
+}
@@ -1,5 +1,6 @@
 #include "internal.h"
 #include "../../utils/logger.h"
+#include "../../utils/memory.h"
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
 #include <fcntl.h>
@@ -23,8 +24,8 @@ window_name_matches (const char *name, const char *list[], size_t count)
     return false;
 }
 
-bool
-window_is_app_exception (gf_display_t display, gf_handle_t window)
+static bool
+class_is_app_exception (const char *res_name, const char *res_class)
 {
     const char *screenshot_classes[]
         = { "flameshot",       "Gnome-screenshot", "Spectacle",
@@ -32,18 +33,30 @@ window_is_app_exception (gf_display_t display, gf_handle_t window)
             "dunst",           "xfce4-notifyd",    "notification-daemon",
             "update-notifier", "update-manager",   "gpk-update-viewer",
             "gnome-software" };
+    size_t count = sizeof (screenshot_classes) / sizeof (screenshot_classes[0]);
+
+    return (res_class && window_name_matches (res_class, screenshot_classes, count))
+           || (res_name && window_name_matches (res_name, screenshot_classes, count));
+}
+
+bool
+window_class_is_self (const char *res_name, const char *res_class)
+{
+    return (res_name && strcmp (res_name, "gridflux-gui") == 0)
+           || (res_class && strstr (res_class, "com.gridflux.gui") != NULL);
+}
+
+bool
+window_is_app_exception (gf_display_t display, gf_handle_t window)
+{
+    const gf_window_props_t *cached = gf_prop_cache_peek (window, GF_PROPS_CLASS);
+    if (cached)
+        return gf_window_props_is_app_exception (cached);
 
     XClassHint hint;
-    if (XGetClassHint (display, window, &hint))
+    if (gf_x_get_class_hint (display, window, &hint))
     {
-        bool match = (hint.res_class
-                      && window_name_matches (hint.res_class, screenshot_classes,
-                                              sizeof (screenshot_classes)
-                                                  / sizeof (screenshot_classes[0])))
-                     || (hint.res_name
-                         && window_name_matches (hint.res_name, screenshot_classes,
-                                                 sizeof (screenshot_classes)
-                                                     / sizeof (screenshot_classes[0])));
+        bool match = class_is_app_exception (hint.res_name, hint.res_class);
 
         if (hint.res_name)
             XFree (hint.res_name);
@@ -56,66 +69,309 @@ window_is_app_exception (gf_display_t display, gf_handle_t window)
 }
 
 bool
-window_has_type (gf_display_t display, gf_handle_t window, Atom type)
+window_has_type (gf_display_t display, gf_handle_t window, uint32_t types)
 {
+    // Answer from the cache when the window is known; dock and root-child scans
+    // also land here and should not populate it.
+    const gf_window_props_t *cached = gf_prop_cache_peek (window, GF_PROPS_TYPE);
+    if (cached)
+        return gf_window_props_has_type (cached, types);
+
     gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
     unsigned char *data = NULL;
     unsigned long nitems = 0;
 
     if (gf_platform_get_window_property (display, window, atoms->net_wm_window_type,
                                          XA_ATOM, &data, &nitems)
-            != GF_SUCCESS
-        || nitems == 0)
+        != GF_SUCCESS)
         return false;
 
-    Atom *types = (Atom *)data;
-    bool found = false;
-    for (unsigned long i = 0; i < nitems; i++)
+    uint32_t found = gf_net_type_from_atoms ((Atom *)data, nitems);
+    XFree (data);
+    return (found & types) == types;
+}
+
+bool
+window_has_excluded_state (gf_display_t display, gf_handle_t window)
+{
+    const gf_window_props_t *props = gf_prop_cache_get (display, window, GF_PROPS_STATE);
+    return props && gf_window_props_has_excluded_state (props);
+}
+
+bool
+window_has_excluded_type (gf_display_t display, gf_handle_t window)
+{
+    const gf_window_props_t *props = gf_prop_cache_get (display, window, GF_PROPS_TYPE);
+    return props && gf_window_props_has_excluded_type (props);
+}
+
+uint32_t
+gf_net_state_from_atoms (const Atom *list, unsigned long count)
+{
+    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
+    const struct
+    {
+        Atom atom;
+        uint32_t bit;
+    } table[] = {
+        { atoms->net_wm_state_maximized_vert, GF_NET_STATE_MAXIMIZED_VERT },
+        { atoms->net_wm_state_maximized_horz, GF_NET_STATE_MAXIMIZED_HORZ },
+        { atoms->net_wm_state_hidden, GF_NET_STATE_HIDDEN },
+        { atoms->net_wm_state_fullscreen, GF_NET_STATE_FULLSCREEN },
+        { atoms->net_wm_state_modal, GF_NET_STATE_MODAL },
+        { atoms->net_wm_state_skip_taskbar, GF_NET_STATE_SKIP_TASKBAR },
+        { atoms->net_wm_state_above, GF_NET_STATE_ABOVE },
+        { atoms->net_wm_state_sticky, GF_NET_STATE_STICKY },
+    };
+
+    uint32_t bits = 0;
+    for (unsigned long i = 0; i < count; i++)
     {
-        if (types[i] == type)
+        for (size_t k = 0; k < sizeof (table) / sizeof (table[0]); k++)
         {
-            found = true;
-            break;
+            if (list[i] == table[k].atom)
+            {
+                bits |= table[k].bit;
+                break;
+            }
         }
     }
-    XFree (data);
-    return found;
+    return bits;
 }
 
-bool
-window_has_excluded_state (gf_display_t display, gf_handle_t window)
+uint32_t
+gf_net_type_from_atoms (const Atom *list, unsigned long count)
 {
     gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
-    Atom excluded_states[] = { atoms->net_wm_state_skip_taskbar,
-                               atoms->net_wm_state_modal, atoms->net_wm_state_above };
+    const struct
+    {
+        Atom atom;
+        uint32_t bit;
+    } table[] = {
+        { atoms->net_wm_window_type_normal, GF_NET_TYPE_NORMAL },
+        { atoms->net_wm_window_type_dialog, GF_NET_TYPE_DIALOG },
+        { atoms->net_wm_window_type_utility, GF_NET_TYPE_UTILITY },
+        { atoms->net_wm_window_type_toolbar, GF_NET_TYPE_TOOLBAR },
+        { atoms->net_wm_window_type_menu, GF_NET_TYPE_MENU },
+        { atoms->net_wm_window_type_splash, GF_NET_TYPE_SPLASH },
+        { atoms->net_wm_window_type_dropdown_menu, GF_NET_TYPE_DROPDOWN_MENU },
+        { atoms->net_wm_window_type_popup_menu, GF_NET_TYPE_POPUP_MENU },
+        { atoms->net_wm_window_type_tooltip, GF_NET_TYPE_TOOLTIP },
+        { atoms->net_wm_window_type_notification, GF_NET_TYPE_NOTIFICATION },
+        { atoms->net_wm_window_type_dock, GF_NET_TYPE_DOCK },
+        { atoms->net_wm_window_type_desktop, GF_NET_TYPE_DESKTOP },
+        { atoms->net_wm_window_type_combo, GF_NET_TYPE_COMBO },
+    };
 
-    for (size_t i = 0; i < sizeof (excluded_states) / sizeof (excluded_states[0]); i++)
+    uint32_t bits = 0;
+    for (unsigned long i = 0; i < count; i++)
     {
-        if (gf_platform_window_has_state (display, window, excluded_states[i]))
-            return true;
+        for (size_t k = 0; k < sizeof (table) / sizeof (table[0]); k++)
+        {
+            if (list[i] == table[k].atom)
+            {
+                bits |= table[k].bit;
+                break;
+            }
+        }
     }
-    return false;
+    return bits;
 }
 
+// True when every state in `states` is set.
 bool
-window_has_excluded_type (gf_display_t display, gf_handle_t window)
+gf_window_props_has_state (const gf_window_props_t *props, uint32_t states)
+{
+    return (props->states & states) == states;
+}
+
+// True when every type in `types` is set.
+bool
+gf_window_props_has_type (const gf_window_props_t *props, uint32_t types)
+{
+    return (props->types & types) == types;
+}
+
+bool
+gf_window_props_has_excluded_state (const gf_window_props_t *props)
+{
+    return (props->states & GF_NET_STATE_EXCLUDED) != 0;
+}
+
+bool
+gf_window_props_has_excluded_type (const gf_window_props_t *props)
+{
+    return (props->types & GF_NET_TYPE_EXCLUDED) != 0;
+}
+
+bool
+gf_window_props_is_self (const gf_window_props_t *props)
+{
+    return props->has_class && window_class_is_self (props->res_name, props->res_class);
+}
+
+bool
+gf_window_props_is_app_exception (const gf_window_props_t *props)
+{
+    return props->has_class && class_is_app_exception (props->res_name, props->res_class);
+}
+
+// Same verdict as gf_window_is_excluded, decided from an already-fetched snapshot.
+bool
+gf_window_props_is_excluded (const gf_window_props_t *props)
+{
+    if (gf_window_props_is_self (props) || gf_window_props_is_app_exception (props))
+        return true;
+
+    // Exclude fullscreen NORMAL windows
+    if (gf_window_props_has_type (props, GF_NET_TYPE_NORMAL)
+        && gf_window_props_has_state (props, GF_NET_STATE_FULLSCREEN))
+        return true;
+
+    return gf_window_props_has_excluded_state (props)
+           || gf_window_props_has_excluded_type (props);
+}
+
+// Read an atom-list property and decode it with `decode`; 0 when absent.
+static uint32_t
+_props_read_atom_bits (Display *dpy, Window w, Atom property,
+                       uint32_t (*decode) (const Atom *, unsigned long))
+{
+    unsigned char *data = NULL;
+    unsigned long nitems = 0;
+
+    if (gf_platform_get_window_property (dpy, w, property, XA_ATOM, &data, &nitems)
+        != GF_SUCCESS)
+        return 0;
+
+    uint32_t bits = decode ((Atom *)data, nitems);
+    XFree (data);
+    return bits;
+}
+
+static bool
+_props_read_cardinal (Display *dpy, Window w, Atom property, unsigned long *out)
+{
+    unsigned char *data = NULL;
+    unsigned long nitems = 0;
+
+    if (gf_platform_get_window_property (dpy, w, property, XA_CARDINAL, &data, &nitems)
+        != GF_SUCCESS)
+        return false;
+
+    *out = *(unsigned long *)data;
+    XFree (data);
+    return true;
+}
+
+// Probe the frame extent atoms in priority order: GTK CSD, EWMH, then KDE/Qt.
+static void
+_props_fetch_frame_xlib (Display *dpy, Window w, gf_window_props_t *props)
 {
     gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
-    Atom excluded_types[] = {
-        atoms->net_wm_window_type_dock,         atoms->net_wm_window_type_desktop,
-        atoms->net_wm_window_type_toolbar,      atoms->net_wm_window_type_menu,
-        atoms->net_wm_window_type_splash,       atoms->net_wm_window_type_dropdown_menu,
-        atoms->net_wm_window_type_popup_menu,   atoms->net_wm_window_type_tooltip,
-        atoms->net_wm_window_type_notification, atoms->net_wm_window_type_utility,
-        atoms->net_wm_window_type_combo
-    };
+    Atom candidates[] = { atoms->gtk_frame_extents, atoms->net_frame_extents,
+                          atoms->qt_frame_extents };
 
-    for (size_t i = 0; i < sizeof (excluded_types) / sizeof (excluded_types[0]); i++)
+    for (size_t i = 0; i < 3; i++)
     {
-        if (window_has_type (display, window, excluded_types[i]))
-            return true;
+        unsigned char *data = NULL;
+        unsigned long nitems = 0;
+
+        if (gf_platform_get_window_property (dpy, w, candidates[i], XA_CARDINAL, &data,
+                                             &nitems)
+                == GF_SUCCESS
+            && nitems >= 4)
+        {
+            unsigned long *ext = (unsigned long *)data;
+            for (int k = 0; k < 4; k++)
+                props->frame_extents[k] = (long)ext[k];
+            props->has_frame_extents = true;
+            props->frame_is_csd = (candidates[i] == atoms->gtk_frame_extents);
+            XFree (data);
+            return;
+        }
+
+        if (data)
+            XFree (data);
     }
-    return false;
+}
+
+// Blocking Xlib path: one round-trip per requested group, per window.
+static void
+_props_query_xlib (Display *dpy, Window w, uint32_t mask, gf_window_props_t *props)
+{
+    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
+    XWindowAttributes attrs;
+
+    if (mask & (GF_PROPS_ATTRS | GF_PROPS_GEOMETRY))
+    {
+        if (!gf_x_get_window_attributes (dpy, w, &attrs))
+            return;
+        props->valid = true;
+        props->mapped = (attrs.map_state != IsUnmapped);
+    }
+
+    if (mask & GF_PROPS_GEOMETRY)
+    {
+        int abs_x, abs_y;
+        Window child;
+        if (gf_x_translate_coordinates (dpy, w, DefaultRootWindow (dpy), 0, 0, &abs_x,
+                                        &abs_y, &child))
+        {
+            props->has_geometry = true;
+            props->geometry = (gf_rect_t){ abs_x, abs_y, attrs.width, attrs.height };
+        }
+    }
+
+    if (mask & GF_PROPS_DESKTOP)
+        props->has_desktop
+            = _props_read_cardinal (dpy, w, atoms->net_wm_desktop, &props->desktop);
+
+    if (mask & GF_PROPS_PID)
+        props->has_pid = _props_read_cardinal (dpy, w, atoms->net_wm_pid, &props->pid);
+
+    if (mask & GF_PROPS_CLASS)
+    {
+        XClassHint hint = { NULL, NULL };
+        if (gf_x_get_class_hint (dpy, w, &hint))
+        {
+            props->has_class = true;
+            snprintf (props->res_name, sizeof (props->res_name), "%s",
+                      hint.res_name ? hint.res_name : "");
+            snprintf (props->res_class, sizeof (props->res_class), "%s",
+                      hint.res_class ? hint.res_class : "");
+            if (hint.res_name)
+                XFree (hint.res_name);
+            if (hint.res_class)
+                XFree (hint.res_class);
+        }
+    }
+
+    if (mask & GF_PROPS_STATE)
+        props->states = _props_read_atom_bits (dpy, w, atoms->net_wm_state,
+                                               gf_net_state_from_atoms);
+
+    if (mask & GF_PROPS_TYPE)
+        props->types = _props_read_atom_bits (dpy, w, atoms->net_wm_window_type,
+                                              gf_net_type_from_atoms);
+
+    if (mask & GF_PROPS_FRAME)
+        _props_fetch_frame_xlib (dpy, w, props);
+}
+
+void
+gf_window_props_query (Display *dpy, const Window *windows, uint32_t count,
+                       uint32_t mask, gf_window_props_t *out)
+{
+    memset (out, 0, count * sizeof (*out));
+
+#ifdef GF_HAVE_XCB
+    if (gf_xcb_props_query (dpy, windows, count, mask, out))
+        return;
+#endif
+
+    for (uint32_t i = 0; i < count; i++)
+        _props_query_xlib (dpy, windows[i], mask, &out[i]);
 }
 
 gf_err_t
@@ -129,7 +385,7 @@ remove_size_constraints (Display *dpy, Window win)
     // while preserving every other hint (base size, gravity, etc.). If the client
     // has no WM_NORMAL_HINTS we leave it untouched rather than zeroing the struct.
     long supplied = 0;
-    if (XGetWMNormalHints (dpy, win, hints, &supplied))
+    if (gf_x_get_wm_normal_hints (dpy, win, hints, &supplied))
     {
         hints->flags &= ~(PMinSize | PMaxSize | PResizeInc | PAspect);
         XSetWMNormalHints (dpy, win, hints);
@@ -156,90 +412,132 @@ run_cmd_sync (const char *cmd, char *const argv[])
     posix_spawnattr_destroy (&attr);
 }
 
+// Outer frame rect from a snapshot holding geometry and frame extents.
 bool
-get_frame_geometry (Display *dpy, Window target, gf_rect_t *frame_rect)
+frame_geometry_from_props (const gf_window_props_t *props, gf_rect_t *frame_rect)
 {
-    XWindowAttributes attrs;
-    if (!XGetWindowAttributes (dpy, target, &attrs))
+    if (!props->has_geometry)
         return false;
 
-    int left_ext = 0, right_ext = 0, top_ext = 0, bottom_ext = 0;
-    bool is_csd = false;
-    gf_platform_get_frame_extents (dpy, target, &left_ext, &right_ext, &top_ext,
-                                   &bottom_ext, &is_csd);
-
-    Window root = DefaultRootWindow (dpy);
-    int abs_x, abs_y;
-    Window child;
-    if (!XTranslateCoordinates (dpy, target, root, 0, 0, &abs_x, &abs_y, &child))
-        return false;
+    const gf_rect_t *g = &props->geometry;
+    long left_ext = 0, right_ext = 0, top_ext = 0, bottom_ext = 0;
+    if (props->has_frame_extents)
+    {
+        left_ext = props->frame_extents[0];
+        right_ext = props->frame_extents[1];
+        top_ext = props->frame_extents[2];
+        bottom_ext = props->frame_extents[3];
+    }
 
-    if (is_csd)
+    if (props->frame_is_csd)
     {
-        frame_rect->x = abs_x + left_ext;
-        frame_rect->y = abs_y + top_ext;
-        frame_rect->width = attrs.width - left_ext - right_ext;
-        frame_rect->height = attrs.height - top_ext - bottom_ext;
+        frame_rect->x = g->x + left_ext;
+        frame_rect->y = g->y + top_ext;
+        frame_rect->width = g->width - left_ext - right_ext;
+        frame_rect->height = g->height - top_ext - bottom_ext;
     }
     else
     {
-        frame_rect->x = abs_x - left_ext;
-        frame_rect->y = abs_y - top_ext;
-        frame_rect->width = attrs.width + left_ext + right_ext;
-        frame_rect->height = attrs.height + top_ext + bottom_ext;
+        frame_rect->x = g->x - left_ext;
+        frame_rect->y = g->y - top_ext;
+        frame_rect->width = g->width + left_ext + right_ext;
+        frame_rect->height = g->height + top_ext + bottom_ext;
     }
     return true;
 }
 
 bool
-query_window_info (Display *display, Window window, gf_platform_atoms_t *atoms,
-                   gf_ws_id_t *workspace_id, gf_win_info_t *info)
+get_frame_geometry (Display *dpy, Window target, gf_rect_t *frame_rect)
 {
-    if (!gf_window_is_valid (display, window))
+    const gf_window_props_t *props
+        = gf_prop_cache_get (dpy, target, GF_PROPS_GEOMETRY | GF_PROPS_FRAME);
+    return props && frame_geometry_from_props (props, frame_rect);
+}
+
+bool
+window_info_from_props (Window window, const gf_window_props_t *props,
+                        gf_ws_id_t *workspace_id, gf_win_info_t *info)
+{
+    if (!props->valid)
         return false;
 
-    unsigned char *desktop_data = NULL;
-    unsigned long desktop_nitems = 0;
-    if (gf_platform_get_window_property (display, window, atoms->net_wm_desktop,
-                                         XA_CARDINAL, &desktop_data, &desktop_nitems)
-            != GF_SUCCESS
-        || desktop_nitems == 0)
-    {
-        // Desktop unreadable: we cannot confirm the window is on the requested
-        // workspace, so exclude it rather than showing it on every workspace.
-        if (workspace_id != NULL)
-            return false;
-    }
-    else
-    {
-        unsigned long window_workspace = *(unsigned long *)desktop_data;
-        XFree (desktop_data);
+    // Desktop unreadable: we cannot confirm which workspace the window is on,
+    // so exclude it rather than showing it on every workspace.
+    if (!props->has_desktop)
+        return false;
 
-        // 0xFFFFFFFF marks a sticky window that appears on all workspaces.
-        bool is_sticky = (window_workspace == 0xFFFFFFFFUL);
-        if (workspace_id != NULL && !is_sticky
-            && (gf_ws_id_t)window_workspace != *workspace_id)
-        {
-            return false;
-        }
+    // 0xFFFFFFFF marks a sticky window that appears on all workspaces.
+    bool is_sticky = (props->desktop == 0xFFFFFFFFUL);
+    if (workspace_id != NULL && !is_sticky
+        && (gf_ws_id_t)props->desktop != *workspace_id)
+    {
+        return false;
     }
 
-    gf_rect_t geometry;
-    if (gf_window_get_geometry (display, window, &geometry) != GF_SUCCESS)
+    if (!props->has_geometry)
         return false;
 
-    bool is_maximized = gf_window_is_maximized (display, window);
-    bool is_excluded = gf_window_is_excluded (display, window);
+    bool is_maximized = gf_window_props_has_state (props, GF_NET_STATE_MAXIMIZED);
+    bool is_excluded = gf_window_props_is_excluded (props);
 
-    gf_ws_id_t resolved_workspace
-        = (workspace_id != NULL) ? *workspace_id : GF_FIRST_WORKSPACE_ID;
+    // Without a requested workspace, report the window's own desktop.
+    gf_ws_id_t resolved_workspace;
+    if (workspace_id != NULL)
+        resolved_workspace = *workspace_id;
+    else if (is_sticky)
+        resolved_workspace = GF_DESKTOP_STICKY;
+    else
+        resolved_workspace = (gf_ws_id_t)props->desktop;
 
     *info = (gf_win_info_t){ .id = window,
                              .workspace_id = resolved_workspace,
-                             .geometry = geometry,
+                             .geometry = props->geometry,
                              .is_maximized = is_maximized,
                              .needs_update = false,
                              .is_valid = !is_excluded,
                              .last_modified = time (NULL) };
     return true;
 }
+
+bool
+query_window_info (Display *display, Window window, gf_ws_id_t *workspace_id,
+                   gf_win_info_t *info)
+{
+    gf_window_props_t props;
+    gf_window_props_fetch (display, &window, 1, &props);
+    return window_info_from_props (window, &props, workspace_id, info);
+}
+
+// Batched query_window_info: every client's properties are fetched in one
+// pipelined pass before any of them is evaluated. Returns how many windows
+// were written to infos.
+uint32_t
+query_window_infos (Display *display, const Window *windows, uint32_t count,
+                    gf_ws_id_t *workspace_id, gf_win_info_t *infos)
+{
+    if (count == 0)
+        return 0;
+
+    gf_window_props_t *props = gf_scratch_alloc (count * sizeof (gf_window_props_t));
+    if (!props)
+    {
+        uint32_t found = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (query_window_info (display, windows[i], workspace_id, &infos[found]))
+                found++;
+        }
+        return found;
+    }
+
+    gf_window_props_fetch (display, windows, count, props);
+
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (window_info_from_props (windows[i], &props[i], workspace_id, &infos[found]))
+            found++;
+    }
+
+    return found;
+}
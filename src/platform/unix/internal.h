@@ -3,23 +3,167 @@
 
 #include "../../core/types.h"
 #include "platform.h"
+#include "xcall.h"
 #include <X11/Xatom.h>
 
 /* --- Shell & Background --- */
 void run_cmd_sync (const char *cmd, char *const argv[]);
 
+/* --- Window Property Snapshot --- */
+#define GF_PROPS_MAX_ATOMS 32
+#define GF_PROPS_CLASS_SIZE 128
+
+// Property groups of a snapshot, used to request and invalidate them.
+typedef enum
+{
+    GF_PROPS_ATTRS = (1 << 0), // window exists (attributes readable), map state
+    GF_PROPS_GEOMETRY = (1 << 1),
+    GF_PROPS_DESKTOP = (1 << 2),
+    GF_PROPS_CLASS = (1 << 3),
+    GF_PROPS_STATE = (1 << 4),
+    GF_PROPS_TYPE = (1 << 5),
+    GF_PROPS_FRAME = (1 << 6),
+    GF_PROPS_PID = (1 << 7),
+} gf_props_mask_t;
+
+// Groups kept in the per-window cache. Properties are refreshed on
+// PropertyNotify; attributes and geometry are kept current from the
+// structure events (map, unmap, configure) of the cached window.
+#define GF_PROPS_CACHED                                                                 \
+    (GF_PROPS_ATTRS | GF_PROPS_GEOMETRY | GF_PROPS_DESKTOP | GF_PROPS_CLASS            \
+     | GF_PROPS_STATE | GF_PROPS_TYPE | GF_PROPS_FRAME | GF_PROPS_PID)
+
+// _NET_WM_STATE atoms GridFlux acts on, decoded once per fetch.
+typedef enum
+{
+    GF_NET_STATE_MAXIMIZED_VERT = (1 << 0),
+    GF_NET_STATE_MAXIMIZED_HORZ = (1 << 1),
+    GF_NET_STATE_HIDDEN = (1 << 2),
+    GF_NET_STATE_FULLSCREEN = (1 << 3),
+    GF_NET_STATE_MODAL = (1 << 4),
+    GF_NET_STATE_SKIP_TASKBAR = (1 << 5),
+    GF_NET_STATE_ABOVE = (1 << 6),
+    GF_NET_STATE_STICKY = (1 << 7),
+} gf_net_state_t;
+
+#define GF_NET_STATE_MAXIMIZED                                                          \
+    (GF_NET_STATE_MAXIMIZED_VERT | GF_NET_STATE_MAXIMIZED_HORZ)
+#define GF_NET_STATE_EXCLUDED                                                           \
+    (GF_NET_STATE_SKIP_TASKBAR | GF_NET_STATE_MODAL | GF_NET_STATE_ABOVE)
+
+// _NET_WM_WINDOW_TYPE atoms GridFlux acts on, decoded once per fetch.
+typedef enum
+{
+    GF_NET_TYPE_NORMAL = (1 << 0),
+    GF_NET_TYPE_DIALOG = (1 << 1),
+    GF_NET_TYPE_UTILITY = (1 << 2),
+    GF_NET_TYPE_TOOLBAR = (1 << 3),
+    GF_NET_TYPE_MENU = (1 << 4),
+    GF_NET_TYPE_SPLASH = (1 << 5),
+    GF_NET_TYPE_DROPDOWN_MENU = (1 << 6),
+    GF_NET_TYPE_POPUP_MENU = (1 << 7),
+    GF_NET_TYPE_TOOLTIP = (1 << 8),
+    GF_NET_TYPE_NOTIFICATION = (1 << 9),
+    GF_NET_TYPE_DOCK = (1 << 10),
+    GF_NET_TYPE_DESKTOP = (1 << 11),
+    GF_NET_TYPE_COMBO = (1 << 12),
+} gf_net_type_t;
+
+#define GF_NET_TYPE_EXCLUDED                                                            \
+    (GF_NET_TYPE_DOCK | GF_NET_TYPE_DESKTOP | GF_NET_TYPE_TOOLBAR | GF_NET_TYPE_MENU    \
+     | GF_NET_TYPE_SPLASH | GF_NET_TYPE_DROPDOWN_MENU | GF_NET_TYPE_POPUP_MENU          \
+     | GF_NET_TYPE_TOOLTIP | GF_NET_TYPE_NOTIFICATION | GF_NET_TYPE_UTILITY             \
+     | GF_NET_TYPE_COMBO)
+
+// Everything enumeration and the exclusion checks read from a client, fetched
+// together so a batch of windows costs one pipelined pass instead of a
+// round-trip per property.
+typedef struct
+{
+    bool valid;  // window attributes were readable
+    bool mapped; // map state is not IsUnmapped
+    bool has_desktop;
+    bool has_geometry;
+    bool has_class;
+    bool has_frame_extents;
+    bool frame_is_csd;
+    bool has_pid;
+    unsigned long desktop;
+    unsigned long pid;
+    long frame_extents[4]; // left, right, top, bottom
+    gf_rect_t geometry;    // root-relative
+    char res_name[GF_PROPS_CLASS_SIZE];
+    char res_class[GF_PROPS_CLASS_SIZE];
+    uint32_t states; // gf_net_state_t bits
+    uint32_t types;  // gf_net_type_t bits
+} gf_window_props_t;
+
+// One cached snapshot; `cached` holds the gf_props_mask_t groups still valid.
+// The window comes first so the cache's window map can key on it.
+typedef struct gf_prop_cache_entry
+{
+    Window window;
+    uint32_t cached;
+    gf_window_props_t props;
+} gf_prop_cache_entry_t;
+
+void gf_window_props_query (Display *dpy, const Window *windows, uint32_t count,
+                            uint32_t mask, gf_window_props_t *out);
+void gf_window_props_fetch (Display *dpy, const Window *windows, uint32_t count,
+                            gf_window_props_t *out);
+uint32_t gf_net_state_from_atoms (const Atom *atoms, unsigned long count);
+uint32_t gf_net_type_from_atoms (const Atom *atoms, unsigned long count);
+bool gf_window_props_has_state (const gf_window_props_t *props, uint32_t states);
+bool gf_window_props_has_type (const gf_window_props_t *props, uint32_t types);
+bool gf_window_props_has_excluded_state (const gf_window_props_t *props);
+bool gf_window_props_has_excluded_type (const gf_window_props_t *props);
+bool gf_window_props_is_self (const gf_window_props_t *props);
+bool gf_window_props_is_app_exception (const gf_window_props_t *props);
+bool gf_window_props_is_excluded (const gf_window_props_t *props);
+
+/* --- Window Map (see winmap.c) --- */
+// The slot arrays are swap-removed by their owners: call gf_window_map_remove
+// while both the removed slot and the last one are still in place.
+int gf_window_map_find (const gf_window_map_t *map, const void *slots, size_t stride,
+                        uint32_t count, Window w);
+bool gf_window_map_add (gf_window_map_t *map, const void *slots, size_t stride,
+                        uint32_t slot);
+void gf_window_map_remove (gf_window_map_t *map, const void *slots, size_t stride,
+                           uint32_t count, uint32_t slot);
+void gf_window_map_clear (gf_window_map_t *map);
+void gf_window_map_free (gf_window_map_t *map);
+
+/* --- Property Cache --- */
+const gf_window_props_t *gf_prop_cache_get (Display *dpy, Window window, uint32_t need);
+const gf_window_props_t *gf_prop_cache_peek (Window window, uint32_t need);
+void gf_prop_cache_handle_event (gf_linux_platform_data_t *data, const XEvent *ev);
+void gf_prop_cache_forget (gf_linux_platform_data_t *data, Window window);
+void gf_prop_cache_cleanup (gf_linux_platform_data_t *data);
+
+#ifdef GF_HAVE_XCB
+/* --- XCB Backend (pipelined requests) --- */
+bool gf_xcb_props_query (Display *dpy, const Window *windows, uint32_t count,
+                         uint32_t mask, gf_window_props_t *out);
+#endif
+
 /* --- Window Identification & State --- */
 bool window_is_app_exception (gf_display_t display, gf_handle_t window);
-bool query_window_info (Display *display, Window window, gf_platform_atoms_t *atoms,
-                        gf_ws_id_t *workspace_id, gf_win_info_t *info);
+bool window_class_is_self (const char *res_name, const char *res_class);
+bool window_info_from_props (Window window, const gf_window_props_t *props,
+                             gf_ws_id_t *workspace_id, gf_win_info_t *info);
+bool query_window_info (Display *display, Window window, gf_ws_id_t *workspace_id,
+                        gf_win_info_t *info);
+uint32_t query_window_infos (Display *display, const Window *windows, uint32_t count,
+                             gf_ws_id_t *workspace_id, gf_win_info_t *infos);
 bool window_has_excluded_state (gf_display_t display, gf_handle_t window);
 bool window_has_excluded_type (gf_display_t display, gf_handle_t window);
-bool window_has_type (gf_display_t display, gf_handle_t window, Atom type);
+bool window_has_type (gf_display_t display, gf_handle_t window, uint32_t types);
 bool window_name_matches (const char *name, const char *list[], size_t count);
 bool window_is_self (gf_display_t display, gf_handle_t window);
 bool window_is_border_excluded (gf_display_t display, gf_handle_t window);
 void gf_window_get_class (gf_display_t dpy, gf_handle_t win, char *buffer,
                           size_t bufsize);
+gf_err_t gf_window_get_state (gf_display_t display, gf_handle_t window, uint32_t *state);
 
 /* --- Border Management --- */
 void gf_border_add (gf_platform_t *platform, gf_handle_t window, gf_color_t color,
@@ -29,6 +173,7 @@ void gf_border_remove (gf_platform_t *platform, gf_handle_t window);
 void gf_border_update (gf_platform_t *platform, const gf_config_t *config);
 
 /* --- Geometry & Layout --- */
+bool frame_geometry_from_props (const gf_window_props_t *props, gf_rect_t *frame_rect);
 bool get_frame_geometry (Display *dpy, Window target, gf_rect_t *frame_rect);
 gf_err_t remove_size_constraints (Display *dpy, Window win);
 
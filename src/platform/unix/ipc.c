@@ -1,16 +1,21 @@
+#define GF_MEM_TAG GF_MEM_TAG_IPC
+
 #include "../../ipc/ipc.h"
 #ifdef __unix__
 
+#include "../../utils/memory.h"
 #include <errno.h>
 #include <fcntl.h>
 #include <pwd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
 #define GF_SOCKET_NAME "gridflux.sock"
@@ -45,12 +50,52 @@ gf_ipc_get_socket_path (void)
     return socket_path;
 }
 
+/*
+ * Connections stay open and are multiplexed through one epoll set, which is
+ * also the descriptor the event loop polls. A client may pipeline framed
+ * requests; each is answered in order with its request id, and replies queue
+ * in a per-connection buffer that is written as the socket takes it. A
+ * connection that sends "subscribe" is fed events from its queue instead.
+ *
+ * Limits keep one client from costing the others: requests wait while more
+ * than GF_IPC_OUT_LIMIT reply bytes are unsent, and a connection with no
+ * traffic for GF_IPC_IDLE_TIMEOUT seconds is closed (a subscriber only when
+ * it also stops reading). Legacy clients get one reply and are closed, as
+ * before.
+ */
+#define GF_IPC_MAX_CLIENTS 64
+#define GF_IPC_IDLE_TIMEOUT 30
+#define GF_IPC_OUT_LIMIT (1u << 20)
+#define GF_IPC_EPOLL_BATCH 64
+#define GF_IPC_IN_SIZE (sizeof (gf_ipc_frame_t) + GF_IPC_MSG_SIZE)
+
+typedef struct
+{
+    int fd;
+    uint32_t events; // epoll interest currently registered
+    char in[GF_IPC_IN_SIZE + 1]; // one spare byte for the parser's terminator
+    size_t in_len;
+    char *out;
+    size_t out_len;
+    size_t out_sent;
+    size_t out_capacity;
+    time_t last_active;
+    bool closing; // nothing more to read: close once the output is written
+    bool dead;    // closed, freed at the next reap
+    uint32_t topics;
+    gf_ipc_queue_t *queue;
+} gf_ipc_conn_t;
+
+static gf_ipc_conn_t *g_conns[GF_IPC_MAX_CLIENTS];
+static uint32_t g_conn_count;
+static int g_epoll_fd = -1;
+
 gf_ipc_handle_t
 gf_ipc_server_create (void)
 {
     const char *path = gf_ipc_get_socket_path ();
 
-    int sock = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int sock = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
     if (sock < 0)
     {
         perror ("socket");
@@ -78,7 +123,7 @@ gf_ipc_server_create (void)
         return -1;
     }
 
-    if (listen (sock, 10) < 0)
+    if (listen (sock, SOMAXCONN) < 0)
     {
         perror ("listen");
         close (sock);
@@ -86,16 +131,67 @@ gf_ipc_server_create (void)
         return -1;
     }
 
-    int flags = fcntl (sock, F_GETFL, 0);
-    fcntl (sock, F_SETFL, flags | O_NONBLOCK);
+    // The listening socket is registered with a NULL pointer; connections
+    // with their gf_ipc_conn_t
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    g_epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (g_epoll_fd < 0 || epoll_ctl (g_epoll_fd, EPOLL_CTL_ADD, sock, &ev) < 0)
+    {
+        perror ("epoll");
+        if (g_epoll_fd >= 0)
+            close (g_epoll_fd);
+        g_epoll_fd = -1;
+        close (sock);
+        unlink (path);
+        return -1;
+    }
 
     printf ("IPC server listening on: %s\n", path);
     return sock;
 }
 
+static void
+conn_close (gf_ipc_conn_t *c)
+{
+    if (c->dead)
+        return;
+
+    epoll_ctl (g_epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close (c->fd);
+    c->dead = true;
+}
+
+// Frees closed connections. Never called while a batch of epoll events, which
+// point at connections, is being worked through.
+static void
+conn_reap (void)
+{
+    for (uint32_t i = g_conn_count; i-- > 0;)
+    {
+        gf_ipc_conn_t *c = g_conns[i];
+        if (!c->dead)
+            continue;
+
+        gf_ipc_queue_destroy (c->queue);
+        gf_free (c->out);
+        gf_free (c);
+        g_conns[i] = g_conns[--g_conn_count];
+    }
+}
+
 void
 gf_ipc_server_destroy (gf_ipc_handle_t handle)
 {
+    for (uint32_t i = 0; i < g_conn_count; i++)
+        conn_close (g_conns[i]);
+    conn_reap ();
+
+    if (g_epoll_fd >= 0)
+    {
+        close (g_epoll_fd);
+        g_epoll_fd = -1;
+    }
+
     if (handle >= 0)
     {
         close (handle);
@@ -103,6 +199,14 @@ gf_ipc_server_destroy (gf_ipc_handle_t handle)
     }
 }
 
+// The epoll set turns readable whenever the listener or any connection needs
+// attention, so it is the one descriptor the event loop waits on.
+int
+gf_ipc_server_poll_fd (gf_ipc_handle_t handle)
+{
+    return handle >= 0 ? g_epoll_fd : -1;
+}
+
 static bool
 gf_verify_peer_credentials (int client_sock)
 {
@@ -117,90 +221,445 @@ gf_verify_peer_credentials (int client_sock)
     return cred.uid == getuid ();
 }
 
-// Send exactly len bytes, retrying on EINTR and looping over partial writes.
 static bool
-send_all (int fd, const void *buf, size_t len)
+conn_has_output (const gf_ipc_conn_t *c)
 {
-    const char *p = (const char *)buf;
-    size_t sent = 0;
+    size_t len;
+    return c->out_sent < c->out_len || (c->queue && gf_ipc_queue_peek (c->queue, &len));
+}
 
-    while (sent < len)
+// Read while there is room for a request; write while there is output
+static void
+conn_update_events (gf_ipc_conn_t *c)
+{
+    if (c->dead)
+        return;
+
+    uint32_t events = 0;
+    if (!c->closing && c->in_len < GF_IPC_IN_SIZE)
+        events |= EPOLLIN;
+    if (conn_has_output (c))
+        events |= EPOLLOUT;
+
+    if (events == c->events)
+        return;
+
+    struct epoll_event ev = { .events = events, .data.ptr = c };
+    if (epoll_ctl (g_epoll_fd, EPOLL_CTL_MOD, c->fd, &ev) < 0)
+        conn_close (c);
+    else
+        c->events = events;
+}
+
+static bool
+conn_append (gf_ipc_conn_t *c, const void *data, size_t len)
+{
+    // Written bytes are dropped first, so the buffer only grows for backlog
+    if (c->out_len + len > c->out_capacity && c->out_sent)
     {
-        ssize_t n = send (fd, p + sent, len - sent, 0);
-        if (n > 0)
+        memmove (c->out, c->out + c->out_sent, c->out_len - c->out_sent);
+        c->out_len -= c->out_sent;
+        c->out_sent = 0;
+    }
+
+    if (c->out_len + len > c->out_capacity)
+    {
+        size_t capacity = c->out_capacity ? c->out_capacity : 4096;
+        while (capacity < c->out_len + len)
+            capacity *= 2;
+
+        char *out = gf_realloc (c->out, capacity);
+        if (!out)
+            return false;
+
+        c->out = out;
+        c->out_capacity = capacity;
+    }
+
+    memcpy (c->out + c->out_len, data, len);
+    c->out_len += len;
+    return true;
+}
+
+// Framed replies send only the payload; legacy ones the fixed struct.
+static bool
+conn_queue_response (gf_ipc_conn_t *c, gf_ipc_response_t *response,
+                     const gf_ipc_frame_t *request)
+{
+    if (!request)
+    {
+        gf_ipc_response_flatten (response);
+        return conn_append (c, response, GF_IPC_LEGACY_SIZE);
+    }
+
+    gf_ipc_frame_t frame;
+    uint32_t length = gf_ipc_response_length (response);
+    gf_ipc_frame_init (&frame, (uint16_t)response->status, request->request_id, length);
+
+    return conn_append (c, &frame, sizeof (frame))
+           && conn_append (c, gf_ipc_response_data (response), length);
+}
+
+// Write what the socket takes right now: queued replies, then events.
+static void
+conn_flush (gf_ipc_conn_t *c)
+{
+    while (!c->dead)
+    {
+        const void *data;
+        size_t len;
+        bool event = false;
+
+        if (c->out_sent < c->out_len)
         {
-            sent += (size_t)n;
-            continue;
+            data = c->out + c->out_sent;
+            len = c->out_len - c->out_sent;
         }
+        else if (c->queue && (data = gf_ipc_queue_peek (c->queue, &len)))
+            event = true;
+        else
+            break;
+
+        ssize_t n = send (c->fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
         if (n < 0 && errno == EINTR)
             continue;
-        return false; // error or peer closed
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (n <= 0)
+        {
+            conn_close (c);
+            return;
+        }
+
+        c->last_active = time (NULL);
+        if (event)
+            gf_ipc_queue_consume (c->queue, (size_t)n);
+        else
+            c->out_sent += (size_t)n;
     }
-    return true;
+
+    if (c->closing && !conn_has_output (c))
+        conn_close (c);
 }
 
-// Receive exactly len bytes, retrying on EINTR and looping over partial reads.
+static void
+conn_run (gf_ipc_conn_t *c, char *request, size_t len, void *user_data)
+{
+    gf_ipc_frame_t frame;
+    bool framed;
+    const char *command = gf_ipc_request_parse (request, len, &frame, &framed);
+    if (!command)
+    {
+        conn_close (c);
+        return;
+    }
+
+    gf_ipc_response_t response = { 0 };
+    response.status = GF_IPC_SUCCESS;
+    response.legacy = !framed;
+
+    gf_handle_client_message (command, &response, user_data);
+
+    if (!conn_queue_response (c, &response, framed ? &frame : NULL))
+        conn_close (c);
+    gf_ipc_response_release (&response);
+
+    // The handler already checked for a free slot and a framed client
+    if (!c->dead && response.subscribe && response.status == GF_IPC_SUCCESS)
+    {
+        c->queue = gf_ipc_queue_create ();
+        if (c->queue)
+            c->topics = response.subscribe;
+        else
+            c->closing = true;
+    }
+}
+
+// Run every complete request in the input buffer, oldest first. Returns
+// whether any ran.
 static bool
-recv_all (int fd, void *buf, size_t len)
+conn_dispatch (gf_ipc_conn_t *c, void *user_data)
 {
-    char *p = (char *)buf;
-    size_t got = 0;
+    const size_t magic = sizeof (GF_IPC_MAGIC) - 1;
+    bool handled = false;
 
-    while (got < len)
+    while (!c->dead && c->in_len > 0)
     {
-        ssize_t n = recv (fd, p + got, len - got, 0);
+        // Subscribers have nothing more to ask; whatever they send is dropped
+        if (c->topics)
+        {
+            c->in_len = 0;
+            break;
+        }
+
+        if (c->out_len - c->out_sent >= GF_IPC_OUT_LIMIT)
+            break;
+
+        // A legacy client's request is whatever has arrived; it gets one reply
+        size_t prefix = c->in_len < magic ? c->in_len : magic;
+        if (memcmp (c->in, GF_IPC_MAGIC, prefix) != 0)
+        {
+            conn_run (c, c->in, c->in_len, user_data);
+            c->in_len = 0;
+            c->closing = true;
+            handled = true;
+            break;
+        }
+
+        gf_ipc_frame_t frame;
+        if (c->in_len < sizeof (frame))
+            break;
+
+        memcpy (&frame, c->in, sizeof (frame));
+        if (!gf_ipc_frame_valid (&frame) || frame.length > GF_IPC_MSG_SIZE - 1)
+        {
+            conn_close (c);
+            break;
+        }
+
+        size_t total = sizeof (frame) + frame.length;
+        if (c->in_len < total)
+            break;
+
+        // The parser terminates the command in place, over the first byte of
+        // any request pipelined behind it
+        char next = c->in[total];
+        conn_run (c, c->in, total, user_data);
+        c->in[total] = next;
+
+        memmove (c->in, c->in + total, c->in_len - total);
+        c->in_len -= total;
+        handled = true;
+    }
+
+    return handled;
+}
+
+static void
+conn_read (gf_ipc_conn_t *c)
+{
+    while (c->in_len < GF_IPC_IN_SIZE)
+    {
+        ssize_t n = recv (c->fd, c->in + c->in_len, GF_IPC_IN_SIZE - c->in_len,
+                          MSG_DONTWAIT);
         if (n > 0)
         {
-            got += (size_t)n;
+            c->in_len += (size_t)n;
+            c->last_active = time (NULL);
             continue;
         }
         if (n < 0 && errno == EINTR)
             continue;
-        return false; // error or peer closed
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        // Hung up, or half-closed after its last request: answer what came
+        if (n < 0 || c->topics)
+            conn_close (c);
+        else
+            c->closing = true;
+        return;
     }
-    return true;
 }
 
-bool
-gf_ipc_server_process (gf_ipc_handle_t handle, void *user_data)
+static void
+conn_accept (int listener)
 {
-    int client = accept (handle, NULL, NULL);
-    if (client < 0)
+    while (true)
     {
-        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        int fd = accept4 (listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
         {
-            perror ("accept");
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror ("accept");
+            return;
         }
-        return false;
+
+        if (!gf_verify_peer_credentials (fd) || g_conn_count >= GF_IPC_MAX_CLIENTS)
+        {
+            close (fd);
+            continue;
+        }
+
+        gf_ipc_conn_t *c = gf_calloc (1, sizeof (gf_ipc_conn_t));
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        if (!c || epoll_ctl (g_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            gf_free (c);
+            close (fd);
+            continue;
+        }
+
+        c->fd = fd;
+        c->events = EPOLLIN;
+        c->last_active = time (NULL);
+        g_conns[g_conn_count++] = c;
     }
+}
+
+// Close connections that went quiet: clients with nothing in flight, and
+// subscribers that stopped reading their backlog.
+static void
+conn_expire (void)
+{
+    time_t now = time (NULL);
 
-    if (!gf_verify_peer_credentials (client))
+    for (uint32_t i = 0; i < g_conn_count; i++)
     {
-        close (client);
+        gf_ipc_conn_t *c = g_conns[i];
+        if (c->dead || now - c->last_active < GF_IPC_IDLE_TIMEOUT)
+            continue;
+        if (!c->topics || conn_has_output (c))
+            conn_close (c);
+    }
+}
+
+bool
+gf_ipc_server_accepts_subscriber (gf_ipc_handle_t handle)
+{
+    if (handle < 0)
         return false;
+
+    uint32_t subscribers = 0;
+    for (uint32_t i = 0; i < g_conn_count; i++)
+    {
+        if (!g_conns[i]->dead && g_conns[i]->topics)
+            subscribers++;
     }
+    return subscribers < GF_IPC_MAX_SUBSCRIBERS;
+}
 
-    struct timeval timeout = { 5, 0 };
-    setsockopt (client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
-    setsockopt (client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
+bool
+gf_ipc_server_subscribed (gf_ipc_handle_t handle, uint32_t topic)
+{
+    (void)handle;
+
+    for (uint32_t i = 0; i < g_conn_count; i++)
+    {
+        if (!g_conns[i]->dead && (g_conns[i]->topics & topic))
+            return true;
+    }
+    return false;
+}
+
+// Called from anywhere in the tick, possibly from a handler in the middle of
+// an epoll batch, so it only ever marks connections dead.
+void
+gf_ipc_server_publish (gf_ipc_handle_t handle, uint32_t topic, uint64_t key,
+                       const char *event)
+{
+    (void)handle;
+
+    for (uint32_t i = 0; i < g_conn_count; i++)
+    {
+        gf_ipc_conn_t *c = g_conns[i];
+        if (c->dead || !(c->topics & topic))
+            continue;
 
-    char buffer[GF_IPC_MSG_SIZE];
-    ssize_t n = recv (client, buffer, sizeof (buffer) - 1, 0);
+        gf_ipc_queue_push (c->queue, topic, key, event);
+        conn_flush (c);
+        conn_update_events (c);
+    }
+}
+
+void
+gf_ipc_server_flush (gf_ipc_handle_t handle)
+{
+    (void)handle;
 
-    if (n > 0)
+    for (uint32_t i = 0; i < g_conn_count; i++)
     {
-        buffer[n] = '\0';
+        conn_flush (g_conns[i]);
+        conn_update_events (g_conns[i]);
+    }
+    conn_reap ();
+}
 
-        gf_ipc_response_t response = { 0 };
-        response.status = GF_IPC_SUCCESS;
+bool
+gf_ipc_server_process (gf_ipc_handle_t handle, void *user_data)
+{
+    if (handle < 0 || g_epoll_fd < 0)
+        return false;
+
+    struct epoll_event events[GF_IPC_EPOLL_BATCH];
+    int count;
+    do
+        count = epoll_wait (g_epoll_fd, events, GF_IPC_EPOLL_BATCH, 0);
+    while (count < 0 && errno == EINTR);
+
+    bool handled = false;
+    for (int i = 0; i < count; i++)
+    {
+        gf_ipc_conn_t *c = events[i].data.ptr;
+        if (!c)
+        {
+            conn_accept ((int)handle);
+            continue;
+        }
 
-        gf_handle_client_message (buffer, &response, user_data);
+        if (c->dead)
+            continue;
+        if (!c->closing && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+            conn_read (c);
 
-        if (!send_all (client, &response, sizeof (response)))
-            perror ("send");
+        // Writing out replies can let requests held back by the output limit run
+        while (conn_dispatch (c, user_data))
+        {
+            handled = true;
+            conn_flush (c);
+        }
+        conn_flush (c);
+        conn_update_events (c);
     }
 
-    close (client);
+    conn_expire ();
+    conn_reap ();
+    return handled;
+}
+
+// Send exactly len bytes, retrying on EINTR and looping over partial writes.
+static bool
+send_all (int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    size_t sent = 0;
+
+    while (sent < len)
+    {
+        ssize_t n = send (fd, p + sent, len - sent, 0);
+        if (n > 0)
+        {
+            sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        return false; // error or peer closed
+    }
+    return true;
+}
+
+// Receive exactly len bytes, retrying on EINTR and looping over partial reads.
+static bool
+recv_all (int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    size_t got = 0;
+
+    while (got < len)
+    {
+        ssize_t n = recv (fd, p + got, len - got, 0);
+        if (n > 0)
+        {
+            got += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        return false; // error or peer closed
+    }
     return true;
 }
 
@@ -243,19 +702,74 @@ gf_ipc_client_send (gf_ipc_handle_t handle, const char *command,
     setsockopt (handle, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
     setsockopt (handle, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
 
+    // GUI worker threads send concurrently; each call keeps its own id
+    static uint32_t next_request_id;
+    gf_ipc_frame_t frame;
     size_t len = strlen (command);
-    if (!send_all (handle, command, len))
+    if (len > GF_IPC_MSG_SIZE - 1)
+        return false;
+
+    uint32_t request_id = __atomic_add_fetch (&next_request_id, 1, __ATOMIC_RELAXED);
+    memset (response, 0, sizeof (*response));
+    gf_ipc_frame_init (&frame, 0, request_id, (uint32_t)len);
+    if (!send_all (handle, &frame, sizeof (frame)) || !send_all (handle, command, len))
     {
         perror ("send");
         return false;
     }
 
-    if (!recv_all (handle, response, sizeof (*response)))
+    if (!recv_all (handle, &frame, sizeof (frame)))
     {
         perror ("recv");
         return false;
     }
 
+    if (!gf_ipc_frame_valid (&frame) || frame.request_id != request_id)
+    {
+        fprintf (stderr, "Unexpected reply; is the daemon older than this client?\n");
+        return false;
+    }
+
+    char *data = gf_ipc_response_reserve (response, frame.length);
+    if (!data || !recv_all (handle, data, frame.length))
+    {
+        perror ("recv");
+        gf_ipc_response_release (response);
+        return false;
+    }
+
+    response->status = (gf_ipc_status_t)frame.status;
+    return true;
+}
+
+bool
+gf_ipc_client_next_event (gf_ipc_handle_t handle, char *buffer, size_t size)
+{
+    if (handle < 0 || !buffer || size == 0)
+        return false;
+
+    // Events come when they come: no receive timeout on a subscription
+    struct timeval timeout = { 0, 0 };
+    setsockopt (handle, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+
+    gf_ipc_frame_t frame;
+    if (!recv_all (handle, &frame, sizeof (frame)) || !gf_ipc_frame_valid (&frame))
+        return false;
+
+    // Keep what fits and skip the rest, so the stream stays in step
+    size_t keep = frame.length < size - 1 ? frame.length : size - 1;
+    if (!recv_all (handle, buffer, keep))
+        return false;
+    buffer[keep] = '\0';
+
+    char discard[256];
+    for (size_t left = frame.length - keep; left > 0;)
+    {
+        size_t chunk = left < sizeof (discard) ? left : sizeof (discard);
+        if (!recv_all (handle, discard, chunk))
+            return false;
+        left -= chunk;
+    }
     return true;
 }
 
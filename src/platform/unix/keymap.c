@@ -1,5 +1,6 @@
 #include "../../utils/logger.h"
 #include "platform.h"
+#include "xcall.h"
 #include <X11/XKBlib.h>
 #include <X11/Xlib.h>
 #include <X11/extensions/XInput2.h>
@@ -48,7 +49,7 @@ gf_keymap_init (gf_platform_t *platform, gf_display_t display)
     XISetMask (mask_data, XI_RawKeyPress);
 
     XISelectEvents (display, DefaultRootWindow (display), &mask, 1);
-    XFlush (display);
+    gf_x_flush (display);
 
     data->keymap_initialized = true;
     GF_LOG_INFO (
@@ -94,8 +95,8 @@ _keymap_action_from_raw (gf_display_t display, XEvent *ev)
     Window root_ret, child_ret;
     int rx, ry, wx, wy;
     unsigned int mods = 0;
-    XQueryPointer (display, DefaultRootWindow (display), &root_ret, &child_ret, &rx, &ry,
-                   &wx, &wy, &mods);
+    gf_x_query_pointer (display, DefaultRootWindow (display), &root_ret, &child_ret, &rx,
+                        &ry, &wx, &wy, &mods);
 
     if ((mods & ~GF_LOCK_MASK) != GF_MOD_MASK)
         return GF_KEY_NONE;
@@ -107,6 +108,32 @@ _keymap_action_from_raw (gf_display_t display, XEvent *ev)
     return GF_KEY_NONE;
 }
 
+// Decode an XInput2 event pulled off the queue by the event dispatcher and
+// queue its action for the next keymap_poll. Returns false for events that do
+// not belong to the keymap.
+bool
+gf_keymap_handle_event (gf_platform_t *platform, XEvent *ev)
+{
+    gf_linux_platform_data_t *data = (gf_linux_platform_data_t *)platform->platform_data;
+    if (!data->keymap_initialized || ev->type != GenericEvent
+        || ev->xcookie.extension != data->xi_opcode)
+        return false;
+
+    if (!XGetEventData (data->display, &ev->xcookie))
+        return true;
+
+    gf_key_action_t action = GF_KEY_NONE;
+    if (ev->xcookie.evtype == XI_RawKeyPress)
+        action = _keymap_action_from_raw (data->display, ev);
+
+    XFreeEventData (data->display, &ev->xcookie);
+
+    if (action != GF_KEY_NONE && data->pending_key_count < GF_MAX_PENDING_KEYS)
+        data->pending_keys[data->pending_key_count++] = action;
+
+    return true;
+}
+
 gf_key_action_t
 gf_keymap_poll (gf_platform_t *platform, gf_display_t display)
 {
@@ -117,6 +144,15 @@ gf_keymap_poll (gf_platform_t *platform, gf_display_t display)
     if (!data->keymap_initialized)
         return GF_KEY_NONE;
 
+    if (data->pending_key_count > 0)
+    {
+        gf_key_action_t action = data->pending_keys[0];
+        data->pending_key_count--;
+        memmove (&data->pending_keys[0], &data->pending_keys[1],
+                 data->pending_key_count * sizeof (data->pending_keys[0]));
+        return action;
+    }
+
     XEvent ev;
     while (XCheckTypedEvent (display, GenericEvent, &ev))
     {
@@ -1,3 +1,5 @@
+#define GF_MEM_TAG GF_MEM_TAG_PLATFORM
+
 #include "../../utils/logger.h"
 #include "../../utils/memory.h"
 #include "../platform_compat.h"
@@ -11,6 +13,15 @@
 #include <string.h>
 #include <unistd.h>
 
+// Data of the initialized platform, for helpers that only receive a Display
+static gf_linux_platform_data_t *g_platform_data = NULL;
+
+gf_linux_platform_data_t *
+gf_platform_data_get_global (void)
+{
+    return g_platform_data;
+}
+
 static int
 gf_platform_error_handler (Display *display, XErrorEvent *error)
 {
@@ -33,11 +44,14 @@ _platform_bind_window_ops (gf_platform_t *p)
 {
     // --- Window Enumeration & Info ---
     p->window_enumerate = gf_platform_get_windows;
+    p->window_enumerate_all = gf_platform_get_windows_by_desktop;
+    p->window_changes = gf_event_get_changed_windows;
     p->window_get_focused = gf_window_get_focused;
     p->window_get_class = gf_window_get_class;
 
     // --- Window Geometry & State ---
     p->window_get_geometry = gf_window_get_geometry;
+    p->window_get_state = gf_window_get_state;
     p->window_is_excluded = gf_window_is_excluded;
     p->window_is_fullscreen = gf_window_is_fullscreen;
     p->window_is_hidden = NULL;
@@ -81,6 +95,10 @@ _platform_bind_system_ops (gf_platform_t *p)
     p->keymap_init = gf_keymap_init;
     p->keymap_cleanup = gf_keymap_cleanup;
     p->keymap_poll = gf_keymap_poll;
+
+    // --- Event Loop ---
+    p->event_fd = gf_event_fd;
+    p->event_dispatch = gf_event_dispatch;
 }
 
 gf_platform_t *
@@ -114,6 +132,13 @@ gf_platform_destroy (gf_platform_t *platform)
     if (!platform)
         return;
 
+    if (platform->platform_data)
+    {
+        if (g_platform_data == platform->platform_data)
+            g_platform_data = NULL;
+        gf_event_tracker_cleanup (platform->platform_data);
+        gf_prop_cache_cleanup (platform->platform_data);
+    }
     gf_free (platform->platform_data);
     gf_free (platform);
 }
@@ -149,16 +174,15 @@ gf_platform_init (gf_platform_t *platform, gf_display_t *display)
         return result;
     }
 
-    // Initialize borders array
-    data->borders = gf_calloc (GF_MAX_WINDOWS_PER_WORKSPACE * GF_MAX_WORKSPACES,
-                               sizeof (gf_border_t *));
-    if (!data->borders)
-    {
-        XCloseDisplay (*display);
-        *display = NULL;
-        return GF_ERROR_MEMORY_ALLOCATION;
-    }
+    // Wake the event loop on client list, focus and desktop changes
+    XSelectInput (*display, data->root_window, GF_ROOT_EVENT_MASK);
+    data->client_list_dirty = true;
+    g_platform_data = data;
+
+    // The borders array grows on demand in gf_border_add
+    data->borders = NULL;
     data->border_count = 0;
+    data->border_capacity = 0;
 
     GF_LOG_INFO ("Platform initialized successfully");
     return GF_SUCCESS;
@@ -176,8 +200,8 @@ gf_platform_cleanup (gf_display_t display, gf_platform_t *platform)
     {
         XSetIOErrorHandler (platform_io_error_handler);
 
-        XSync (display, False);
-        XFlush (display);
+        gf_x_sync (display, False);
+        gf_x_flush (display);
 
         // Restore dock if it was hidden (fallback if core cleanup didn't do it)
         gf_dock_restore (platform);
@@ -189,6 +213,10 @@ gf_platform_cleanup (gf_display_t display, gf_platform_t *platform)
         GF_LOG_INFO ("Platform cleaned up");
     }
 
+    if (g_platform_data == data)
+        g_platform_data = NULL;
+    gf_event_tracker_cleanup (data);
+    gf_prop_cache_cleanup (data);
     gf_free (data->borders);
     gf_free (data);
     // Prevent a double free: gf_platform_destroy also frees platform_data.
@@ -207,8 +235,9 @@ gf_platform_get_window_property (Display *display, Window window, Atom property,
     unsigned long bytes_after;
 
     int status
-        = XGetWindowProperty (display, window, property, 0, (~0L), False, type,
-                              &actual_type, &actual_format, nitems, &bytes_after, data);
+        = gf_x_get_window_property (display, window, property, 0, (~0L), False, type,
+                                    &actual_type, &actual_format, nitems, &bytes_after,
+                                    data);
 
     if (status != Success || !*data || *nitems == 0)
     {
@@ -247,6 +276,7 @@ gf_platform_send_client_message (Display *display, Window window, Atom message_t
     for (int i = 0; i < count && i < 5; i++)
         event.data.l[i] = data[i];
 
+    gf_prof_count (GF_PROF_CALL_CLIENT_MESSAGE, 1);
     Status ok = XSendEvent (display, DefaultRootWindow (display), False,
                             SubstructureRedirectMask | SubstructureNotifyMask,
                             (XEvent *)&event);
@@ -258,41 +288,18 @@ gf_platform_send_client_message (Display *display, Window window, Atom message_t
         return GF_ERROR_PLATFORM_ERROR;
     }
 
-    XFlush (display);
+    gf_x_flush (display);
     return GF_SUCCESS;
 }
 
 bool
-gf_platform_window_has_state (Display *display, Window window, Atom state)
+gf_platform_window_has_state (Display *display, Window window, uint32_t states)
 {
     if (!display)
         return false;
 
-    unsigned char *data = NULL;
-    unsigned long nitems = 0;
-    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
-
-    if (gf_platform_get_window_property (display, window, atoms->net_wm_state, XA_ATOM,
-                                         &data, &nitems)
-        != GF_SUCCESS)
-    {
-        return false;
-    }
-
-    Atom *states = (Atom *)data;
-    bool found = false;
-
-    for (unsigned long i = 0; i < nitems; i++)
-    {
-        if (states[i] == state)
-        {
-            found = true;
-            break;
-        }
-    }
-
-    XFree (data);
-    return found;
+    const gf_window_props_t *props = gf_prop_cache_get (display, window, GF_PROPS_STATE);
+    return props && gf_window_props_has_state (props, states);
 }
 
 gf_err_t
@@ -306,40 +313,18 @@ gf_platform_get_frame_extents (Display *dpy, Window win, int *left, int *right,
     if (is_csd)
         *is_csd = false;
 
-    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
-
-    Atom candidates[] = {
-        atoms->gtk_frame_extents, // GTK CSD
-        atoms->net_frame_extents, // Standard
-        atoms->qt_frame_extents   // KDE Qt apps
-    };
+    // Served from the property cache; refetched only after the extent atoms change
+    const gf_window_props_t *props = gf_prop_cache_get (dpy, win, GF_PROPS_FRAME);
+    if (!props || !props->has_frame_extents)
+        return GF_ERROR_PLATFORM_ERROR;
 
-    for (size_t i = 0; i < 3; i++)
-    {
-        unsigned char *data = NULL;
-        unsigned long nitems = 0;
-
-        if (gf_platform_get_window_property (dpy, win, candidates[i], XA_CARDINAL, &data,
-                                             &nitems)
-                == GF_SUCCESS
-            && data && nitems >= 4)
-        {
-            unsigned long *ext = (unsigned long *)data;
-            *left = ext[0];
-            *right = ext[1];
-            *top = ext[2];
-            *bottom = ext[3];
-
-            if (is_csd)
-                *is_csd = (candidates[i] == atoms->gtk_frame_extents);
-
-            XFree (data);
-            return GF_SUCCESS;
-        }
-
-        if (data)
-            XFree (data);
-    }
+    *left = props->frame_extents[0];
+    *right = props->frame_extents[1];
+    *top = props->frame_extents[2];
+    *bottom = props->frame_extents[3];
+    if (is_csd)
+        *is_csd = props->frame_is_csd;
 
-    return GF_ERROR_PLATFORM_ERROR;
+    return GF_SUCCESS;
 }
+
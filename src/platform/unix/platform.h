@@ -10,6 +10,37 @@
 // Border structure
 // Linux platform data
 #define GF_MAX_DOCK_WINDOWS 8
+#define GF_MAX_PENDING_KEYS 8
+
+// Core events selected on the root window so the event loop wakes up when the
+// EWMH client list, focus or desktop layout changes.
+#define GF_ROOT_EVENT_MASK PropertyChangeMask
+
+// Events selected on every managed client so changes to its state, type,
+// desktop or geometry mark it for a refresh.
+#define GF_CLIENT_EVENT_MASK (StructureNotifyMask | PropertyChangeMask)
+
+// Desktop reported by query_window_info for windows on all desktops.
+#define GF_DESKTOP_STICKY ((gf_ws_id_t)-1)
+
+// Most desktops enumerate_all buckets, whatever _NET_NUMBER_OF_DESKTOPS says.
+#define GF_DESKTOP_LIMIT 1024
+
+// Open-addressing index from Window to a slot in some array (see winmap.c)
+typedef struct
+{
+    uint32_t *buckets;
+    uint32_t capacity;
+} gf_window_map_t;
+
+// Windows in no particular order, indexed for membership tests
+typedef struct
+{
+    Window *items;
+    uint32_t count;
+    uint32_t capacity;
+    gf_window_map_t map;
+} gf_window_set_t;
 
 typedef struct
 {
@@ -18,8 +49,9 @@ typedef struct
     Window root_window;
     Display *display;
 
-    gf_border_t **borders;
+    gf_border_t **borders; // grown by gf_border_add
     int border_count;
+    int border_capacity;
 
     gf_monitor_t monitors[GF_MAX_MONITORS];
     uint32_t enumerated_monitor_count;
@@ -32,6 +64,22 @@ typedef struct
     // Keymap state
     bool keymap_initialized;
     int xi_opcode;
+
+    // Key actions decoded by the event dispatcher, consumed by keymap_poll
+    gf_key_action_t pending_keys[GF_MAX_PENDING_KEYS];
+    uint32_t pending_key_count;
+
+    // Incremental client tracking: clients with GF_CLIENT_EVENT_MASK selected,
+    // and the subset that changed since the last window_changes call
+    gf_window_set_t tracked_clients;
+    gf_window_set_t dirty_clients;
+    bool client_list_dirty;
+
+    // Per-window property cache (see cache.c)
+    struct gf_prop_cache_entry *prop_cache;
+    uint32_t prop_cache_count;
+    uint32_t prop_cache_capacity;
+    gf_window_map_t prop_cache_map;
 } gf_linux_platform_data_t;
 
 // Platform interface (Linux implementation)
@@ -41,8 +89,11 @@ void gf_platform_destroy (gf_platform_t *platform);
 // Internal platform functions (declared here for use in other linux files)
 gf_err_t gf_platform_init (gf_platform_t *platform, gf_display_t *display);
 void gf_platform_cleanup (gf_display_t display, gf_platform_t *platform);
+gf_linux_platform_data_t *gf_platform_data_get_global (void);
 gf_err_t gf_platform_get_windows (gf_display_t display, gf_ws_id_t *workspace_id,
                                   gf_win_info_t **windows, uint32_t *count);
+gf_err_t gf_platform_get_windows_by_desktop (gf_display_t display,
+                                            gf_win_buckets_t *buckets);
 gf_err_t gf_window_set_geometry (gf_display_t display, gf_handle_t window,
                                  const gf_rect_t *geometry, gf_geom_flags_t flags,
                                  gf_config_t *cfg);
@@ -80,7 +131,8 @@ gf_err_t gf_platform_get_window_property (Display *display, Window window, Atom
                                           unsigned long *nitems);
 gf_err_t gf_platform_send_client_message (Display *display, Window window,
                                           Atom message_type, long *data, int count);
-bool gf_platform_window_has_state (Display *display, Window window, Atom state);
+// `states` is a set of gf_net_state_t bits; true when all of them are set
+bool gf_platform_window_has_state (Display *display, Window window, uint32_t states);
 bool gf_window_is_minimized (gf_display_t display, gf_handle_t window);
 void gf_border_update (gf_platform_t *platform, const gf_config_t *config);
 void gf_border_add (gf_platform_t *platform, gf_handle_t window, gf_color_t color,
@@ -98,5 +150,13 @@ void gf_dock_restore (gf_platform_t *platform);
 gf_err_t gf_keymap_init (gf_platform_t *platform, gf_display_t display);
 void gf_keymap_cleanup (gf_platform_t *platform);
 gf_key_action_t gf_keymap_poll (gf_platform_t *platform, gf_display_t display);
+bool gf_keymap_handle_event (gf_platform_t *platform, XEvent *ev);
+
+// --- Event Loop ---
+int gf_event_fd (gf_platform_t *platform);
+bool gf_event_dispatch (gf_platform_t *platform);
+gf_err_t gf_event_get_changed_windows (gf_platform_t *platform, gf_win_info_t **windows,
+                                       uint32_t *count);
+void gf_event_tracker_cleanup (gf_linux_platform_data_t *data);
 
 #endif // GF_PLATFORM_LINUX_H
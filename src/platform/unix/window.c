@@ -10,26 +10,6 @@
 #include <string.h>
 #include <time.h>
 
-// Shrink the over-allocated window list to its final size, or free it if empty.
-static gf_err_t
-_finalize_window_list (gf_win_info_t *list, uint32_t count, gf_win_info_t **out)
-{
-    if (count == 0)
-    {
-        gf_free (list);
-        *out = NULL;
-        return GF_SUCCESS;
-    }
-
-    *out = gf_realloc (list, count * sizeof (gf_win_info_t));
-    if (!*out)
-    {
-        gf_free (list);
-        return GF_ERROR_MEMORY_ALLOCATION;
-    }
-    return GF_SUCCESS;
-}
-
 gf_err_t
 gf_platform_get_windows (gf_display_t display, gf_ws_id_t *workspace_id,
                          gf_win_info_t **windows, uint32_t *count)
@@ -53,31 +33,107 @@ gf_platform_get_windows (gf_display_t display, gf_ws_id_t *workspace_id,
     }
 
     Window *window_list = (Window *)data;
-    gf_win_info_t *filtered_windows = gf_malloc (nitems * sizeof (gf_win_info_t));
+    gf_win_info_t *filtered_windows = gf_scratch_alloc (nitems * sizeof (gf_win_info_t));
     if (!filtered_windows)
     {
         XFree (data);
         return GF_ERROR_MEMORY_ALLOCATION;
     }
 
-    uint32_t filtered_count = 0;
+    uint32_t filtered_count = query_window_infos (display, window_list, (uint32_t)nitems,
+                                                  workspace_id, filtered_windows);
+
+    XFree (data);
+
+    *windows = filtered_count ? filtered_windows : NULL;
+    *count = filtered_count;
+    return GF_SUCCESS;
+}
+
+// Bucket index for a desktop reported by query_window_info; sticky windows
+// (and anything out of range) land in the trailing bucket.
+static uint32_t
+_desktop_bucket (gf_ws_id_t desktop, uint32_t desktop_count)
+{
+    if (desktop == GF_DESKTOP_STICKY || desktop < 0 || (uint32_t)desktop >= desktop_count)
+        return desktop_count;
+    return (uint32_t)desktop;
+}
+
+gf_err_t
+gf_platform_get_windows_by_desktop (gf_display_t display, gf_win_buckets_t *buckets)
+{
+    if (!display || !buckets)
+        return GF_ERROR_INVALID_PARAMETER;
+
+    memset (buckets, 0, sizeof (*buckets));
+
+    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
+    Window root = DefaultRootWindow (display);
+
+    unsigned char *data = NULL;
+    unsigned long nitems = 0;
+
+    if (gf_platform_get_window_property (display, root, atoms->net_client_list,
+                                         XA_WINDOW, &data, &nitems)
+        != GF_SUCCESS)
+    {
+        return GF_SUCCESS; // No windows is not an error
+    }
 
-    for (unsigned long i = 0; i < nitems; i++)
+    Window *window_list = (Window *)data;
+    gf_win_info_t *found = gf_scratch_alloc (nitems * sizeof (gf_win_info_t));
+    gf_win_info_t *sorted = gf_scratch_alloc (nitems * sizeof (gf_win_info_t));
+    if (!found || !sorted)
     {
-        gf_win_info_t info;
-        if (query_window_info (display, window_list[i], atoms, workspace_id, &info))
-        {
-            filtered_windows[filtered_count++] = info;
-        }
+        XFree (data);
+        return GF_ERROR_MEMORY_ALLOCATION;
     }
 
+    // One pass over the client list; each window reports its own desktop.
+    uint32_t found_count
+        = query_window_infos (display, window_list, (uint32_t)nitems, NULL, found);
     XFree (data);
 
-    gf_err_t fin = _finalize_window_list (filtered_windows, filtered_count, windows);
-    if (fin != GF_SUCCESS)
-        return fin;
+    // _NET_WM_DESKTOP is whatever the client wrote, so only desktops the WM
+    // says exist get a bucket; anything else joins the sticky windows.
+    uint32_t desktop_limit = gf_workspace_get_count (display);
+    if (desktop_limit > GF_DESKTOP_LIMIT)
+        desktop_limit = GF_DESKTOP_LIMIT;
 
-    *count = filtered_count;
+    uint32_t desktop_count = 0;
+    for (uint32_t i = 0; i < found_count; i++)
+    {
+        gf_ws_id_t desktop = found[i].workspace_id;
+        if (desktop >= 0 && (uint32_t)desktop < desktop_limit
+            && (uint32_t)desktop + 1 > desktop_count)
+            desktop_count = (uint32_t)desktop + 1;
+    }
+
+    uint32_t *offsets = gf_scratch_calloc (desktop_count + 2, sizeof (uint32_t));
+    if (!offsets)
+        return GF_ERROR_MEMORY_ALLOCATION;
+
+    // Counting sort by desktop keeps client-list order within each bucket.
+    for (uint32_t i = 0; i < found_count; i++)
+        offsets[_desktop_bucket (found[i].workspace_id, desktop_count) + 1]++;
+
+    for (uint32_t b = 0; b <= desktop_count; b++)
+        offsets[b + 1] += offsets[b];
+
+    uint32_t *cursor = gf_scratch_alloc ((desktop_count + 1) * sizeof (uint32_t));
+    if (!cursor)
+        return GF_ERROR_MEMORY_ALLOCATION;
+    memcpy (cursor, offsets, (desktop_count + 1) * sizeof (uint32_t));
+
+    for (uint32_t i = 0; i < found_count; i++)
+        sorted[cursor[_desktop_bucket (found[i].workspace_id, desktop_count)]++]
+            = found[i];
+
+    buckets->items = sorted;
+    buckets->count = found_count;
+    buckets->offsets = offsets;
+    buckets->desktop_count = desktop_count;
     return GF_SUCCESS;
 }
 
@@ -87,25 +143,13 @@ gf_window_get_geometry (gf_display_t display, gf_handle_t window, gf_rect_t *geo
     if (!display || !geometry)
         return GF_ERROR_INVALID_PARAMETER;
 
-    XWindowAttributes attrs;
-    if (!XGetWindowAttributes (display, window, &attrs))
-    {
+    // Root-relative geometry, kept current from ConfigureNotify by the cache
+    const gf_window_props_t *props
+        = gf_prop_cache_get (display, window, GF_PROPS_GEOMETRY);
+    if (!props || !props->has_geometry)
         return GF_ERROR_PLATFORM_ERROR;
-    }
-
-    // XGetWindowAttributes reports parent-relative x/y; translate to root
-    // coordinates so callers get absolute geometry.
-    Window root = DefaultRootWindow (display);
-    int abs_x, abs_y;
-    Window child;
-    if (!XTranslateCoordinates (display, window, root, 0, 0, &abs_x, &abs_y, &child))
-        return GF_ERROR_PLATFORM_ERROR;
-
-    geometry->x = abs_x;
-    geometry->y = abs_y;
-    geometry->width = attrs.width;
-    geometry->height = attrs.height;
 
+    *geometry = props->geometry;
     return GF_SUCCESS;
 }
 
@@ -115,27 +159,27 @@ gf_window_is_valid (gf_display_t display, gf_handle_t window)
     if (!display)
         return false;
 
+    // A cached window is alive until its DestroyNotify drops the entry
+    if (gf_prop_cache_peek (window, 0))
+        return true;
+
     XWindowAttributes attrs;
-    return XGetWindowAttributes (display, window, &attrs) != 0;
+    return gf_x_get_window_attributes (display, window, &attrs) != 0;
 }
 
 bool
 window_is_border_excluded (gf_display_t display, gf_handle_t window)
 {
+    const gf_window_props_t *props = gf_prop_cache_get (
+        display, window, GF_PROPS_CLASS | GF_PROPS_STATE | GF_PROPS_TYPE);
+    if (!props)
+        return false;
+
     // The GUI and its dialogs/popups share the app's WM_CLASS, so window_is_self
     // already excludes them — the border is clipped around them, not drawn over.
-    if (window_is_self (display, window))
-        return true;
-
-    if (window_is_app_exception (display, window))
-        return true;
-
-    if (window_has_excluded_state (display, window))
-        return true;
-    if (window_has_excluded_type (display, window))
-        return true;
-
-    return false;
+    return gf_window_props_is_self (props) || gf_window_props_is_app_exception (props)
+           || gf_window_props_has_excluded_state (props)
+           || gf_window_props_has_excluded_type (props);
 }
 
 bool
@@ -147,14 +191,15 @@ window_is_self (gf_display_t display, gf_handle_t window)
     // Check res_name/res_class individually (not via gf_window_get_class,
     // which concatenates both for rule matching) so this exact-identity
     // check can't be thrown off by whatever the other half contains.
+    const gf_window_props_t *cached = gf_prop_cache_peek (window, GF_PROPS_CLASS);
+    if (cached)
+        return gf_window_props_is_self (cached);
+
     XClassHint class_hint = { NULL, NULL };
-    if (!XGetClassHint (display, window, &class_hint))
+    if (!gf_x_get_class_hint (display, window, &class_hint))
         return false;
 
-    bool match
-        = (class_hint.res_name && strcmp (class_hint.res_name, "gridflux-gui") == 0)
-          || (class_hint.res_class
-              && strstr (class_hint.res_class, "com.gridflux.gui") != NULL);
+    bool match = window_class_is_self (class_hint.res_name, class_hint.res_class);
 
     if (class_hint.res_name)
         XFree (class_hint.res_name);
@@ -170,38 +215,17 @@ gf_window_is_excluded (gf_display_t display, gf_handle_t window)
     if (!display || window == None)
         return true;
 
-    if (window_is_self (display, window))
-        return true;
-
-    if (window_is_app_exception (display, window))
-        return true;
-
-    // Exclude fullscreen OR maximized NORMAL windows
-    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
-    bool is_fullscreen
-        = gf_platform_window_has_state (display, window, atoms->net_wm_state_fullscreen);
-
-    if (window_has_type (display, window, atoms->net_wm_window_type_normal)
-        && (is_fullscreen))
-    {
-        return true;
-    }
-
-    if (window_has_excluded_state (display, window))
-        return true;
-
-    if (window_has_excluded_type (display, window))
-        return true;
-
-    return false;
+    // One cached snapshot answers the class, state and type checks together
+    const gf_window_props_t *props = gf_prop_cache_get (
+        display, window, GF_PROPS_CLASS | GF_PROPS_STATE | GF_PROPS_TYPE);
+    return props && gf_window_props_is_excluded (props);
 }
 
 bool
 gf_window_is_fullscreen (gf_display_t display, gf_handle_t window)
 {
-    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
     return gf_platform_window_has_state (display, (Window)window,
-                                         atoms->net_wm_state_fullscreen);
+                                         GF_NET_STATE_FULLSCREEN);
 }
 
 // Adjust the target rect for window frame extents so the visible content lands on
@@ -287,9 +311,9 @@ gf_window_get_focused (Display *dpy)
     unsigned char *data = NULL;
     Window win = None;
 
-    if (XGetWindowProperty (dpy, DefaultRootWindow (dpy), atoms->net_active_window, 0, 1,
-                            False, XA_WINDOW, &actual, &format, &nitems, &bytes_after,
-                            &data)
+    if (gf_x_get_window_property (dpy, DefaultRootWindow (dpy), atoms->net_active_window,
+                                  0, 1, False, XA_WINDOW, &actual, &format, &nitems,
+                                  &bytes_after, &data)
             == Success
         && data && nitems > 0)
     {
@@ -301,7 +325,7 @@ gf_window_get_focused (Display *dpy)
         return None;
 
     XWindowAttributes attr;
-    if (XGetWindowAttributes (dpy, win, &attr) == 0)
+    if (gf_x_get_window_attributes (dpy, win, &attr) == 0)
     {
         GF_LOG_DEBUG ("Focused window %lu is invalid", win);
         return None;
@@ -325,7 +349,7 @@ gf_window_minimize (gf_display_t display, gf_handle_t window)
 
     // Verify window exists
     XWindowAttributes attr;
-    if (XGetWindowAttributes (display, window, &attr) == 0)
+    if (gf_x_get_window_attributes (display, window, &attr) == 0)
     {
         GF_LOG_WARN ("Cannot minimize invalid window: %lu", window);
         return GF_ERROR_PLATFORM_ERROR;
@@ -334,7 +358,7 @@ gf_window_minimize (gf_display_t display, gf_handle_t window)
     if (XIconifyWindow (display, window, DefaultScreen (display)) == 0)
         return GF_ERROR_PLATFORM_ERROR;
 
-    XFlush (display);
+    gf_x_flush (display);
     return GF_SUCCESS;
 }
 
@@ -345,7 +369,7 @@ gf_window_unminimize (gf_display_t display, gf_handle_t window)
         return GF_ERROR_INVALID_PARAMETER;
 
     XWindowAttributes attr;
-    if (XGetWindowAttributes (display, window, &attr) == 0)
+    if (gf_x_get_window_attributes (display, window, &attr) == 0)
     {
         GF_LOG_WARN ("Cannot unminimize invalid window: %lu", window);
         return GF_ERROR_PLATFORM_ERROR;
@@ -355,7 +379,7 @@ gf_window_unminimize (gf_display_t display, gf_handle_t window)
     // re-map before any focus requests can succeed. XSync ensures the WM has
     // processed the map before we later attempt to set input focus.
     XMapRaised (display, window);
-    XSync (display, False);
+    gf_x_sync (display, False);
 
     gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
     if (!atoms)
@@ -381,12 +405,12 @@ gf_window_unminimize (gf_display_t display, gf_handle_t window)
     // Force focus transfer — _NET_ACTIVE_WINDOW is advisory, this is required so
     // gf_wm_event sees the correct focused window. Only focus once the window is
     // actually viewable: XSetInputFocus on an unmapped window yields BadMatch.
-    if (XGetWindowAttributes (display, window, &attr) != 0
+    if (gf_x_get_window_attributes (display, window, &attr) != 0
         && attr.map_state == IsViewable)
     {
         XSetInputFocus (display, window, RevertToPointerRoot, CurrentTime);
     }
-    XFlush (display);
+    gf_x_flush (display);
 
     return GF_SUCCESS;
 }
@@ -399,23 +423,18 @@ gf_window_get_class (gf_display_t dpy, gf_handle_t win, char *buffer, size_t buf
 
     buffer[0] = '\0';
 
-    XClassHint class_hint = { NULL, NULL };
-    if (!XGetClassHint (dpy, win, &class_hint))
+    const gf_window_props_t *props = gf_prop_cache_get (dpy, win, GF_PROPS_CLASS);
+    if (!props || !props->has_class)
         return;
 
     // WM_CLASS has two parts (instance, class); which one carries the
     // identifier a rule targets varies by app (e.g. GTK apps commonly leave
     // the reverse-DNS id, like "org.gnome.Nautilus", only in res_class).
     // Concatenate both so rule matching can find either.
-    const char *name = class_hint.res_name ? class_hint.res_name : "";
-    const char *cls = class_hint.res_class ? class_hint.res_class : "";
+    const char *name = props->res_name;
+    const char *cls = props->res_class;
     const char *sep = (name[0] && cls[0]) ? " " : "";
     snprintf (buffer, bufsize, "%s%s%s", name, sep, cls);
-
-    if (class_hint.res_name)
-        XFree (class_hint.res_name);
-    if (class_hint.res_class)
-        XFree (class_hint.res_class);
 }
 
 bool
@@ -424,14 +443,7 @@ gf_window_is_minimized (gf_display_t display, gf_handle_t window)
     if (!display || window == None)
         return false;
 
-    if (!gf_window_is_valid (display, window))
-        return false;
-
-    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
-    if (!atoms)
-        return false;
-
-    return gf_platform_window_has_state (display, window, atoms->net_wm_state_hidden);
+    return gf_platform_window_has_state (display, window, GF_NET_STATE_HIDDEN);
 }
 
 bool
@@ -440,15 +452,33 @@ gf_window_is_maximized (gf_display_t display, gf_handle_t window)
     if (!display || window == None)
         return false;
 
-    if (!gf_window_is_valid (display, window))
-        return false;
+    return gf_platform_window_has_state (display, window, GF_NET_STATE_MAXIMIZED);
+}
 
-    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
-    if (!atoms)
-        return false;
+// One snapshot of everything the core asks about a window; the cached
+// state and type bits answer all of it without a round-trip.
+gf_err_t
+gf_window_get_state (gf_display_t display, gf_handle_t window, uint32_t *state)
+{
+    if (!display || window == None || !state)
+        return GF_ERROR_INVALID_PARAMETER;
+
+    *state = 0;
 
-    return gf_platform_window_has_state (display, window,
-                                         atoms->net_wm_state_maximized_vert)
-           && gf_platform_window_has_state (display, window,
-                                            atoms->net_wm_state_maximized_horz);
+    const gf_window_props_t *props = gf_prop_cache_get (
+        display, window, GF_PROPS_CLASS | GF_PROPS_STATE | GF_PROPS_TYPE);
+    if (!props)
+        return GF_ERROR_WINDOW_NOT_FOUND;
+
+    *state = GF_WIN_STATE_VALID;
+    if (gf_window_props_has_state (props, GF_NET_STATE_MAXIMIZED))
+        *state |= GF_WIN_STATE_MAXIMIZED;
+    if (gf_window_props_has_state (props, GF_NET_STATE_HIDDEN))
+        *state |= GF_WIN_STATE_MINIMIZED;
+    if (gf_window_props_has_state (props, GF_NET_STATE_FULLSCREEN))
+        *state |= GF_WIN_STATE_FULLSCREEN;
+    if (gf_window_props_is_excluded (props))
+        *state |= GF_WIN_STATE_EXCLUDED;
+
+    return GF_SUCCESS;
 }
@@ -0,0 +1,154 @@
+#define GF_MEM_TAG GF_MEM_TAG_PLATFORM
+
+#include "../../utils/memory.h"
+#include "internal.h"
+#include <string.h>
+
+/*
+ * Index from Window to a slot in an array the caller owns, using the same
+ * open-addressing scheme as gf_win_list_t. Each slot is `stride` bytes and
+ * starts with its Window. A bucket holds slot + 1, so zero means empty.
+ * Removal shifts the rest of the probe chain back instead of leaving
+ * tombstones, so lookups never degrade as clients come and go.
+ */
+
+static Window
+_winmap_key (const void *slots, size_t stride, uint32_t slot)
+{
+    Window w;
+    memcpy (&w, (const char *)slots + (size_t)slot * stride, sizeof (w));
+    return w;
+}
+
+static uint32_t
+_winmap_hash (Window w, uint32_t mask)
+{
+    // Fibonacci hashing; X ids are sequential in their low bits, so mix the top
+    uint64_t h = (uint64_t)w * 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(h >> 32) & mask;
+}
+
+static void
+_winmap_insert (gf_window_map_t *map, Window w, uint32_t slot)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t b = _winmap_hash (w, mask);
+
+    while (map->buckets[b] != 0)
+        b = (b + 1) & mask;
+
+    map->buckets[b] = slot + 1;
+}
+
+// Bucket pointing at slot, or map->capacity if the slot is not indexed.
+static uint32_t
+_winmap_bucket (const gf_window_map_t *map, Window w, uint32_t slot)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t b = _winmap_hash (w, mask);
+
+    for (uint32_t probes = 0; map->buckets[b] != 0 && probes < map->capacity; probes++)
+    {
+        if (map->buckets[b] == slot + 1)
+            return b;
+        b = (b + 1) & mask;
+    }
+    return map->capacity;
+}
+
+int
+gf_window_map_find (const gf_window_map_t *map, const void *slots, size_t stride,
+                    uint32_t count, Window w)
+{
+    if (!map->buckets)
+        return -1;
+
+    uint32_t mask = map->capacity - 1;
+    uint32_t b = _winmap_hash (w, mask);
+
+    for (uint32_t probes = 0; map->buckets[b] != 0 && probes < map->capacity; probes++)
+    {
+        uint32_t slot = map->buckets[b] - 1;
+        if (slot < count && _winmap_key (slots, stride, slot) == w)
+            return (int)slot;
+        b = (b + 1) & mask;
+    }
+    return -1;
+}
+
+bool
+gf_window_map_add (gf_window_map_t *map, const void *slots, size_t stride,
+                   uint32_t slot)
+{
+    // Keep the load under one half so probe chains stay short
+    if (!map->buckets || (slot + 1) * 2 > map->capacity)
+    {
+        uint32_t capacity = map->capacity ? map->capacity : 64;
+        while ((slot + 1) * 2 > capacity)
+            capacity *= 2;
+
+        uint32_t *buckets = gf_calloc (capacity, sizeof (uint32_t));
+        if (!buckets)
+            return false;
+
+        gf_free (map->buckets);
+        map->buckets = buckets;
+        map->capacity = capacity;
+        for (uint32_t i = 0; i < slot; i++)
+            _winmap_insert (map, _winmap_key (slots, stride, i), i);
+    }
+
+    _winmap_insert (map, _winmap_key (slots, stride, slot), slot);
+    return true;
+}
+
+void
+gf_window_map_remove (gf_window_map_t *map, const void *slots, size_t stride,
+                      uint32_t count, uint32_t slot)
+{
+    if (!map->buckets)
+        return;
+
+    uint32_t mask = map->capacity - 1;
+    uint32_t hole = _winmap_bucket (map, _winmap_key (slots, stride, slot), slot);
+    if (hole == map->capacity)
+        return;
+
+    // An entry further down the chain moves into the hole unless its home
+    // bucket lies between the hole and where it sits now
+    for (uint32_t b = (hole + 1) & mask; map->buckets[b] != 0; b = (b + 1) & mask)
+    {
+        Window w = _winmap_key (slots, stride, map->buckets[b] - 1);
+        uint32_t home = _winmap_hash (w, mask);
+        if (((b - home) & mask) >= ((b - hole) & mask))
+        {
+            map->buckets[hole] = map->buckets[b];
+            hole = b;
+        }
+    }
+    map->buckets[hole] = 0;
+
+    // The caller moves the last slot into the freed one
+    uint32_t last = count - 1;
+    if (slot != last)
+    {
+        uint32_t b = _winmap_bucket (map, _winmap_key (slots, stride, last), last);
+        if (b != map->capacity)
+            map->buckets[b] = slot + 1;
+    }
+}
+
+void
+gf_window_map_clear (gf_window_map_t *map)
+{
+    if (map->buckets)
+        memset (map->buckets, 0, map->capacity * sizeof (uint32_t));
+}
+
+void
+gf_window_map_free (gf_window_map_t *map)
+{
+    gf_free (map->buckets);
+    map->buckets = NULL;
+    map->capacity = 0;
+}
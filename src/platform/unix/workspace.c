@@ -73,9 +73,9 @@ _get_global_struts (Display *dpy, Window root, gf_platform_atoms_t *atoms,
 
     *panel_left = *panel_right = *panel_top = *panel_bottom = 0;
 
-    if (XGetWindowProperty (dpy, root, atoms->net_client_list, 0, 4096, False, XA_WINDOW,
-                            &actual_type, &actual_format, &clients_count, &bytes_after,
-                            &clients_data)
+    if (gf_x_get_window_property (dpy, root, atoms->net_client_list, 0, 4096, False,
+                                  XA_WINDOW, &actual_type, &actual_format, &clients_count,
+                                  &bytes_after, &clients_data)
             != Success
         || !clients_data)
         return;
@@ -215,7 +215,7 @@ gf_screen_get_bounds (gf_display_t dpy, gf_rect_t *bounds)
     if (!dpy || !bounds)
         return GF_ERROR_INVALID_PARAMETER;
 
-    XSync (dpy, False);
+    gf_x_sync (dpy, False);
     int screen = DefaultScreen (dpy);
     Window root = DefaultRootWindow (dpy);
     Screen *scr = ScreenOfDisplay (dpy, screen);
@@ -253,10 +253,11 @@ gf_monitor_get_count (gf_platform_t *platform)
     Display *dpy = data->display;
 
     int event_base, error_base;
-    if (XineramaQueryExtension (dpy, &event_base, &error_base) && XineramaIsActive (dpy))
+    if (XineramaQueryExtension (dpy, &event_base, &error_base)
+        && gf_x_xinerama_is_active (dpy))
     {
         int count = 0;
-        XineramaScreenInfo *screens = XineramaQueryScreens (dpy, &count);
+        XineramaScreenInfo *screens = gf_x_xinerama_query_screens (dpy, &count);
         if (screens)
         {
             XFree (screens);
@@ -277,10 +278,11 @@ gf_monitor_enumerate (gf_platform_t *platform, gf_monitor_t *monitors, uint32_t
     Display *dpy = data->display;
 
     int event_base, error_base;
-    if (XineramaQueryExtension (dpy, &event_base, &error_base) && XineramaIsActive (dpy))
+    if (XineramaQueryExtension (dpy, &event_base, &error_base)
+        && gf_x_xinerama_is_active (dpy))
     {
         int screen_count = 0;
-        XineramaScreenInfo *screens = XineramaQueryScreens (dpy, &screen_count);
+        XineramaScreenInfo *screens = gf_x_xinerama_query_screens (dpy, &screen_count);
 
         if (screens)
         {
@@ -329,12 +331,12 @@ gf_monitor_from_window (gf_platform_t *platform, gf_handle_t window)
     Display *dpy = data->display;
 
     XWindowAttributes attrs;
-    if (XGetWindowAttributes (dpy, (Window)window, &attrs))
+    if (gf_x_get_window_attributes (dpy, (Window)window, &attrs))
     {
         int x, y;
         Window child;
-        XTranslateCoordinates (dpy, (Window)window, DefaultRootWindow (dpy), 0, 0, &x, &y,
-                               &child);
+        gf_x_translate_coordinates (dpy, (Window)window, DefaultRootWindow (dpy), 0, 0,
+                                    &x, &y, &child);
 
         // Center point check
         int cx = x + attrs.width / 2;
@@ -360,7 +362,7 @@ _xinerama_monitor_bounds (gf_display_t display, gf_monitor_id_t monitor_id,
                           gf_rect_t *bounds)
 {
     int screen_count = 0;
-    XineramaScreenInfo *screens = XineramaQueryScreens (display, &screen_count);
+    XineramaScreenInfo *screens = gf_x_xinerama_query_screens (display, &screen_count);
     if (!screens)
         return false;
 
@@ -491,7 +493,7 @@ gf_screen_get_bounds_for_monitor (gf_display_t display, gf_monitor_id_t monitor_
 
     // Force X server roundtrip to ensure we see the latest property changes
     // (like _NET_WORKAREA) after the dock visibility changes.
-    XSync (display, False);
+    gf_x_sync (display, False);
 
     // Get physical geometry from Xinerama; fall back to single-screen bounds.
     if (!_xinerama_monitor_bounds (display, monitor_id, bounds))
@@ -0,0 +1,104 @@
+#ifndef GF_PLATFORM_UNIX_XCALL_H
+#define GF_PLATFORM_UNIX_XCALL_H
+
+#include "../../utils/profiler.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/Xinerama.h>
+
+/*
+ * Counted wrappers for the blocking Xlib calls issued by this backend. Each
+ * one charges the call to the current profiler scope so `stats` can show how
+ * much server traffic a phase generates. Use these instead of the raw calls.
+ */
+
+static inline Status
+gf_x_get_window_attributes (Display *dpy, Window w, XWindowAttributes *attrs)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    return XGetWindowAttributes (dpy, w, attrs);
+}
+
+static inline Bool
+gf_x_translate_coordinates (Display *dpy, Window src, Window dst, int src_x, int src_y,
+                            int *dst_x, int *dst_y, Window *child)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    return XTranslateCoordinates (dpy, src, dst, src_x, src_y, dst_x, dst_y, child);
+}
+
+static inline Status
+gf_x_query_tree (Display *dpy, Window w, Window *root, Window *parent, Window **children,
+                 unsigned int *nchildren)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    return XQueryTree (dpy, w, root, parent, children, nchildren);
+}
+
+static inline Bool
+gf_x_query_pointer (Display *dpy, Window w, Window *root, Window *child, int *root_x,
+                    int *root_y, int *win_x, int *win_y, unsigned int *mask)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    return XQueryPointer (dpy, w, root, child, root_x, root_y, win_x, win_y, mask);
+}
+
+static inline Status
+gf_x_get_class_hint (Display *dpy, Window w, XClassHint *hint)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    gf_prof_count (GF_PROF_CALL_PROPERTY, 1);
+    return XGetClassHint (dpy, w, hint);
+}
+
+static inline Status
+gf_x_get_wm_normal_hints (Display *dpy, Window w, XSizeHints *hints, long *supplied)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    gf_prof_count (GF_PROF_CALL_PROPERTY, 1);
+    return XGetWMNormalHints (dpy, w, hints, supplied);
+}
+
+static inline int
+gf_x_get_window_property (Display *dpy, Window w, Atom property, long offset,
+                          long length, Bool del, Atom req_type, Atom *actual_type,
+                          int *actual_format, unsigned long *nitems,
+                          unsigned long *bytes_after, unsigned char **prop)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    gf_prof_count (GF_PROF_CALL_PROPERTY, 1);
+    return XGetWindowProperty (dpy, w, property, offset, length, del, req_type,
+                               actual_type, actual_format, nitems, bytes_after, prop);
+}
+
+// XineramaQueryExtension is left raw: Xext caches its answer per display.
+static inline Bool
+gf_x_xinerama_is_active (Display *dpy)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    return XineramaIsActive (dpy);
+}
+
+static inline XineramaScreenInfo *
+gf_x_xinerama_query_screens (Display *dpy, int *count)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    return XineramaQueryScreens (dpy, count);
+}
+
+static inline int
+gf_x_sync (Display *dpy, Bool discard)
+{
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    gf_prof_count (GF_PROF_CALL_SYNC, 1);
+    return XSync (dpy, discard);
+}
+
+static inline int
+gf_x_flush (Display *dpy)
+{
+    gf_prof_count (GF_PROF_CALL_FLUSH, 1);
+    return XFlush (dpy);
+}
+
+#endif // GF_PLATFORM_UNIX_XCALL_H
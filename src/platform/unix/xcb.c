@@ -0,0 +1,298 @@
+#ifdef GF_HAVE_XCB
+
+#include "../../utils/memory.h"
+#include "internal.h"
+#include <X11/Xlib-xcb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/xcb.h>
+
+/*
+ * Pipelined property queries. Xlib's XGetWindowProperty and friends block on
+ * every reply, so a batch of N windows costs N x requests round-trips. Here
+ * all requests for the whole batch go out first and the replies are collected
+ * afterwards, so the batch costs a single round-trip regardless of size.
+ */
+
+// Enough 32-bit units for both halves of WM_CLASS at snapshot size.
+#define GF_XCB_CLASS_LONGS ((2 * GF_PROPS_CLASS_SIZE + 3) / 4)
+
+typedef struct
+{
+    xcb_get_window_attributes_cookie_t attrs;
+    xcb_get_geometry_cookie_t geometry;
+    xcb_translate_coordinates_cookie_t position;
+    xcb_get_property_cookie_t desktop;
+    xcb_get_property_cookie_t pid;
+    xcb_get_property_cookie_t wm_class;
+    xcb_get_property_cookie_t state;
+    xcb_get_property_cookie_t type;
+    xcb_get_property_cookie_t frame[3];
+} gf_xcb_props_cookies_t;
+
+static xcb_get_property_cookie_t
+_xcb_request_property (xcb_connection_t *conn, Window w, Atom property, Atom type,
+                       uint32_t length)
+{
+    return xcb_get_property (conn, 0, (xcb_window_t)w, (xcb_atom_t)property,
+                             (xcb_atom_t)type, 0, length);
+}
+
+// Collect a property reply; NULL when the property is absent or has an
+// unexpected format. Errors are taken here so they never reach Xlib's
+// error handler.
+static xcb_get_property_reply_t *
+_xcb_property_reply (xcb_connection_t *conn, xcb_get_property_cookie_t cookie,
+                     uint8_t format)
+{
+    xcb_generic_error_t *err = NULL;
+    xcb_get_property_reply_t *reply = xcb_get_property_reply (conn, cookie, &err);
+    free (err);
+
+    if (reply
+        && (reply->format != format || xcb_get_property_value_length (reply) <= 0))
+    {
+        free (reply);
+        return NULL;
+    }
+    return reply;
+}
+
+// Decode an atom-list reply into gf_net_state_t / gf_net_type_t bits.
+static uint32_t
+_xcb_atom_bits (xcb_get_property_reply_t *reply,
+                uint32_t (*decode) (const Atom *, unsigned long))
+{
+    if (!reply)
+        return 0;
+
+    const xcb_atom_t *values = xcb_get_property_value (reply);
+    int n = xcb_get_property_value_length (reply) / (int)sizeof (xcb_atom_t);
+    Atom atoms[GF_PROPS_MAX_ATOMS];
+
+    if (n > GF_PROPS_MAX_ATOMS)
+        n = GF_PROPS_MAX_ATOMS;
+    for (int i = 0; i < n; i++)
+        atoms[i] = values[i];
+
+    free (reply);
+    return decode (atoms, (unsigned long)n);
+}
+
+// WM_CLASS is "instance\0class\0"; split it into the two snapshot fields.
+static void
+_xcb_copy_class (xcb_get_property_reply_t *reply, gf_window_props_t *props)
+{
+    if (!reply)
+        return;
+
+    const char *value = xcb_get_property_value (reply);
+    size_t len = (size_t)xcb_get_property_value_length (reply);
+
+    size_t name_len = strnlen (value, len);
+    size_t copy = name_len < sizeof (props->res_name) - 1 ? name_len
+                                                          : sizeof (props->res_name) - 1;
+    memcpy (props->res_name, value, copy);
+    props->res_name[copy] = '\0';
+
+    if (name_len + 1 < len)
+    {
+        const char *cls = value + name_len + 1;
+        size_t cls_len = strnlen (cls, len - name_len - 1);
+        copy = cls_len < sizeof (props->res_class) - 1 ? cls_len
+                                                       : sizeof (props->res_class) - 1;
+        memcpy (props->res_class, cls, copy);
+        props->res_class[copy] = '\0';
+    }
+
+    props->has_class = true;
+    free (reply);
+}
+
+// Same priority as the Xlib path: GTK CSD, then EWMH, then KDE/Qt.
+static void
+_xcb_frame_candidates (Atom out[3])
+{
+    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
+    out[0] = atoms->gtk_frame_extents;
+    out[1] = atoms->net_frame_extents;
+    out[2] = atoms->qt_frame_extents;
+}
+
+static void
+_xcb_send_props_requests (xcb_connection_t *conn, xcb_window_t root, Window w,
+                          uint32_t mask, gf_xcb_props_cookies_t *c)
+{
+    gf_platform_atoms_t *atoms = gf_platform_atoms_get_global ();
+
+    if (mask & (GF_PROPS_ATTRS | GF_PROPS_GEOMETRY))
+        c->attrs = xcb_get_window_attributes (conn, (xcb_window_t)w);
+    if (mask & GF_PROPS_GEOMETRY)
+    {
+        c->geometry = xcb_get_geometry (conn, (xcb_drawable_t)w);
+        c->position = xcb_translate_coordinates (conn, (xcb_window_t)w, root, 0, 0);
+    }
+    if (mask & GF_PROPS_DESKTOP)
+        c->desktop = _xcb_request_property (conn, w, atoms->net_wm_desktop,
+                                            XCB_ATOM_CARDINAL, 1);
+    if (mask & GF_PROPS_PID)
+        c->pid = _xcb_request_property (conn, w, atoms->net_wm_pid, XCB_ATOM_CARDINAL, 1);
+    if (mask & GF_PROPS_CLASS)
+        c->wm_class = _xcb_request_property (conn, w, atoms->wm_class, XCB_ATOM_STRING,
+                                             GF_XCB_CLASS_LONGS);
+    if (mask & GF_PROPS_STATE)
+        c->state = _xcb_request_property (conn, w, atoms->net_wm_state, XCB_ATOM_ATOM,
+                                          GF_PROPS_MAX_ATOMS);
+    if (mask & GF_PROPS_TYPE)
+        c->type = _xcb_request_property (conn, w, atoms->net_wm_window_type,
+                                         XCB_ATOM_ATOM, GF_PROPS_MAX_ATOMS);
+    if (mask & GF_PROPS_FRAME)
+    {
+        Atom candidates[3];
+        _xcb_frame_candidates (candidates);
+        for (size_t i = 0; i < 3; i++)
+            c->frame[i]
+                = _xcb_request_property (conn, w, candidates[i], XCB_ATOM_CARDINAL, 4);
+    }
+}
+
+static uint32_t
+_xcb_property_requests (uint32_t mask)
+{
+    uint32_t n = 0;
+    n += (mask & GF_PROPS_DESKTOP) ? 1 : 0;
+    n += (mask & GF_PROPS_PID) ? 1 : 0;
+    n += (mask & GF_PROPS_CLASS) ? 1 : 0;
+    n += (mask & GF_PROPS_STATE) ? 1 : 0;
+    n += (mask & GF_PROPS_TYPE) ? 1 : 0;
+    n += (mask & GF_PROPS_FRAME) ? 3 : 0;
+    return n;
+}
+
+static bool
+_xcb_read_cardinal (xcb_connection_t *conn, xcb_get_property_cookie_t cookie,
+                    unsigned long *out)
+{
+    xcb_get_property_reply_t *reply = _xcb_property_reply (conn, cookie, 32);
+    if (!reply)
+        return false;
+
+    *out = *(const uint32_t *)xcb_get_property_value (reply);
+    free (reply);
+    return true;
+}
+
+// All three candidates were requested, so all three replies are drained even
+// once the first match is found.
+static void
+_xcb_collect_frame (xcb_connection_t *conn, const xcb_get_property_cookie_t cookies[3],
+                    gf_window_props_t *props)
+{
+    Atom candidates[3];
+    _xcb_frame_candidates (candidates);
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        xcb_get_property_reply_t *reply = _xcb_property_reply (conn, cookies[i], 32);
+        if (!reply)
+            continue;
+
+        if (!props->has_frame_extents && xcb_get_property_value_length (reply) >= 16)
+        {
+            const uint32_t *ext = xcb_get_property_value (reply);
+            for (int k = 0; k < 4; k++)
+                props->frame_extents[k] = (long)ext[k];
+            props->has_frame_extents = true;
+            props->frame_is_csd = (i == 0);
+        }
+        free (reply);
+    }
+}
+
+// Every cookie is consumed, even for windows that turned out to be gone, so
+// no reply is left queued inside XCB.
+static void
+_xcb_collect_props_replies (xcb_connection_t *conn, uint32_t mask,
+                            const gf_xcb_props_cookies_t *c, gf_window_props_t *props)
+{
+    xcb_generic_error_t *err = NULL;
+
+    if (mask & (GF_PROPS_ATTRS | GF_PROPS_GEOMETRY))
+    {
+        xcb_get_window_attributes_reply_t *attrs
+            = xcb_get_window_attributes_reply (conn, c->attrs, &err);
+        free (err);
+        err = NULL;
+        props->valid = (attrs != NULL);
+        props->mapped = attrs && attrs->map_state != XCB_MAP_STATE_UNMAPPED;
+        free (attrs);
+    }
+
+    if (mask & GF_PROPS_GEOMETRY)
+    {
+        xcb_get_geometry_reply_t *geom = xcb_get_geometry_reply (conn, c->geometry, &err);
+        free (err);
+        err = NULL;
+
+        xcb_translate_coordinates_reply_t *pos
+            = xcb_translate_coordinates_reply (conn, c->position, &err);
+        free (err);
+        err = NULL;
+
+        if (geom && pos)
+        {
+            props->has_geometry = true;
+            props->geometry
+                = (gf_rect_t){ pos->dst_x, pos->dst_y, geom->width, geom->height };
+        }
+        free (geom);
+        free (pos);
+    }
+
+    if (mask & GF_PROPS_DESKTOP)
+        props->has_desktop = _xcb_read_cardinal (conn, c->desktop, &props->desktop);
+    if (mask & GF_PROPS_PID)
+        props->has_pid = _xcb_read_cardinal (conn, c->pid, &props->pid);
+    if (mask & GF_PROPS_CLASS)
+        _xcb_copy_class (_xcb_property_reply (conn, c->wm_class, 8), props);
+    if (mask & GF_PROPS_STATE)
+        props->states = _xcb_atom_bits (_xcb_property_reply (conn, c->state, 32),
+                                        gf_net_state_from_atoms);
+    if (mask & GF_PROPS_TYPE)
+        props->types = _xcb_atom_bits (_xcb_property_reply (conn, c->type, 32),
+                                       gf_net_type_from_atoms);
+    if (mask & GF_PROPS_FRAME)
+        _xcb_collect_frame (conn, c->frame, props);
+
+    if ((mask & (GF_PROPS_ATTRS | GF_PROPS_GEOMETRY)) && !props->valid)
+        memset (props, 0, sizeof (*props));
+}
+
+bool
+gf_xcb_props_query (Display *dpy, const Window *windows, uint32_t count, uint32_t mask,
+                    gf_window_props_t *out)
+{
+    xcb_connection_t *conn = XGetXCBConnection (dpy);
+    if (!conn || count == 0)
+        return count == 0;
+
+    gf_xcb_props_cookies_t *cookies = gf_scratch_alloc (count * sizeof (*cookies));
+    if (!cookies)
+        return false;
+
+    xcb_window_t root = (xcb_window_t)DefaultRootWindow (dpy);
+
+    for (uint32_t i = 0; i < count; i++)
+        _xcb_send_props_requests (conn, root, windows[i], mask, &cookies[i]);
+
+    // The whole batch waits on one round-trip, one reply per property cookie
+    gf_prof_count (GF_PROF_CALL_ROUND_TRIP, 1);
+    gf_prof_count (GF_PROF_CALL_PROPERTY, count * _xcb_property_requests (mask));
+
+    for (uint32_t i = 0; i < count; i++)
+        _xcb_collect_props_replies (conn, mask, &cookies[i], &out[i]);
+
+    return true;
+}
+
+#endif // GF_HAVE_XCB
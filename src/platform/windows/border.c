@@ -1,4 +1,7 @@
+#define GF_MEM_TAG GF_MEM_TAG_BORDER
+
 #include "../../utils/logger.h"
+#include "../../utils/memory.h"
 #include "internal.h"
 #include "platform.h"
 #include "platform/windows/internal.h"
@@ -251,12 +254,30 @@ _border_exists (gf_windows_platform_data_t *data, gf_handle_t window)
     return false;
 }
 
+// Make room for one more tracked border.
+static bool
+_border_reserve (gf_windows_platform_data_t *data)
+{
+    if (data->border_count < data->border_capacity)
+        return true;
+
+    int capacity = data->border_capacity ? data->border_capacity * 2 : 32;
+    gf_border_t **borders
+        = gf_realloc (data->borders, (size_t)capacity * sizeof (gf_border_t *));
+    if (!borders)
+        return false;
+
+    data->borders = borders;
+    data->border_capacity = capacity;
+    return true;
+}
+
 // Allocate and initialise a border, stashing its props on the overlay window.
 static gf_border_t *
 _border_alloc (HWND overlay, gf_handle_t window, gf_color_t color, int thickness,
                RECT rect)
 {
-    gf_border_t *b = malloc (sizeof (gf_border_t));
+    gf_border_t *b = gf_malloc (sizeof (gf_border_t));
     if (!b)
         return NULL;
 
@@ -302,10 +323,9 @@ gf_border_add (gf_platform_t *platform, gf_handle_t window, gf_color_t color,
         return;
     }
 
-    int capacity = (int)(sizeof (data->borders) / sizeof (data->borders[0]));
-    if (data->border_count >= capacity)
+    if (!_border_reserve (data))
     {
-        GF_LOG_WARN ("Border array full (%d); dropping border for window %p", capacity,
+        GF_LOG_WARN ("Failed to grow border array; dropping border for window %p",
                      window);
         DestroyWindow (overlay);
         return;
@@ -439,7 +459,7 @@ gf_border_remove (gf_platform_t *platform, gf_handle_t window)
             DwmSetWindowAttribute (window, DWMWA_WINDOW_CORNER_PREFERENCE, &corner,
                                    sizeof (corner));
 
-            free (b);
+            gf_free (b);
 
             // Shift remaining borders
             for (int j = i; j < data->border_count - 1; j++)
@@ -470,8 +490,11 @@ gf_border_cleanup (gf_platform_t *platform)
             {
                 DestroyWindow (data->borders[i]->overlay);
             }
-            free (data->borders[i]);
+            gf_free (data->borders[i]);
         }
     }
+    gf_free (data->borders);
+    data->borders = NULL;
     data->border_count = 0;
+    data->border_capacity = 0;
 }
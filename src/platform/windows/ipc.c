@@ -17,7 +17,7 @@ typedef struct
 {
     HANDLE pipe;
     OVERLAPPED overlapped;
-    char buffer[GF_IPC_MSG_SIZE];
+    char buffer[sizeof (gf_ipc_frame_t) + GF_IPC_MSG_SIZE];
     DWORD bytes_read;
     BOOL pending_io;
     BOOL connected;
@@ -228,19 +228,47 @@ _pipe_write_sync (HANDLE pipe, const void *data, DWORD len)
     return ok && written == len;
 }
 
+// Framed replies go out as a header message and a payload message; legacy
+// ones as the fixed struct.
+static BOOL
+_pipe_write_response (HANDLE pipe, gf_ipc_response_t *response,
+                      const gf_ipc_frame_t *request)
+{
+    if (!request)
+    {
+        gf_ipc_response_flatten (response);
+        return _pipe_write_sync (pipe, response, GF_IPC_LEGACY_SIZE);
+    }
+
+    gf_ipc_frame_t frame;
+    uint32_t length = gf_ipc_response_length (response);
+    gf_ipc_frame_init (&frame, (uint16_t)response->status, request->request_id, length);
+
+    return _pipe_write_sync (pipe, &frame, sizeof (frame))
+           && (length == 0
+               || _pipe_write_sync (pipe, gf_ipc_response_data (response), length));
+}
+
 // Handle a fully-read client message: dispatch it, write the reply, and reset
 // the instance to listen for the next connection.
 static void
 _pipe_handle_message (gf_pipe_t *inst, DWORD bytes, void *user_data)
 {
-    inst->buffer[bytes] = '\0';
-
-    gf_ipc_response_t response = { 0 };
-    response.status = GF_IPC_SUCCESS;
-    gf_handle_client_message (inst->buffer, &response, user_data);
+    gf_ipc_frame_t frame;
+    bool framed;
+    const char *command = gf_ipc_request_parse (inst->buffer, bytes, &frame, &framed);
 
-    if (!_pipe_write_sync (inst->pipe, &response, sizeof (response)))
-        fprintf (stderr, "Pipe reply write failed: %lu\n", GetLastError ());
+    if (command)
+    {
+        gf_ipc_response_t response = { 0 };
+        response.status = GF_IPC_SUCCESS;
+        response.legacy = !framed;
+        gf_handle_client_message (command, &response, user_data);
+
+        if (!_pipe_write_response (inst->pipe, &response, framed ? &frame : NULL))
+            fprintf (stderr, "Pipe reply write failed: %lu\n", GetLastError ());
+        gf_ipc_response_release (&response);
+    }
 
     FlushFileBuffers (inst->pipe);
     DisconnectNamedPipe (inst->pipe);
@@ -323,6 +351,47 @@ gf_ipc_server_process (gf_ipc_handle_t handle, void *user_data)
     return processed;
 }
 
+// Named pipes are serviced through overlapped I/O, not a pollable descriptor.
+int
+gf_ipc_server_poll_fd (gf_ipc_handle_t handle)
+{
+    (void)handle;
+    return -1;
+}
+
+// Pipe instances are recycled after every reply, so there is no connection to
+// keep for a subscriber yet: "subscribe" is refused and nothing is published.
+bool
+gf_ipc_server_accepts_subscriber (gf_ipc_handle_t handle)
+{
+    (void)handle;
+    return false;
+}
+
+bool
+gf_ipc_server_subscribed (gf_ipc_handle_t handle, uint32_t topic)
+{
+    (void)handle;
+    (void)topic;
+    return false;
+}
+
+void
+gf_ipc_server_publish (gf_ipc_handle_t handle, uint32_t topic, uint64_t key,
+                       const char *event)
+{
+    (void)handle;
+    (void)topic;
+    (void)key;
+    (void)event;
+}
+
+void
+gf_ipc_server_flush (gf_ipc_handle_t handle)
+{
+    (void)handle;
+}
+
 gf_ipc_handle_t
 gf_ipc_client_connect (void)
 {
@@ -369,6 +438,28 @@ gf_ipc_client_connect (void)
     return -1;
 }
 
+// Read exactly len bytes from a message-mode pipe, across message boundaries.
+// ERROR_MORE_DATA only means the current message continues.
+static bool
+_pipe_read_exact (HANDLE pipe, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    size_t got = 0;
+
+    while (got < len)
+    {
+        DWORD chunk = (DWORD)((len - got) > 0x10000000 ? 0x10000000 : (len - got));
+        DWORD n = 0;
+        if (!ReadFile (pipe, p + got, chunk, &n, NULL)
+            && GetLastError () != ERROR_MORE_DATA)
+            return false;
+        if (n == 0)
+            return false;
+        got += n;
+    }
+    return true;
+}
+
 bool
 gf_ipc_client_send (gf_ipc_handle_t handle, const char *command,
                     gf_ipc_response_t *response)
@@ -378,11 +469,25 @@ gf_ipc_client_send (gf_ipc_handle_t handle, const char *command,
         return false;
     }
 
+    // GUI worker threads send concurrently; each call keeps its own id
+    static volatile LONG next_request_id;
     HANDLE pipe = (HANDLE)handle;
-    DWORD bytes_written;
+    size_t len = strlen (command);
+    if (len > GF_IPC_MSG_SIZE - 1)
+        return false;
+
+    uint32_t request_id = (uint32_t)InterlockedIncrement (&next_request_id);
 
-    BOOL success
-        = WriteFile (pipe, command, (DWORD)strlen (command), &bytes_written, NULL);
+    // One pipe message per request
+    char request[sizeof (gf_ipc_frame_t) + GF_IPC_MSG_SIZE];
+    gf_ipc_frame_t frame;
+    gf_ipc_frame_init (&frame, 0, request_id, (uint32_t)len);
+    memcpy (request, &frame, sizeof (frame));
+    memcpy (request + sizeof (frame), command, len);
+
+    DWORD bytes_written;
+    BOOL success = WriteFile (pipe, request, (DWORD)(sizeof (frame) + len),
+                              &bytes_written, NULL);
 
     if (!success)
     {
@@ -390,18 +495,40 @@ gf_ipc_client_send (gf_ipc_handle_t handle, const char *command,
         return false;
     }
 
-    DWORD bytes_read;
-    success = ReadFile (pipe, response, sizeof (*response), &bytes_read, NULL);
+    memset (response, 0, sizeof (*response));
+    if (!_pipe_read_exact (pipe, &frame, sizeof (frame)))
+    {
+        fprintf (stderr, "ReadFile failed: %lu\n", GetLastError ());
+        return false;
+    }
 
-    if (!success || bytes_read != sizeof (*response))
+    if (!gf_ipc_frame_valid (&frame) || frame.request_id != request_id)
+    {
+        fprintf (stderr, "Unexpected reply; is the daemon older than this client?\n");
+        return false;
+    }
+
+    char *data = gf_ipc_response_reserve (response, frame.length);
+    if (!data || !_pipe_read_exact (pipe, data, frame.length))
     {
         fprintf (stderr, "ReadFile failed: %lu\n", GetLastError ());
+        gf_ipc_response_release (response);
         return false;
     }
 
+    response->status = (gf_ipc_status_t)frame.status;
     return true;
 }
 
+bool
+gf_ipc_client_next_event (gf_ipc_handle_t handle, char *buffer, size_t size)
+{
+    (void)handle;
+    (void)buffer;
+    (void)size;
+    return false;
+}
+
 void
 gf_ipc_client_disconnect (gf_ipc_handle_t handle)
 {
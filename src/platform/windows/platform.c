@@ -1,3 +1,5 @@
+#define GF_MEM_TAG GF_MEM_TAG_PLATFORM
+
 #include "../../utils/logger.h"
 #include "../../utils/memory.h"
 #include "internal.h"
@@ -25,8 +25,9 @@ typedef struct
     int monitor_count;
     gf_monitor_t monitors[GF_MAX_MONITORS];
     uint32_t enumerated_monitor_count;
-    gf_border_t *borders[GF_MAX_WINDOWS_PER_WORKSPACE * GF_MAX_WORKSPACES];
+    gf_border_t **borders; // grown by gf_border_add, freed by gf_border_cleanup
     int border_count;
+    int border_capacity;
     HWINEVENTHOOK resize_hook;
     HWINEVENTHOOK location_hook;
     gf_resize_state_t resize_state;
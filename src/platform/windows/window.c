@@ -142,11 +142,9 @@ _window_fill_info (HWND hwnd, gf_win_info_t *info)
         && !GetWindowRect (hwnd, &rect))
         return false;
 
-    if (GetWindowTextA (hwnd, info->name, sizeof (info->name)))
-        info->name[sizeof (info->name) - 1] = '\0';
-    else
-        info->name[0] = '\0';
-
+    // Titles change constantly and the intern pool never shrinks; the core
+    // resolves the name from the window class, as on X11
+    info->name_id = GF_STR_NONE;
     info->id = (gf_handle_t)hwnd;
     info->workspace_id = GF_FIRST_WORKSPACE_ID;
     info->geometry.x = rect.left;
@@ -170,7 +168,7 @@ gf_platform_get_windows (gf_display_t display, gf_ws_id_t *workspace_id,
     if (!windows || !count)
         return GF_ERROR_INVALID_PARAMETER;
 
-    gf_win_info_t *window_list = gf_malloc (MAX_WINDOWS * sizeof (gf_win_info_t));
+    gf_win_info_t *window_list = gf_scratch_alloc (MAX_WINDOWS * sizeof (gf_win_info_t));
     if (!window_list)
         return GF_ERROR_MEMORY_ALLOCATION;
 
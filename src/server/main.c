@@ -2,8 +2,10 @@
 #include "../core/layout.h"
 #include "../core/wm.h"
 #include "../platform/platform.h"
+#include "../utils/intern.h"
 #include "../utils/logger.h"
 #include "../utils/memory.h"
+#include "../utils/trace.h"
 #ifdef __linux__
 #include "../platform/unix/platform.h"
 #endif
@@ -11,37 +13,80 @@
 #include <stdlib.h>
 #include <string.h>
 
+static volatile sig_atomic_t g_signal = 0;
 static gf_wm_t *g_manager = NULL;
+static gf_platform_t *g_platform = NULL;
+static gf_layout_engine_t *g_layout = NULL;
+static gf_config_t *g_config = NULL;
 
+// Release everything in reverse order of creation, then report whatever the
+// allocation accounting still sees as live.
 static void
-signal_handler (int sig)
+server_shutdown (void)
 {
-    GF_LOG_INFO ("Received signal %d, shutting down...", sig);
+    // A trace still recording at exit (GF_TRACE) is dumped to the default path
+    if (gf_trace_active ())
+    {
+        gf_wm_trace_stop (g_manager);
+        gf_trace_write (NULL, NULL, 0);
+    }
+    gf_trace_cleanup ();
+
     if (g_manager)
     {
         gf_wm_cleanup (g_manager);
         gf_wm_destroy (g_manager);
         g_manager = NULL;
     }
-    exit (0);
+
+    if (g_layout)
+    {
+        gf_layout_engine_destroy (g_layout);
+        g_layout = NULL;
+    }
+
+    gf_free (g_config);
+    g_config = NULL;
+
+    // Window records are gone, so no interned name is referenced any more
+    gf_intern_cleanup ();
+    gf_scratch_cleanup ();
+
+#ifdef __linux__
+    if (g_platform)
+    {
+        gf_platform_destroy (g_platform);
+        g_platform = NULL;
+    }
+#endif
+
+    gf_mem_report_leaks ();
+    gf_log_shutdown ();
+}
+
+// Nothing here may allocate, lock or do stdio: shutdown happens on the main
+// thread once gf_wm_run returns.
+static void
+signal_handler (int sig)
+{
+    g_signal = sig;
+    gf_wm_request_stop ();
 }
 
 int
 main ()
 {
     gf_log_init (GF_LOG_DEBUG);
+    if (gf_log_start_async () != GF_SUCCESS)
+        GF_LOG_WARN ("Failed to start the log writer thread, logging synchronously");
     signal (SIGINT, signal_handler);
     signal (SIGTERM, signal_handler);
 
-    gf_platform_t *platform = NULL;
-    gf_layout_engine_t *layout = NULL;
-    gf_config_t *config = NULL;
-
     GF_LOG_INFO ("Starting GridFlux Window Manager v2.0");
 
     // Load configuration first
-    config = gf_malloc (sizeof (gf_config_t));
-    if (!config)
+    g_config = gf_malloc_tagged (sizeof (gf_config_t), GF_MEM_TAG_CONFIG);
+    if (!g_config)
     {
         GF_LOG_ERROR ("Failed to allocate config");
         return 1;
@@ -51,16 +96,16 @@ main ()
     if (!cfg_path)
     {
         GF_LOG_ERROR ("Failed to determine config file path");
-        gf_free (config);
+        server_shutdown ();
         return 1;
     }
 
-    *config = load_or_create_config (cfg_path);
+    *g_config = load_or_create_config (cfg_path);
     GF_LOG_INFO ("Configuration loaded:");
-    GF_LOG_INFO ("  max_windows_per_workspace: %u", config->max_windows_per_workspace);
-    GF_LOG_INFO ("  max_workspaces: %u", config->max_workspaces);
+    GF_LOG_INFO ("  max_windows_per_workspace: %u", g_config->max_windows_per_workspace);
+    GF_LOG_INFO ("  max_workspaces: %u", g_config->max_workspaces);
     GF_LOG_INFO ("  default_padding: %u (hardcoded)", GF_DEFAULT_PADDING);
-    GF_LOG_INFO ("  min_window_size: %u", config->min_window_size);
+    GF_LOG_INFO ("  min_window_size: %u", g_config->min_window_size);
 
 #ifdef __linux__
     char *session_type = getenv ("XDG_SESSION_TYPE");
@@ -68,37 +113,42 @@ main ()
     {
         GF_LOG_ERROR ("X11 session required, found: %s",
                       session_type ? session_type : "none");
-        gf_free (config);
+        server_shutdown ();
         return 1;
     }
 #endif
 
-    platform = gf_platform_create ();
+    g_platform = gf_platform_create ();
 
-    if (!platform)
+    if (!g_platform)
     {
         GF_LOG_ERROR ("Failed to create platform interface");
-        gf_free (config);
+        server_shutdown ();
         return 1;
     }
 
-    layout = gf_layout_engine_create (config);
-    if (!layout)
+    g_layout = gf_layout_engine_create (g_config);
+    if (!g_layout)
     {
         GF_LOG_ERROR ("Failed to create geometry calculator");
         goto cleanup;
     }
 
-    gf_err_t result = gf_wm_create (&g_manager, platform, layout);
+    gf_err_t result = gf_wm_create (&g_manager, g_platform, g_layout);
     if (result != GF_SUCCESS)
     {
         GF_LOG_ERROR ("Failed to create window manager: %d", result);
         goto cleanup;
     }
 
-    g_manager->config = config;
+    g_manager->config = g_config;
     GF_LOG_INFO ("Config assigned to window manager");
 
+    // GF_TRACE=1 records from startup on, so platform init shows up too
+    const char *trace_env = getenv ("GF_TRACE");
+    if (trace_env && trace_env[0] && strcmp (trace_env, "0") != 0)
+        gf_wm_trace_start (g_manager, 0);
+
     result = gf_wm_init (g_manager);
     if (result != GF_SUCCESS)
     {
@@ -108,29 +158,11 @@ main ()
 
     GF_LOG_INFO ("Window manager initialized, entering main loop");
     result = gf_wm_run (g_manager);
+    if (g_signal)
+        GF_LOG_INFO ("Received signal %d, shutting down...", (int)g_signal);
 
 cleanup:
-    if (g_manager)
-    {
-        gf_wm_cleanup (g_manager);
-        gf_wm_destroy (g_manager);
-    }
-    else if (config)
-    {
-        gf_free (config);
-    }
-
-    if (layout)
-    {
-        gf_layout_engine_destroy (layout);
-    }
-
-#ifdef __linux__
-    if (platform)
-    {
-        gf_platform_destroy (platform);
-    }
-#endif
+    server_shutdown ();
 
     GF_LOG_INFO ("GridFlux Window Manager shutdown complete");
     return (result == GF_SUCCESS) ? 0 : 1;
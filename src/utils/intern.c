@@ -0,0 +1,151 @@
+#define GF_MEM_TAG GF_MEM_TAG_LIST
+
+#include "intern.h"
+#include "memory.h"
+#include <string.h>
+
+// Open-addressing table from string to id; ids index g_intern_strings, with
+// slot 0 reserved for GF_STR_NONE.
+typedef struct
+{
+    uint32_t hash;
+    gf_str_id_t id; // GF_STR_NONE marks an empty slot
+} gf_intern_slot_t;
+
+static gf_intern_slot_t *g_intern_slots;
+static uint32_t g_intern_capacity; // power of two
+static char **g_intern_strings;
+static uint32_t g_intern_count; // ids handed out, including GF_STR_NONE
+static uint32_t g_intern_strings_capacity;
+
+// FNV-1a over at most len bytes
+static uint32_t
+_intern_hash (const char *str, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void
+_intern_place (gf_intern_slot_t *slots, uint32_t capacity, gf_intern_slot_t entry)
+{
+    uint32_t mask = capacity - 1;
+    uint32_t i = entry.hash & mask;
+    while (slots[i].id != GF_STR_NONE)
+        i = (i + 1) & mask;
+    slots[i] = entry;
+}
+
+static bool
+_intern_grow_slots (void)
+{
+    uint32_t capacity = g_intern_capacity ? g_intern_capacity * 2 : 64;
+    gf_intern_slot_t *slots = gf_calloc (capacity, sizeof (gf_intern_slot_t));
+    if (!slots)
+        return false;
+
+    for (uint32_t i = 0; i < g_intern_capacity; i++)
+    {
+        if (g_intern_slots[i].id != GF_STR_NONE)
+            _intern_place (slots, capacity, g_intern_slots[i]);
+    }
+
+    gf_free (g_intern_slots);
+    g_intern_slots = slots;
+    g_intern_capacity = capacity;
+    return true;
+}
+
+static bool
+_intern_grow_strings (void)
+{
+    uint32_t capacity = g_intern_strings_capacity ? g_intern_strings_capacity * 2 : 64;
+    char **strings = gf_calloc (capacity, sizeof (char *));
+    if (!strings)
+        return false;
+
+    if (g_intern_count)
+        memcpy (strings, g_intern_strings, g_intern_count * sizeof (char *));
+    else
+        g_intern_count = 1; // reserve GF_STR_NONE
+
+    gf_free (g_intern_strings);
+    g_intern_strings = strings;
+    g_intern_strings_capacity = capacity;
+    return true;
+}
+
+gf_str_id_t
+gf_intern (const char *str)
+{
+    if (!str || str[0] == '\0')
+        return GF_STR_NONE;
+
+    size_t len = strnlen (str, GF_WIN_NAME_MAX - 1);
+    uint32_t hash = _intern_hash (str, len);
+
+    if (g_intern_capacity)
+    {
+        uint32_t mask = g_intern_capacity - 1;
+        for (uint32_t i = hash & mask; g_intern_slots[i].id != GF_STR_NONE;
+             i = (i + 1) & mask)
+        {
+            const char *s = g_intern_strings[g_intern_slots[i].id];
+            if (g_intern_slots[i].hash == hash && strncmp (s, str, len) == 0
+                && s[len] == '\0')
+                return g_intern_slots[i].id;
+        }
+    }
+
+    // Keep the table load under one half
+    if ((g_intern_count + 1) * 2 > g_intern_capacity && !_intern_grow_slots ())
+        return GF_STR_NONE;
+    if (g_intern_count + 1 > g_intern_strings_capacity && !_intern_grow_strings ())
+        return GF_STR_NONE;
+
+    char *copy = gf_malloc (len + 1);
+    if (!copy)
+        return GF_STR_NONE;
+    memcpy (copy, str, len);
+    copy[len] = '\0';
+
+    gf_str_id_t id = g_intern_count++;
+    g_intern_strings[id] = copy;
+    _intern_place (g_intern_slots, g_intern_capacity,
+                   (gf_intern_slot_t){ .hash = hash, .id = id });
+    return id;
+}
+
+const char *
+gf_intern_str (gf_str_id_t id)
+{
+    if (id == GF_STR_NONE || id >= g_intern_count)
+        return "";
+    return g_intern_strings[id];
+}
+
+uint32_t
+gf_intern_count (void)
+{
+    return g_intern_count ? g_intern_count - 1 : 0;
+}
+
+void
+gf_intern_cleanup (void)
+{
+    for (uint32_t i = 1; i < g_intern_count; i++)
+        gf_free (g_intern_strings[i]);
+
+    gf_free (g_intern_strings);
+    gf_free (g_intern_slots);
+    g_intern_strings = NULL;
+    g_intern_slots = NULL;
+    g_intern_capacity = 0;
+    g_intern_strings_capacity = 0;
+    g_intern_count = 0;
+}
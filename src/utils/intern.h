@@ -0,0 +1,32 @@
+#ifndef GF_UTILS_INTERN_H
+#define GF_UTILS_INTERN_H
+
+#include "../core/types.h"
+#include <stdint.h>
+
+/*
+ * String interning for window names (the WM class on X11). Each distinct
+ * string gets a small integer id, so records store 4 bytes instead of a
+ * buffer and equality is an integer compare. Ids are only meaningful inside
+ * the process that assigned them and stay valid until gf_intern_cleanup; the
+ * pool is not thread-safe and is only used from the main loop.
+ */
+
+// Id of str (truncated to GF_WIN_NAME_MAX - 1 bytes). NULL, "" and
+// allocation failure all map to GF_STR_NONE.
+gf_str_id_t gf_intern (const char *str);
+
+// String for an id; "" for GF_STR_NONE or an unknown id, never NULL.
+const char *gf_intern_str (gf_str_id_t id);
+
+uint32_t gf_intern_count (void);
+void gf_intern_cleanup (void);
+
+// Name of a window record, "" until it has been resolved.
+static inline const char *
+gf_win_name (const gf_win_info_t *win)
+{
+    return win ? gf_intern_str (win->name_id) : "";
+}
+
+#endif // GF_UTILS_INTERN_H
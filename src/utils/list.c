@@ -1,3 +1,5 @@
+#define GF_MEM_TAG GF_MEM_TAG_LIST
+
 #include "list.h"
 #include "../config/config.h"
 #include "logger.h"
@@ -6,6 +8,207 @@
 #include <stdint.h>
 #include <string.h>
 
+static uint32_t
+gf_window_index_hash (gf_handle_t window_id, uint32_t mask)
+{
+    // Fibonacci hashing; X ids and HWNDs share their low bits, so mix the top
+    uint64_t h = (uint64_t)(uintptr_t)window_id * 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(h >> 32) & mask;
+}
+
+static void
+gf_window_index_insert (gf_win_list_t *list, uint32_t slot)
+{
+    uint32_t mask = list->index_capacity - 1;
+    uint32_t b = gf_window_index_hash (list->items[slot].id, mask);
+
+    while (list->index[b] != 0)
+        b = (b + 1) & mask;
+
+    list->index[b] = slot + 1;
+    list->index_used++;
+}
+
+// Size the index for the current capacity and re-enter every live slot. This
+// is also how stale buckets (after a remove shifted the tail) are dropped.
+static void
+gf_window_index_rebuild (gf_win_list_t *list)
+{
+    uint32_t want = 16;
+    while (want < list->capacity * 2)
+        want *= 2;
+
+    if (want != list->index_capacity)
+    {
+        uint32_t *index = gf_realloc (list->index, want * sizeof (uint32_t));
+        if (!index)
+        {
+            // Lookups fall back to a linear scan until the next rebuild
+            gf_free (list->index);
+            list->index = NULL;
+            list->index_capacity = list->index_used = 0;
+            return;
+        }
+        list->index = index;
+        list->index_capacity = want;
+    }
+
+    memset (list->index, 0, list->index_capacity * sizeof (uint32_t));
+    list->index_used = 0;
+    for (uint32_t i = 0; i < list->count; i++)
+        gf_window_index_insert (list, i);
+}
+
+static bool
+gf_members_reserve (gf_ws_members_t *bucket, uint32_t needed)
+{
+    if (bucket->capacity >= needed)
+        return true;
+
+    uint32_t capacity = bucket->capacity ? bucket->capacity : 8;
+    while (capacity < needed)
+        capacity *= 2;
+
+    uint32_t *slots = gf_realloc (bucket->slots, capacity * sizeof (uint32_t));
+    if (!slots)
+        return false;
+
+    bucket->slots = slots;
+    bucket->capacity = capacity;
+    return true;
+}
+
+// Bucket for a workspace id, growing the table when grow is set and the id is
+// in range. Returns the stray bucket for every other id.
+static gf_ws_members_t *
+gf_members_bucket (gf_win_list_t *list, gf_ws_id_t workspace_id, bool grow)
+{
+    if (workspace_id < 0 || workspace_id >= GF_WS_MEMBERS_LIMIT)
+        return &list->stray;
+
+    uint32_t id = (uint32_t)workspace_id;
+    if (id < list->members_count)
+        return &list->members[id];
+    if (!grow)
+        return &list->stray;
+
+    uint32_t count = list->members_count ? list->members_count : 16;
+    while (count <= id)
+        count *= 2;
+    if (count > GF_WS_MEMBERS_LIMIT)
+        count = GF_WS_MEMBERS_LIMIT;
+
+    gf_ws_members_t *members = gf_calloc (count, sizeof (gf_ws_members_t));
+    if (!members)
+    {
+        list->members_stale = true;
+        return &list->stray;
+    }
+    if (list->members_count)
+        memcpy (members, list->members, list->members_count * sizeof (gf_ws_members_t));
+
+    gf_free (list->members);
+    list->members = members;
+    list->members_count = count;
+    return &list->members[id];
+}
+
+// Slots are unique and kept ascending, so both edits are a binary search plus
+// a memmove within one workspace.
+static uint32_t
+gf_members_lower_bound (const gf_ws_members_t *bucket, uint32_t slot)
+{
+    uint32_t lo = 0, hi = bucket->count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (bucket->slots[mid] < slot)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void
+gf_members_insert (gf_win_list_t *list, gf_ws_id_t workspace_id, uint32_t slot)
+{
+    gf_ws_members_t *bucket = gf_members_bucket (list, workspace_id, true);
+    if (!gf_members_reserve (bucket, bucket->count + 1))
+    {
+        list->members_stale = true;
+        return;
+    }
+
+    uint32_t at = gf_members_lower_bound (bucket, slot);
+    memmove (&bucket->slots[at + 1], &bucket->slots[at],
+             (bucket->count - at) * sizeof (uint32_t));
+    bucket->slots[at] = slot;
+    bucket->count++;
+}
+
+static void
+gf_members_erase (gf_win_list_t *list, gf_ws_id_t workspace_id, uint32_t slot)
+{
+    gf_ws_members_t *bucket = gf_members_bucket (list, workspace_id, false);
+    uint32_t at = gf_members_lower_bound (bucket, slot);
+
+    if (at >= bucket->count || bucket->slots[at] != slot)
+        return;
+
+    memmove (&bucket->slots[at], &bucket->slots[at + 1],
+             (bucket->count - at - 1) * sizeof (uint32_t));
+    bucket->count--;
+}
+
+// Refill every bucket from the list; appending in slot order keeps them sorted.
+static void
+gf_members_rebuild (gf_win_list_t *list)
+{
+    for (uint32_t i = 0; i < list->members_count; i++)
+        list->members[i].count = 0;
+    list->stray.count = 0;
+    list->members_stale = false;
+
+    for (uint32_t i = 0; i < list->count; i++)
+    {
+        gf_ws_members_t *bucket
+            = gf_members_bucket (list, list->items[i].workspace_id, true);
+        if (!gf_members_reserve (bucket, bucket->count + 1))
+        {
+            list->members_stale = true;
+            return;
+        }
+        bucket->slots[bucket->count++] = i;
+    }
+}
+
+static void
+gf_members_free (gf_win_list_t *list)
+{
+    for (uint32_t i = 0; i < list->members_count; i++)
+        gf_free (list->members[i].slots);
+    gf_free (list->members);
+    gf_free (list->stray.slots);
+
+    list->members = NULL;
+    list->members_count = 0;
+    memset (&list->stray, 0, sizeof (list->stray));
+    list->members_stale = false;
+}
+
+// Member bucket for reading, or NULL when the list has no usable index.
+static const gf_ws_members_t *
+gf_members_peek (const gf_win_list_t *list, gf_ws_id_t workspace_id)
+{
+    if (!list->index || list->members_stale)
+        return NULL;
+
+    if (workspace_id >= 0 && (uint32_t)workspace_id < list->members_count)
+        return &list->members[workspace_id];
+    return &list->stray;
+}
+
 void
 gf_window_list_cleanup (gf_win_list_t *list)
 {
@@ -13,9 +216,14 @@ gf_window_list_cleanup (gf_win_list_t *list)
         return;
 
     gf_free (list->items);
+    gf_free (list->index);
+    gf_members_free (list);
     list->items = NULL;
+    list->index = NULL;
     list->count = 0;
     list->capacity = 0;
+    list->index_capacity = 0;
+    list->index_used = 0;
 }
 
 static gf_err_t
@@ -37,18 +245,35 @@ gf_window_list_ensure_capacity (gf_win_list_t *list, uint32_t required_capacity)
 
     list->items = new_items;
     list->capacity = new_capacity;
+    gf_window_index_rebuild (list);
     return GF_SUCCESS;
 }
 
+void
+gf_window_list_clear (gf_win_list_t *list)
+{
+    if (!list)
+        return;
+
+    list->count = 0;
+    gf_window_index_rebuild (list);
+    gf_members_rebuild (list);
+}
+
 void
 gf_window_list_mark_all_needs_update (gf_win_list_t *list, const gf_ws_id_t *workspace_id)
 {
     if (!list)
         return;
 
-    for (uint32_t i = 0; i < list->count; i++)
+    uint32_t n = list->count;
+    const uint32_t *slots = NULL;
+    if (workspace_id)
+        slots = gf_window_list_members (list, *workspace_id, &n);
+
+    for (uint32_t k = 0; k < n; k++)
     {
-        gf_win_info_t *win = &list->items[i];
+        gf_win_info_t *win = &list->items[gf_ws_slot (slots, k)];
 
         if ((!workspace_id || win->workspace_id == *workspace_id) && win->is_valid)
         {
@@ -74,7 +299,17 @@ gf_window_list_add (gf_win_list_t *list, const gf_win_info_t *window)
         return result;
 
     list->items[list->count] = *window;
+    list->items[list->count].digest = 0;
+    list->items[list->count].generation = 0;
     list->count++;
+
+    // Keep probe chains short; stale buckets count against the load too
+    if (!list->index || (list->index_used + 1) * 2 > list->index_capacity)
+        gf_window_index_rebuild (list);
+    else
+        gf_window_index_insert (list, list->count - 1);
+    gf_members_insert (list, window->workspace_id, list->count - 1);
+
     gf_window_list_mark_all_needs_update (list, &window->workspace_id);
 
     GF_LOG_DEBUG ("Added window %p to workspace %d (total: %u)", (void *)window->id,
@@ -104,6 +339,11 @@ gf_window_list_remove (gf_win_list_t *list, gf_handle_t window_id)
             list->count--;
 
             memset (&list->items[list->count], 0, sizeof (list->items[0]));
+
+            // Every slot past i moved down by one; renumbering them is O(n)
+            // either way, so rebuild rather than patch bucket by bucket.
+            gf_window_index_rebuild (list);
+            gf_members_rebuild (list);
             gf_window_list_mark_all_needs_update (list, &workspace_id);
             GF_LOG_DEBUG ("Removed window %p from workspace %d (total: %u)",
                           (void *)window_id, workspace_id, list->count);
@@ -136,11 +376,22 @@ gf_window_list_update (gf_win_list_t *list, const gf_win_info_t *window)
     // The platform-enumerated window data has needs_update = false,
     // but we may have set it to true (e.g. when a new window was added).
     bool was_pending = existing->needs_update;
+    uint32_t digest = existing->digest;
+    uint64_t generation = existing->generation;
+
+    if (existing->workspace_id != window->workspace_id)
+    {
+        uint32_t slot = (uint32_t)(existing - list->items);
+        gf_members_erase (list, existing->workspace_id, slot);
+        gf_members_insert (list, window->workspace_id, slot);
+    }
 
     *existing = *window;
 
     // Restore: keep true if it was already pending, or if geometry changed
     existing->needs_update = was_pending || changed;
+    existing->digest = digest;
+    existing->generation = generation;
 
     if (changed)
     {
@@ -156,6 +407,24 @@ gf_window_list_find_by_window_id (const gf_win_list_t *list, gf_handle_t window_
     if (!list)
         return NULL;
 
+    if (list->index)
+    {
+        uint32_t mask = list->index_capacity - 1;
+        uint32_t b = gf_window_index_hash (window_id, mask);
+
+        // A bucket is only trusted if its slot is live and holds this window,
+        // so buckets left behind by a truncated list are skipped over.
+        for (uint32_t probes = 0; list->index[b] != 0 && probes < list->index_capacity;
+             probes++)
+        {
+            uint32_t slot = list->index[b] - 1;
+            if (slot < list->count && list->items[slot].id == window_id)
+                return &list->items[slot];
+            b = (b + 1) & mask;
+        }
+        return NULL;
+    }
+
     for (uint32_t i = 0; i < list->count; i++)
     {
         if (list->items[i].id == window_id)
@@ -173,10 +442,16 @@ gf_window_list_count_by_workspace (const gf_win_list_t *list, gf_ws_id_t workspa
     if (!list)
         return 0;
 
+    const gf_ws_members_t *bucket = gf_members_peek (list, workspace_id);
+    if (bucket && bucket != &list->stray)
+        return bucket->count;
+
+    uint32_t n = bucket ? bucket->count : list->count;
     uint32_t count = 0;
-    for (uint32_t i = 0; i < list->count; i++)
+    for (uint32_t k = 0; k < n; k++)
     {
-        if (list->items[i].workspace_id == workspace_id)
+        if (list->items[gf_ws_slot (bucket ? bucket->slots : NULL, k)].workspace_id
+            == workspace_id)
         {
             count++;
         }
@@ -191,50 +466,97 @@ gf_window_list_clear_update_flags (gf_win_list_t *list, gf_ws_id_t workspace_id)
     if (!list)
         return;
 
-    for (uint32_t i = 0; i < list->count; i++)
+    uint32_t n = list->count;
+    const uint32_t *slots
+        = workspace_id < 0 ? NULL : gf_window_list_members (list, workspace_id, &n);
+
+    for (uint32_t k = 0; k < n; k++)
     {
-        if (workspace_id < 0 || list->items[i].workspace_id == workspace_id)
+        gf_win_info_t *win = &list->items[gf_ws_slot (slots, k)];
+        if (workspace_id < 0 || win->workspace_id == workspace_id)
         {
-            list->items[i].needs_update = false;
+            win->needs_update = false;
         }
     }
 }
 
-gf_err_t
-gf_window_list_get_by_workspace (const gf_win_list_t *list, gf_ws_id_t workspace_id,
-                                 gf_win_info_t **windows, uint32_t *count)
+const uint32_t *
+gf_window_list_members (gf_win_list_t *list, gf_ws_id_t workspace_id, uint32_t *count)
 {
-    if (!list || !windows)
-        return GF_ERROR_INVALID_PARAMETER;
+    if (list->index && list->members_stale)
+        gf_members_rebuild (list);
 
-    if (count)
+    const gf_ws_members_t *bucket = gf_members_peek (list, workspace_id);
+    if (!bucket)
     {
-        *count = gf_window_list_count_by_workspace (list, workspace_id);
-        if (*count == 0)
-        {
-            *windows = NULL;
-            return GF_SUCCESS;
-        }
+        *count = list->count;
+        return NULL;
     }
 
-    *windows = gf_malloc (*count * sizeof (gf_win_info_t));
-    if (!*windows)
+    *count = bucket->count;
+    return bucket->slots;
+}
+
+void
+gf_window_list_set_workspace (gf_win_list_t *list, gf_win_info_t *win,
+                              gf_ws_id_t workspace_id)
+{
+    if (!win || win->workspace_id == workspace_id)
+        return;
+
+    // Records outside the list (not yet added) have no membership to move
+    if (list && win >= list->items && win < list->items + list->count)
     {
-        return GF_ERROR_MEMORY_ALLOCATION;
+        uint32_t slot = (uint32_t)(win - list->items);
+        gf_members_erase (list, win->workspace_id, slot);
+        gf_members_insert (list, workspace_id, slot);
     }
 
-    uint32_t idx = 0;
-    // Collect in forward (insertion) order so the layout engine assigns stable
-    // cells; iterating backwards made tiles jump whenever the list changed.
-    for (uint32_t i = 0; i < list->count && idx < *count; i++)
+    win->workspace_id = workspace_id;
+}
+
+void
+gf_ws_iter_init (gf_ws_iter_t *it, gf_win_list_t *list, gf_ws_id_t workspace_id,
+                 gf_win_pred_t pred, void *ctx)
+{
+    it->list = list;
+    it->pos = 0;
+    it->workspace_id = workspace_id;
+    it->pred = pred;
+    it->ctx = ctx;
+    it->slots = list ? gf_window_list_members (list, workspace_id, &it->count) : NULL;
+    if (!list)
+        it->count = 0;
+}
+
+gf_win_info_t *
+gf_ws_iter_next (gf_ws_iter_t *it)
+{
+    // Forward (insertion) order so the layout engine assigns stable cells;
+    // iterating backwards made tiles jump whenever the list changed.
+    while (it->pos < it->count)
     {
-        if (list->items[i].workspace_id == workspace_id)
-        {
-            (*windows)[idx++] = list->items[i];
-        }
+        gf_win_info_t *win = &it->list->items[gf_ws_slot (it->slots, it->pos++)];
+        if (win->workspace_id != it->workspace_id)
+            continue;
+        if (it->pred && !it->pred (win, it->ctx))
+            continue;
+        return win;
     }
 
-    return GF_SUCCESS;
+    return NULL;
+}
+
+uint32_t
+gf_ws_iter_collect (gf_ws_iter_t *it, gf_win_info_t **out, uint32_t max)
+{
+    uint32_t n = 0;
+    gf_win_info_t *win;
+
+    while (n < max && (win = gf_ws_iter_next (it)))
+        out[n++] = win;
+
+    return n;
 }
 
 gf_err_t
@@ -249,9 +571,47 @@ gf_window_list_init (gf_win_list_t *list, uint32_t initial_capacity)
 
     list->count = 0;
     list->capacity = initial_capacity;
+    list->index = NULL;
+    list->index_capacity = 0;
+    list->index_used = 0;
+    list->members = NULL;
+    list->members_count = 0;
+    memset (&list->stray, 0, sizeof (list->stray));
+    list->members_stale = false;
+    gf_window_index_rebuild (list);
     return GF_SUCCESS;
 }
 
+/*
+ * Refill the id table, making room for ids up to at least min_ids - 1. On
+ * allocation failure the table is dropped and lookups fall back to a scan
+ * until the next rebuild succeeds.
+ */
+static void
+gf_ws_index_rebuild (gf_ws_list_t *list, uint32_t min_ids)
+{
+    uint32_t want = list->id_index_count ? list->id_index_count : 16;
+    for (uint32_t i = 0; i < list->count; i++)
+    {
+        if (list->items[i].id >= 0 && (uint32_t)list->items[i].id >= min_ids)
+            min_ids = (uint32_t)list->items[i].id + 1;
+    }
+    while (want < min_ids)
+        want *= 2;
+
+    gf_free (list->id_index);
+    list->id_index = gf_calloc (want, sizeof (uint32_t));
+    list->id_index_count = list->id_index ? want : 0;
+    if (!list->id_index)
+        return;
+
+    for (uint32_t i = 0; i < list->count; i++)
+    {
+        if (list->items[i].id >= 0)
+            list->id_index[list->items[i].id] = i + 1;
+    }
+}
+
 void
 gf_workspace_list_cleanup (gf_ws_list_t *list)
 {
@@ -259,11 +619,41 @@ gf_workspace_list_cleanup (gf_ws_list_t *list)
         return;
 
     gf_free (list->items);
+    gf_free (list->id_index);
     list->items = NULL;
+    list->id_index = NULL;
+    list->id_index_count = 0;
     list->count = 0;
     list->capacity = 0;
 }
 
+void
+gf_workspace_list_clear (gf_ws_list_t *list)
+{
+    if (!list)
+        return;
+
+    list->count = 0;
+    if (list->id_index)
+        memset (list->id_index, 0, list->id_index_count * sizeof (uint32_t));
+}
+
+void
+gf_workspace_list_remove_at (gf_ws_list_t *list, uint32_t index)
+{
+    if (!list || index >= list->count)
+        return;
+
+    memmove (&list->items[index], &list->items[index + 1],
+             (list->count - index - 1) * sizeof (gf_ws_info_t));
+
+    list->count--;
+    memset (&list->items[list->count], 0, sizeof (gf_ws_info_t));
+
+    // Slots past index moved down by one
+    gf_ws_index_rebuild (list, 0);
+}
+
 gf_err_t
 gf_workspace_list_add (gf_ws_list_t *list, const gf_ws_info_t *workspace)
 {
@@ -287,8 +677,16 @@ gf_workspace_list_add (gf_ws_list_t *list, const gf_ws_info_t *workspace)
     }
 
     list->items[list->count] = *workspace;
+    list->items[list->count].digest = 0;
+    list->items[list->count].generation = 0;
     list->count++;
 
+    gf_ws_id_t id = workspace->id;
+    if (id >= 0 && list->id_index && (uint32_t)id < list->id_index_count)
+        list->id_index[id] = list->count;
+    else if (id >= 0)
+        gf_ws_index_rebuild (list, (uint32_t)id + 1);
+
     return GF_SUCCESS;
 }
 
@@ -298,6 +696,19 @@ gf_workspace_list_find_by_id (const gf_ws_list_t *list, gf_ws_id_t workspace_id)
     if (!list)
         return NULL;
 
+    if (list->id_index && workspace_id >= 0)
+    {
+        if ((uint32_t)workspace_id >= list->id_index_count)
+            return NULL;
+
+        uint32_t slot = list->id_index[workspace_id];
+        if (slot == 0)
+            return NULL;
+        if (slot <= list->count && list->items[slot - 1].id == workspace_id)
+            return &list->items[slot - 1];
+        // Stale entry: only possible if someone edited items directly
+    }
+
     for (uint32_t i = 0; i < list->count; i++)
     {
         if (list->items[i].id == workspace_id)
@@ -321,6 +732,9 @@ gf_workspace_list_init (gf_ws_list_t *list, uint32_t initial_capacity)
 
     list->count = 0;
     list->capacity = initial_capacity;
+    list->id_index = NULL;
+    list->id_index_count = 0;
+    gf_ws_index_rebuild (list, 0);
 
     return GF_SUCCESS;
 }
@@ -427,22 +841,13 @@ gf_workspace_list_remove_window (gf_ws_info_t *ws, gf_win_list_t *windows,
     if (!ws)
         return false;
 
-    for (uint32_t i = 0; i < windows->count; i++)
-    {
-        gf_win_info_t *w = &windows->items[i];
-
-        if (!w->is_valid)
-            continue;
-
-        if (w->id == win_id && w->workspace_id == ws->id)
-        {
-            ws->window_count--;
-            ws->available_space++;
-            return true;
-        }
-    }
+    gf_win_info_t *w = gf_window_list_find_by_window_id (windows, win_id);
+    if (!w || !w->is_valid || w->workspace_id != ws->id)
+        return false;
 
-    return false;
+    ws->window_count--;
+    ws->available_space++;
+    return true;
 }
 
 bool
@@ -452,22 +857,12 @@ gf_workspace_list_add_window (gf_ws_info_t *ws, gf_win_list_t *windows,
     if (!ws || ws->available_space <= 0)
         return false;
 
-    for (uint32_t i = 0; i < windows->count; i++)
-    {
-        gf_win_info_t *w = &windows->items[i];
-
-        if (!w->is_valid)
-            continue;
-
-        if (w->id == win_id)
-        {
-            w->workspace_id = ws->id;
-
-            ws->window_count++;
-            ws->available_space--;
-            return true;
-        }
-    }
+    gf_win_info_t *w = gf_window_list_find_by_window_id (windows, win_id);
+    if (!w || !w->is_valid)
+        return false;
 
-    return false;
+    gf_window_list_set_workspace (windows, w, ws->id);
+    ws->window_count++;
+    ws->available_space--;
+    return true;
 }
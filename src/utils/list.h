@@ -3,38 +3,114 @@
 
 #include "../core/types.h"
 
+// List slots of one workspace's windows, ascending (i.e. in list order).
+typedef struct
+{
+    uint32_t *slots;
+    uint32_t count;
+    uint32_t capacity;
+} gf_ws_members_t;
+
+// Workspace ids below this get their own membership bucket; anything else
+// (unassigned windows, ids past the table) shares the stray bucket.
+#define GF_WS_MEMBERS_LIMIT 1024
+
+/*
+ * Windows in insertion order, plus two indexes kept in step by add, remove,
+ * update and gf_window_list_set_workspace:
+ *  - an open-addressing table from handle to slot (slot + 1, 0 marks an empty
+ *    bucket);
+ *  - per-workspace member vectors, so counting a workspace is O(1) and walking
+ *    it is O(members).
+ * A list without indexes (e.g. parsed from an IPC reply) is scanned linearly.
+ * Code that changes a tracked window's workspace must go through
+ * gf_window_list_set_workspace.
+ */
 typedef struct
 {
     gf_win_info_t *items;
     uint32_t count;
     uint32_t capacity;
+    uint32_t *index;
+    uint32_t index_capacity; // power of two, at least twice capacity
+    uint32_t index_used;     // occupied buckets, including stale ones
+    gf_ws_members_t *members; // by workspace id
+    uint32_t members_count;
+    gf_ws_members_t stray;
+    bool members_stale; // an allocation failed; rebuilt on next use
 } gf_win_list_t;
 
+/*
+ * Workspaces, plus a direct-mapped table from id to slot (slot + 1, 0 marks an
+ * absent id). Ids are small and dense, so the table is sized to the largest id
+ * seen. add, remove_at and clear keep it in step; a list without one (e.g.
+ * parsed from an IPC reply) is searched linearly.
+ */
 typedef struct
 {
     gf_ws_info_t *items;
     uint32_t count;
     uint32_t capacity;
     uint32_t active_workspace[GF_MAX_MONITORS];
+    uint32_t *id_index;
+    uint32_t id_index_count;
 } gf_ws_list_t;
 
 // --- Window List Operations ---
 gf_err_t gf_window_list_add (gf_win_list_t *list, const gf_win_info_t *window);
 void gf_window_list_cleanup (gf_win_list_t *list);
+void gf_window_list_clear (gf_win_list_t *list);
 void gf_window_list_clear_update_flags (gf_win_list_t *list, gf_ws_id_t workspace_id);
 uint32_t gf_window_list_count_by_workspace (const gf_win_list_t *list,
                                             gf_ws_id_t workspace_id);
 gf_win_info_t *gf_window_list_find_by_window_id (const gf_win_list_t *list,
                                                  gf_handle_t window_id);
-gf_err_t gf_window_list_get_by_workspace (const gf_win_list_t *list,
-                                          gf_ws_id_t workspace_id,
-                                          gf_win_info_t **windows, uint32_t *count);
 gf_err_t gf_window_list_init (gf_win_list_t *list, uint32_t initial_capacity);
+
+// Candidate slots for a workspace, valid until the list changes. Ids outside
+// the member table return the shared stray bucket, and an unusable index
+// returns NULL with *count = list->count (meaning "every slot"), so callers
+// still check workspace_id; walk the result with gf_ws_slot.
+const uint32_t *gf_window_list_members (gf_win_list_t *list, gf_ws_id_t workspace_id,
+                                        uint32_t *count);
+void gf_window_list_set_workspace (gf_win_list_t *list, gf_win_info_t *win,
+                                   gf_ws_id_t workspace_id);
 void gf_window_list_mark_all_needs_update (gf_win_list_t *list,
                                            const gf_ws_id_t *workspace_id);
 gf_err_t gf_window_list_remove (gf_win_list_t *list, gf_handle_t window_id);
 gf_err_t gf_window_list_update (gf_win_list_t *list, const gf_win_info_t *window);
 
+static inline uint32_t
+gf_ws_slot (const uint32_t *slots, uint32_t k)
+{
+    return slots ? slots[k] : k;
+}
+
+/*
+ * Live view of one workspace: yields pointers into the list, in list order,
+ * optionally narrowed by a predicate. Callers read and mark windows in place.
+ * The pointers stay valid until a window is added to or removed from the list.
+ */
+typedef bool (*gf_win_pred_t) (const gf_win_info_t *win, void *ctx);
+
+typedef struct
+{
+    gf_win_list_t *list;
+    const uint32_t *slots;
+    uint32_t count;
+    uint32_t pos;
+    gf_ws_id_t workspace_id;
+    gf_win_pred_t pred; // NULL accepts every window of the workspace
+    void *ctx;
+} gf_ws_iter_t;
+
+void gf_ws_iter_init (gf_ws_iter_t *it, gf_win_list_t *list, gf_ws_id_t workspace_id,
+                      gf_win_pred_t pred, void *ctx);
+gf_win_info_t *gf_ws_iter_next (gf_ws_iter_t *it);
+
+// Gather the remaining matches (at most max) as pointers into the list.
+uint32_t gf_ws_iter_collect (gf_ws_iter_t *it, gf_win_info_t **out, uint32_t max);
+
 // --- Workspace List Operations ---
 gf_ws_id_t gf_workspace_create (gf_ws_list_t *ws, uint32_t max_win_per_ws,
                                 bool maximized_state, bool is_locked);
@@ -45,6 +121,8 @@ uint32_t gf_workspace_list_calc_required_workspaces (uint32_t total_windows,
                                                      uint32_t current_workspaces,
                                                      uint32_t max_per_workspace);
 void gf_workspace_list_cleanup (gf_ws_list_t *list);
+void gf_workspace_list_clear (gf_ws_list_t *list);
+void gf_workspace_list_remove_at (gf_ws_list_t *list, uint32_t index);
 void gf_workspace_list_ensure (gf_ws_list_t *ws, gf_ws_id_t ws_id, uint32_t max_per_ws);
 gf_ws_id_t gf_workspace_list_find_free (gf_ws_list_t *ws);
 gf_ws_info_t *gf_workspace_list_find_by_id (const gf_ws_list_t *list,
@@ -1,35 +1,344 @@
 #include "logger.h"
 #include <stdarg.h>
+#include <limits.h>
 #include <stdio.h>
 #include <time.h>
 
-static gf_log_level_t g_log_level = GF_LOG_INFO;
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+
+gf_log_level_t gf_log_threshold = GF_LOG_INFO;
 
 static const char *level_strings[] = { "ERROR", "WARN", "INFO", "DEBUG" };
 
+/*
+ * Bounded multi-producer ring (Vyukov's sequence-per-slot queue). A producer
+ * claims a slot by advancing g_log_head, formats into it, then publishes it
+ * by bumping the slot's sequence; the writer thread is the only consumer.
+ * Everything is static: the writer must never touch gf_malloc, whose error
+ * path logs.
+ */
+#define GF_LOG_RING_SLOTS 256 // power of two
+#define GF_LOG_LINE_MAX 512
+
+typedef struct
+{
+    uint32_t seq;
+    uint32_t level;
+    time_t when;
+    char text[GF_LOG_LINE_MAX];
+} gf_log_slot_t;
+
+static gf_log_slot_t g_log_ring[GF_LOG_RING_SLOTS];
+static uint32_t g_log_head;    // next slot to claim (producers)
+static uint32_t g_log_tail;    // next slot to write out (writer only)
+static uint32_t g_log_dropped; // lines lost to a full ring
+static uint32_t g_log_async;   // writer thread running
+
+#ifdef _WIN32
+static HANDLE g_log_thread;
+static HANDLE g_log_wakeup;
+#else
+static pthread_t g_log_thread;
+static sem_t g_log_wakeup;
+#endif
+
+#if defined(_MSC_VER)
+static inline uint32_t
+_log_load (uint32_t *p)
+{
+    return (uint32_t)InterlockedCompareExchange ((volatile LONG *)p, 0, 0);
+}
+
+static inline void
+_log_store (uint32_t *p, uint32_t v)
+{
+    InterlockedExchange ((volatile LONG *)p, (LONG)v);
+}
+
+static inline uint32_t
+_log_exchange (uint32_t *p, uint32_t v)
+{
+    return (uint32_t)InterlockedExchange ((volatile LONG *)p, (LONG)v);
+}
+
+static inline void
+_log_increment (uint32_t *p)
+{
+    InterlockedIncrement ((volatile LONG *)p);
+}
+
+static inline bool
+_log_cas (uint32_t *p, uint32_t expected, uint32_t desired)
+{
+    return (uint32_t)InterlockedCompareExchange ((volatile LONG *)p, (LONG)desired,
+                                                 (LONG)expected)
+           == expected;
+}
+#else
+static inline uint32_t
+_log_load (uint32_t *p)
+{
+    return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+}
+
+static inline void
+_log_store (uint32_t *p, uint32_t v)
+{
+    __atomic_store_n (p, v, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t
+_log_exchange (uint32_t *p, uint32_t v)
+{
+    return __atomic_exchange_n (p, v, __ATOMIC_ACQ_REL);
+}
+
+static inline void
+_log_increment (uint32_t *p)
+{
+    __atomic_fetch_add (p, 1, __ATOMIC_RELAXED);
+}
+
+static inline bool
+_log_cas (uint32_t *p, uint32_t expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n (p, &expected, desired, false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_RELAXED);
+}
+#endif
+
+// One write per line; the writer thread flushes once per batch instead.
+static void
+_log_write (time_t when, uint32_t level, const char *text)
+{
+    static time_t cached_when = (time_t)-1;
+    static struct tm cached_tm;
+
+    if (when != cached_when)
+    {
+#ifdef _WIN32
+        localtime_s (&cached_tm, &when);
+#else
+        localtime_r (&when, &cached_tm);
+#endif
+        cached_when = when;
+    }
+
+    printf ("[%02d:%02d:%02d] [%s] %s\n", cached_tm.tm_hour, cached_tm.tm_min,
+            cached_tm.tm_sec, level_strings[level], text);
+}
+
+// NULL when the ring is full
+static gf_log_slot_t *
+_log_claim (uint32_t *pos_out)
+{
+    uint32_t pos = _log_load (&g_log_head);
+
+    for (;;)
+    {
+        gf_log_slot_t *slot = &g_log_ring[pos & (GF_LOG_RING_SLOTS - 1)];
+        int32_t diff = (int32_t)(_log_load (&slot->seq) - pos);
+
+        if (diff == 0)
+        {
+            if (_log_cas (&g_log_head, pos, pos + 1))
+            {
+                *pos_out = pos;
+                return slot;
+            }
+        }
+        else if (diff < 0)
+            return NULL;
+
+        pos = _log_load (&g_log_head);
+    }
+}
+
+static void
+_log_wake (void)
+{
+#ifdef _WIN32
+    ReleaseSemaphore (g_log_wakeup, 1, NULL);
+#else
+    sem_post (&g_log_wakeup);
+#endif
+}
+
+static void
+_log_drain (void)
+{
+    bool wrote = false;
+
+    for (;;)
+    {
+        gf_log_slot_t *slot = &g_log_ring[g_log_tail & (GF_LOG_RING_SLOTS - 1)];
+        if (_log_load (&slot->seq) != g_log_tail + 1)
+            break;
+
+        _log_write (slot->when, slot->level, slot->text);
+        _log_store (&slot->seq, g_log_tail + GF_LOG_RING_SLOTS);
+        g_log_tail++;
+        wrote = true;
+    }
+
+    uint32_t dropped = _log_exchange (&g_log_dropped, 0);
+    if (dropped)
+    {
+        char text[64];
+        snprintf (text, sizeof (text), "Log ring full, dropped %u lines", dropped);
+        _log_write (time (NULL), GF_LOG_WARN, text);
+        wrote = true;
+    }
+
+    if (wrote)
+        fflush (stdout);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI
+_log_thread_main (LPVOID arg)
+#else
+static void *
+_log_thread_main (void *arg)
+#endif
+{
+    (void)arg;
+
+    while (_log_load (&g_log_async))
+    {
+#ifdef _WIN32
+        WaitForSingleObject (g_log_wakeup, INFINITE);
+#else
+        while (sem_wait (&g_log_wakeup) != 0)
+            ;
+#endif
+        _log_drain ();
+    }
+
+    return 0;
+}
+
 void
 gf_log_init (gf_log_level_t level)
 {
-    g_log_level = level;
+    gf_log_threshold = level;
+}
+
+gf_err_t
+gf_log_start_async (void)
+{
+    if (_log_load (&g_log_async))
+        return GF_SUCCESS;
+
+    for (uint32_t i = 0; i < GF_LOG_RING_SLOTS; i++)
+        g_log_ring[i].seq = i;
+    g_log_head = g_log_tail = g_log_dropped = 0;
+
+#ifdef _WIN32
+    g_log_wakeup = CreateSemaphoreA (NULL, 0, LONG_MAX, NULL);
+    if (!g_log_wakeup)
+        return GF_ERROR_PLATFORM_ERROR;
+
+    _log_store (&g_log_async, 1);
+    g_log_thread = CreateThread (NULL, 0, _log_thread_main, NULL, 0, NULL);
+    if (!g_log_thread)
+    {
+        _log_store (&g_log_async, 0);
+        CloseHandle (g_log_wakeup);
+        return GF_ERROR_PLATFORM_ERROR;
+    }
+#else
+    if (sem_init (&g_log_wakeup, 0, 0) != 0)
+        return GF_ERROR_PLATFORM_ERROR;
+
+    _log_store (&g_log_async, 1);
+    if (pthread_create (&g_log_thread, NULL, _log_thread_main, NULL) != 0)
+    {
+        _log_store (&g_log_async, 0);
+        sem_destroy (&g_log_wakeup);
+        return GF_ERROR_PLATFORM_ERROR;
+    }
+#endif
+
+    return GF_SUCCESS;
 }
 
 void
-gf_log (gf_log_level_t level, const char *format, ...)
+gf_log_shutdown (void)
 {
-    if (level > g_log_level)
+    if (!_log_exchange (&g_log_async, 0))
         return;
 
+    _log_wake ();
+#ifdef _WIN32
+    WaitForSingleObject (g_log_thread, INFINITE);
+    CloseHandle (g_log_thread);
+    CloseHandle (g_log_wakeup);
+#else
+    pthread_join (g_log_thread, NULL);
+    sem_destroy (&g_log_wakeup);
+#endif
+
+    // Lines published while the writer was exiting
+    _log_drain ();
+}
+
+bool
+gf_log_ratelimit (gf_log_limit_t *limit, uint32_t interval_s, gf_log_level_t level,
+                  const char *format)
+{
     time_t now = time (NULL);
-    struct tm *tm_info = localtime (&now);
 
-    printf ("[%02d:%02d:%02d] [%s] ", tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec,
-            level_strings[level]);
+    if (limit->last && now - limit->last < (time_t)interval_s)
+    {
+        limit->suppressed++;
+        return false;
+    }
+
+    if (limit->suppressed)
+        gf_log (level, "Suppressed %u repeats of \"%s\"", limit->suppressed, format);
+
+    limit->last = now;
+    limit->suppressed = 0;
+    return true;
+}
+
+void
+gf_log (gf_log_level_t level, const char *format, ...)
+{
+    if (level > gf_log_threshold)
+        return;
 
     va_list args;
     va_start (args, format);
-    vprintf (format, args);
-    va_end (args);
 
-    printf ("\n");
-    fflush (stdout);
+    if (_log_load (&g_log_async))
+    {
+        uint32_t pos;
+        gf_log_slot_t *slot = _log_claim (&pos);
+        if (slot)
+        {
+            slot->level = level;
+            slot->when = time (NULL);
+            vsnprintf (slot->text, sizeof (slot->text), format, args);
+            _log_store (&slot->seq, pos + 1);
+            _log_wake ();
+        }
+        else
+            _log_increment (&g_log_dropped);
+    }
+    else
+    {
+        char text[GF_LOG_LINE_MAX];
+        vsnprintf (text, sizeof (text), format, args);
+        _log_write (time (NULL), level, text);
+        fflush (stdout);
+    }
+
+    va_end (args);
 }
@@ -3,12 +3,74 @@
 
 #include "../core/types.h"
 
+/*
+ * Least severe level compiled in. Calls past it are constant-false branches,
+ * so they and their arguments vanish from the binary; release (NDEBUG)
+ * builds drop DEBUG unless GF_LOG_MIN_LEVEL is given explicitly.
+ */
+#ifndef GF_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define GF_LOG_MIN_LEVEL GF_LOG_INFO
+#else
+#define GF_LOG_MIN_LEVEL GF_LOG_DEBUG
+#endif
+#endif
+
+// Runtime level set by gf_log_init. The macros test it before evaluating
+// any argument, so a filtered call costs one comparison.
+extern gf_log_level_t gf_log_threshold;
+
 void gf_log_init (gf_log_level_t level);
 void gf_log (gf_log_level_t level, const char *format, ...);
 
-#define GF_LOG_ERROR(...) gf_log (GF_LOG_ERROR, __VA_ARGS__)
-#define GF_LOG_WARN(...) gf_log (GF_LOG_WARN, __VA_ARGS__)
-#define GF_LOG_INFO(...) gf_log (GF_LOG_INFO, __VA_ARGS__)
-#define GF_LOG_DEBUG(...) gf_log (GF_LOG_DEBUG, __VA_ARGS__)
+/*
+ * Asynchronous mode: gf_log formats straight into a preallocated lock-free
+ * ring and a background thread does the writing, so logging never blocks on
+ * stdout. When the ring is full lines are dropped and counted rather than
+ * waited for. gf_log_shutdown drains the ring, stops the thread and returns
+ * to synchronous writes; without gf_log_start_async every line is written
+ * by the caller.
+ */
+gf_err_t gf_log_start_async (void);
+void gf_log_shutdown (void);
+
+typedef struct
+{
+    time_t last;
+    uint32_t suppressed;
+} gf_log_limit_t;
+
+// True when a rate-limited line may go out now. Reports how many were
+// suppressed since the last one that did.
+bool gf_log_ratelimit (gf_log_limit_t *limit, uint32_t interval_s, gf_log_level_t level,
+                       const char *format);
+
+#define GF_LOG_ENABLED(level) ((level) <= GF_LOG_MIN_LEVEL && (level) <= gf_log_threshold)
+
+#define GF_LOG_AT(level, ...)                                                          \
+    do                                                                                 \
+    {                                                                                  \
+        if (GF_LOG_ENABLED (level))                                                    \
+            gf_log ((level), __VA_ARGS__);                                             \
+    } while (0)
+
+#define GF_LOG_ERROR(...) GF_LOG_AT (GF_LOG_ERROR, __VA_ARGS__)
+#define GF_LOG_WARN(...) GF_LOG_AT (GF_LOG_WARN, __VA_ARGS__)
+#define GF_LOG_INFO(...) GF_LOG_AT (GF_LOG_INFO, __VA_ARGS__)
+#define GF_LOG_DEBUG(...) GF_LOG_AT (GF_LOG_DEBUG, __VA_ARGS__)
+
+#define GF_LOG_FORMAT_(format, ...) format
+
+// At most one line per interval_s seconds from this call site, for messages
+// that would otherwise repeat every tick.
+#define GF_LOG_RATELIMIT(level, interval_s, ...)                                       \
+    do                                                                                 \
+    {                                                                                  \
+        static gf_log_limit_t gf_log_limit_;                                           \
+        if (GF_LOG_ENABLED (level)                                                     \
+            && gf_log_ratelimit (&gf_log_limit_, (interval_s), (level),                \
+                                 GF_LOG_FORMAT_ (__VA_ARGS__, 0)))                     \
+            gf_log ((level), __VA_ARGS__);                                             \
+    } while (0)
 
 #endif // GF_CORE_LOGGER_H
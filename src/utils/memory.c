@@ -1,15 +1,156 @@
 #include "memory.h"
 #include "logger.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+/*
+ * Besides the main thread, the GUI's worker threads allocate through the IPC
+ * response path, so the counters below are only touched through these
+ * helpers. Relaxed ordering is enough: they are statistics, not locks.
+ * _mem_raise lifts a peak unless another thread already recorded more.
+ */
+#if defined(_MSC_VER)
+static inline uint64_t
+_mem_add (uint64_t *p, uint64_t v)
+{
+    return (uint64_t)InterlockedExchangeAdd64 ((volatile LONG64 *)p, (LONG64)v) + v;
+}
+
+static inline uint64_t
+_mem_load (uint64_t *p)
+{
+    return (uint64_t)InterlockedCompareExchange64 ((volatile LONG64 *)p, 0, 0);
+}
+
+static inline void
+_mem_raise (uint64_t *p, uint64_t v)
+{
+    uint64_t seen = _mem_load (p);
+    while (v > seen)
+    {
+        uint64_t prev = (uint64_t)InterlockedCompareExchange64 ((volatile LONG64 *)p,
+                                                                (LONG64)v, (LONG64)seen);
+        if (prev == seen)
+            break;
+        seen = prev;
+    }
+}
+#else
+static inline uint64_t
+_mem_add (uint64_t *p, uint64_t v)
+{
+    return __atomic_add_fetch (p, v, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t
+_mem_load (uint64_t *p)
+{
+    return __atomic_load_n (p, __ATOMIC_RELAXED);
+}
+
+static inline void
+_mem_raise (uint64_t *p, uint64_t v)
+{
+    uint64_t seen = _mem_load (p);
+    while (v > seen
+           && !__atomic_compare_exchange_n (p, &seen, v, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+        ;
+}
+#endif
+
+static uint64_t g_alloc_count;
+
+#define GF_MEM_ALIGN 16
+#define GF_MEM_ROUND(n) (((n) + GF_MEM_ALIGN - 1) & ~(size_t)(GF_MEM_ALIGN - 1))
+
+#ifdef GF_MEM_TRACKING
+
+/*
+ * Each block is preceded by a header recording its size and tag, padded so
+ * the caller still gets GF_MEM_ALIGN alignment.
+ */
+#define GF_MEM_MAGIC 0x6766a11cu
+#define GF_MEM_FREED 0x6766f4eeu
+
+typedef struct
+{
+    size_t size;
+    uint32_t tag;
+    uint32_t magic;
+} gf_mem_header_t;
+
+#define GF_MEM_HEADER GF_MEM_ROUND (sizeof (gf_mem_header_t))
+
+static gf_mem_stats_t g_mem_stats[GF_MEM_TAG_COUNT];
+
+static void
+_mem_charge (gf_mem_tag_t tag, size_t size)
+{
+    gf_mem_stats_t *stats = &g_mem_stats[tag];
+    _mem_add (&stats->allocs, 1);
+    _mem_raise (&stats->peak_bytes, _mem_add (&stats->live_bytes, size));
+}
+
+static void
+_mem_credit (gf_mem_tag_t tag, size_t size)
+{
+    gf_mem_stats_t *stats = &g_mem_stats[tag];
+    _mem_add (&stats->frees, 1);
+    _mem_add (&stats->live_bytes, (uint64_t)0 - size);
+}
+
+static void *
+_mem_attach (void *raw, size_t size, gf_mem_tag_t tag)
+{
+    if (!raw)
+        return NULL;
+
+    gf_mem_header_t *header = raw;
+    header->size = size;
+    header->tag = tag < GF_MEM_TAG_COUNT ? tag : GF_MEM_TAG_OTHER;
+    header->magic = GF_MEM_MAGIC;
+    _mem_charge (header->tag, size);
+    return (char *)raw + GF_MEM_HEADER;
+}
+
+// NULL (and an error) for a block that did not come from the gf allocators
+// or was already freed; leaking it beats corrupting the heap.
+static gf_mem_header_t *
+_mem_header (void *ptr)
+{
+    gf_mem_header_t *header = (gf_mem_header_t *)((char *)ptr - GF_MEM_HEADER);
+    if (header->magic != GF_MEM_MAGIC)
+    {
+        GF_LOG_ERROR ("gf_free: %p is not a live gf allocation (%s)", ptr,
+                      header->magic == GF_MEM_FREED ? "double free" : "bad header");
+        return NULL;
+    }
+    return header;
+}
+
+#endif // GF_MEM_TRACKING
+
 void *
-gf_malloc (size_t size)
+gf_malloc_tagged (size_t size, gf_mem_tag_t tag)
 {
     if (size == 0)
         return NULL;
 
+    _mem_add (&g_alloc_count, 1);
+#ifdef GF_MEM_TRACKING
+    void *ptr = NULL;
+    if (size <= SIZE_MAX - GF_MEM_HEADER)
+        ptr = _mem_attach (malloc (GF_MEM_HEADER + size), size, tag);
+#else
+    (void)tag;
     void *ptr = malloc (size);
+#endif
     if (!ptr)
     {
         GF_LOG_ERROR ("Memory allocation failed for size %zu", size);
@@ -18,12 +159,20 @@ gf_malloc (size_t size)
 }
 
 void *
-gf_calloc (size_t count, size_t size)
+gf_calloc_tagged (size_t count, size_t size, gf_mem_tag_t tag)
 {
     if (count == 0 || size == 0)
         return NULL;
 
+    _mem_add (&g_alloc_count, 1);
+#ifdef GF_MEM_TRACKING
+    void *ptr = NULL;
+    if (count <= (SIZE_MAX - GF_MEM_HEADER) / size)
+        ptr = _mem_attach (calloc (1, GF_MEM_HEADER + count * size), count * size, tag);
+#else
+    (void)tag;
     void *ptr = calloc (count, size);
+#endif
     if (!ptr)
     {
         GF_LOG_ERROR ("Memory allocation failed for %zu items of size %zu", count, size);
@@ -32,27 +181,250 @@ gf_calloc (size_t count, size_t size)
 }
 
 void *
-gf_realloc (void *ptr, size_t size)
+gf_realloc_tagged (void *ptr, size_t size, gf_mem_tag_t tag)
 {
     if (size == 0)
     {
-        free (ptr);
+        gf_free (ptr);
         return NULL;
     }
 
+#ifdef GF_MEM_TRACKING
+    if (!ptr)
+        return gf_malloc_tagged (size, tag);
+
+    gf_mem_header_t *header = _mem_header (ptr);
+    if (!header)
+        return NULL;
+
+    // The block stays charged to the subsystem that first allocated it
+    gf_mem_header_t old = *header;
+    _mem_add (&g_alloc_count, 1);
+    void *raw = NULL;
+    if (size <= SIZE_MAX - GF_MEM_HEADER)
+        raw = realloc (header, GF_MEM_HEADER + size);
+    if (!raw)
+    {
+        GF_LOG_ERROR ("Memory reallocation failed for size %zu", size);
+        return NULL;
+    }
+    _mem_credit (old.tag, old.size);
+    return _mem_attach (raw, size, old.tag);
+#else
+    (void)tag;
+    _mem_add (&g_alloc_count, 1);
     void *new_ptr = realloc (ptr, size);
     if (!new_ptr)
     {
         GF_LOG_ERROR ("Memory reallocation failed for size %zu", size);
-        return ptr; // Return original pointer on failure
+        return NULL;
     }
     return new_ptr;
+#endif
 }
 
 void
 gf_free (void *ptr)
 {
+#ifdef GF_MEM_TRACKING
+    if (!ptr)
+        return;
+
+    gf_mem_header_t *header = _mem_header (ptr);
+    if (!header)
+        return;
+
+    _mem_credit (header->tag, header->size);
+    header->magic = GF_MEM_FREED;
+    free (header);
+#else
     free (ptr);
+#endif
+}
+
+uint64_t
+gf_mem_alloc_count (void)
+{
+    return _mem_load (&g_alloc_count);
+}
+
+bool
+gf_mem_tracking_enabled (void)
+{
+#ifdef GF_MEM_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+gf_mem_stats (gf_mem_tag_t tag, gf_mem_stats_t *out)
+{
+    memset (out, 0, sizeof (*out));
+#ifdef GF_MEM_TRACKING
+    if (tag < GF_MEM_TAG_COUNT)
+    {
+        gf_mem_stats_t *stats = &g_mem_stats[tag];
+        out->live_bytes = _mem_load (&stats->live_bytes);
+        out->peak_bytes = _mem_load (&stats->peak_bytes);
+        out->allocs = _mem_load (&stats->allocs);
+        out->frees = _mem_load (&stats->frees);
+    }
+#else
+    (void)tag;
+#endif
+}
+
+const char *
+gf_mem_tag_name (gf_mem_tag_t tag)
+{
+    static const char *const names[GF_MEM_TAG_COUNT] = {
+        [GF_MEM_TAG_OTHER] = "other",
+        [GF_MEM_TAG_LIST] = "list",
+        [GF_MEM_TAG_LAYOUT] = "layout",
+        [GF_MEM_TAG_PLATFORM] = "platform",
+        [GF_MEM_TAG_IPC] = "ipc",
+        [GF_MEM_TAG_CONFIG] = "config",
+        [GF_MEM_TAG_BORDER] = "border",
+        [GF_MEM_TAG_GUI] = "gui",
+        [GF_MEM_TAG_SCRATCH] = "scratch",
+    };
+    return tag < GF_MEM_TAG_COUNT ? names[tag] : "?";
+}
+
+uint64_t
+gf_mem_report_leaks (void)
+{
+    uint64_t blocks = 0;
+
+    for (uint32_t tag = 0; tag < GF_MEM_TAG_COUNT; tag++)
+    {
+        gf_mem_stats_t stats;
+        gf_mem_stats ((gf_mem_tag_t)tag, &stats);
+        if (stats.allocs == stats.frees)
+            continue;
+
+        GF_LOG_WARN ("Leak: %s still holds %llu blocks (%llu bytes)",
+                     gf_mem_tag_name ((gf_mem_tag_t)tag),
+                     (unsigned long long)(stats.allocs - stats.frees),
+                     (unsigned long long)stats.live_bytes);
+        blocks += stats.allocs - stats.frees;
+    }
+
+    return blocks;
+}
+
+#define GF_SCRATCH_MIN_BLOCK (16 * 1024)
+
+typedef struct gf_scratch_block
+{
+    struct gf_scratch_block *prev;
+    size_t size;
+    size_t used;
+} gf_scratch_block_t;
+
+// Block payloads start at this offset so every allocation stays aligned
+#define GF_SCRATCH_HEADER GF_MEM_ROUND (sizeof (gf_scratch_block_t))
+
+static gf_scratch_block_t *g_scratch; // newest block; older ones chain via prev
+static size_t g_scratch_used;         // bytes handed out since the last reset
+static size_t g_scratch_high_water;
+
+static gf_scratch_block_t *
+_scratch_block_new (size_t size, gf_scratch_block_t *prev)
+{
+    gf_scratch_block_t *block
+        = gf_malloc_tagged (GF_SCRATCH_HEADER + size, GF_MEM_TAG_SCRATCH);
+    if (!block)
+        return NULL;
+
+    block->prev = prev;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+void *
+gf_scratch_alloc (size_t size)
+{
+    if (size == 0)
+        return NULL;
+
+    size = GF_MEM_ROUND (size);
+
+    if (!g_scratch || g_scratch->size - g_scratch->used < size)
+    {
+        size_t block_size = g_scratch ? g_scratch->size * 2 : GF_SCRATCH_MIN_BLOCK;
+        while (block_size < size)
+            block_size *= 2;
+
+        gf_scratch_block_t *block = _scratch_block_new (block_size, g_scratch);
+        if (!block)
+            return NULL;
+        g_scratch = block;
+    }
+
+    void *ptr = (char *)g_scratch + GF_SCRATCH_HEADER + g_scratch->used;
+    g_scratch->used += size;
+    g_scratch_used += size;
+    if (g_scratch_used > g_scratch_high_water)
+        g_scratch_high_water = g_scratch_used;
+    return ptr;
+}
+
+void *
+gf_scratch_calloc (size_t count, size_t size)
+{
+    if (count == 0 || size == 0 || count > SIZE_MAX / size)
+        return NULL;
+
+    void *ptr = gf_scratch_alloc (count * size);
+    if (ptr)
+        memset (ptr, 0, count * size);
+    return ptr;
+}
+
+// If the tick spilled over into several blocks, replace them with one block
+// big enough for all of it, so the next tick like it allocates nothing.
+void
+gf_scratch_reset (void)
+{
+    if (!g_scratch)
+        return;
+
+    g_scratch_used = 0;
+
+    if (!g_scratch->prev)
+    {
+        g_scratch->used = 0;
+        return;
+    }
+
+    size_t total = 0;
+    for (gf_scratch_block_t *b = g_scratch; b; b = b->prev)
+        total += b->size;
+
+    gf_scratch_cleanup ();
+    g_scratch = _scratch_block_new (total, NULL);
+}
+
+size_t
+gf_scratch_high_water (void)
+{
+    return g_scratch_high_water;
+}
+
+void
+gf_scratch_cleanup (void)
+{
+    while (g_scratch)
+    {
+        gf_scratch_block_t *prev = g_scratch->prev;
+        gf_free (g_scratch);
+        g_scratch = prev;
+    }
+    g_scratch_used = 0;
 }
 
 char *
@@ -4,12 +4,78 @@
 
 #include "../core/types.h"
 
-// Safe memory operations
-void *gf_malloc (size_t size);
-void *gf_calloc (size_t count, size_t size);
-void *gf_realloc (void *ptr, size_t size);
+/*
+ * Allocation accounting. Every gf_malloc/gf_calloc/gf_realloc is charged to
+ * the subsystem tag of the translation unit that made it: a source file
+ * defines GF_MEM_TAG before its includes, anything else counts as "other".
+ * A block keeps its tag for life, so gf_free and gf_realloc credit the
+ * subsystem that allocated it no matter who releases it.
+ *
+ * With GF_MEM_TRACKING off the blocks carry no header and only the global
+ * allocation count is kept.
+ */
+typedef enum
+{
+    GF_MEM_TAG_OTHER = 0,
+    GF_MEM_TAG_LIST,
+    GF_MEM_TAG_LAYOUT,
+    GF_MEM_TAG_PLATFORM,
+    GF_MEM_TAG_IPC,
+    GF_MEM_TAG_CONFIG,
+    GF_MEM_TAG_BORDER,
+    GF_MEM_TAG_GUI,
+    GF_MEM_TAG_SCRATCH,
+    GF_MEM_TAG_COUNT,
+} gf_mem_tag_t;
+
+#ifndef GF_MEM_TAG
+#define GF_MEM_TAG GF_MEM_TAG_OTHER
+#endif
+
+typedef struct
+{
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    uint64_t allocs;
+    uint64_t frees;
+} gf_mem_stats_t;
+
+// Safe memory operations. Like realloc, gf_realloc returns NULL on failure and
+// leaves the original block allocated and unchanged.
+void *gf_malloc_tagged (size_t size, gf_mem_tag_t tag);
+void *gf_calloc_tagged (size_t count, size_t size, gf_mem_tag_t tag);
+void *gf_realloc_tagged (void *ptr, size_t size, gf_mem_tag_t tag);
 void gf_free (void *ptr);
 
+#define gf_malloc(size) gf_malloc_tagged ((size), GF_MEM_TAG)
+#define gf_calloc(count, size) gf_calloc_tagged ((count), (size), GF_MEM_TAG)
+#define gf_realloc(ptr, size) gf_realloc_tagged ((ptr), (size), GF_MEM_TAG)
+
+// Heap allocations made through gf_malloc/gf_calloc/gf_realloc so far.
+uint64_t gf_mem_alloc_count (void);
+
+// False when built without GF_MEM_TRACKING; the per-tag stats are then zero.
+bool gf_mem_tracking_enabled (void);
+void gf_mem_stats (gf_mem_tag_t tag, gf_mem_stats_t *out);
+const char *gf_mem_tag_name (gf_mem_tag_t tag);
+
+// Log every tag that still holds live blocks. Returns the number of blocks.
+uint64_t gf_mem_report_leaks (void);
+
+/*
+ * Per-tick scratch arena for transient buffers (enumeration results, layout
+ * copies, geometry arrays). Allocation is a pointer bump; everything is
+ * released at once by gf_scratch_reset at the end of each tick, so scratch
+ * memory must never be passed to gf_free or kept across ticks. Once the arena
+ * has grown to a tick's high-water mark it stops touching the heap. Unlike
+ * gf_malloc it is not thread-safe: only the main thread's tick uses it.
+ */
+void *gf_scratch_alloc (size_t size);
+void *gf_scratch_calloc (size_t count, size_t size);
+void gf_scratch_reset (void);
+size_t gf_scratch_high_water (void);
+void gf_scratch_cleanup (void);
+
 // String operations
 char *gf_strdup (const char *str);
 gf_err_t gf_safe_strcpy (char *dest, size_t dest_size, const char *src);
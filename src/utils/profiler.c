@@ -0,0 +1,151 @@
+#include "profiler.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+uint64_t
+gf_prof_now_ns (void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency (&freq);
+    QueryPerformanceCounter (&now);
+
+    uint64_t secs = (uint64_t)(now.QuadPart / freq.QuadPart);
+    uint64_t rem = (uint64_t)(now.QuadPart % freq.QuadPart);
+    return secs * 1000000000ull + rem * 1000000000ull / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t
+_prof_msb (uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - (uint32_t)__builtin_clzll (v);
+#else
+    uint32_t msb = 0;
+    while (v >>= 1)
+        msb++;
+    return msb;
+#endif
+}
+
+// Values below GF_PROF_SUB map to themselves; above that, bucket
+// (shift + 1) * SUB + sub covers [(SUB + sub) << shift, (SUB + sub + 1) << shift).
+static uint32_t
+_prof_bucket (uint64_t ns)
+{
+    if (ns < GF_PROF_SUB)
+        return (uint32_t)ns;
+
+    uint32_t shift = _prof_msb (ns) - GF_PROF_SUB_BITS;
+    uint32_t sub = (uint32_t)(ns >> shift) & (GF_PROF_SUB - 1);
+    uint32_t index = (shift + 1) * GF_PROF_SUB + sub;
+
+    return index < GF_PROF_BUCKETS ? index : GF_PROF_BUCKETS - 1;
+}
+
+static uint64_t
+_prof_bucket_upper (uint32_t index)
+{
+    if (index < GF_PROF_SUB)
+        return index;
+
+    uint32_t shift = index / GF_PROF_SUB - 1;
+    uint64_t sub = index % GF_PROF_SUB;
+    return ((GF_PROF_SUB + sub + 1) << shift) - 1;
+}
+
+void
+gf_prof_record (gf_prof_hist_t *hist, uint64_t ns)
+{
+    hist->count++;
+    hist->total_ns += ns;
+    if (ns > hist->max_ns)
+        hist->max_ns = ns;
+    hist->buckets[_prof_bucket (ns)]++;
+}
+
+void
+gf_prof_reset (gf_prof_hist_t *hist)
+{
+    memset (hist, 0, sizeof (*hist));
+}
+
+uint64_t
+gf_prof_percentile (const gf_prof_hist_t *hist, uint32_t per_mille)
+{
+    if (hist->count == 0)
+        return 0;
+
+    // Rank of the sample at this percentile, rounded up, 1-based
+    uint64_t rank = (hist->count * per_mille + 999) / 1000;
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < GF_PROF_BUCKETS; i++)
+    {
+        seen += hist->buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t upper = _prof_bucket_upper (i);
+            return upper < hist->max_ns ? upper : hist->max_ns;
+        }
+    }
+
+    return hist->max_ns;
+}
+
+static uint64_t g_prof_calls[GF_PROF_SCOPE_MAX][GF_PROF_CALL_COUNT];
+static uint32_t g_prof_scope = GF_PROF_SCOPE_IDLE;
+
+void
+gf_prof_set_scope (uint32_t scope)
+{
+    g_prof_scope = scope < GF_PROF_SCOPE_MAX ? scope : GF_PROF_SCOPE_IDLE;
+}
+
+void
+gf_prof_count (gf_prof_call_t call, uint32_t n)
+{
+    g_prof_calls[g_prof_scope][call] += n;
+}
+
+uint64_t
+gf_prof_calls (uint32_t scope, gf_prof_call_t call)
+{
+    if (scope >= GF_PROF_SCOPE_MAX || call >= GF_PROF_CALL_COUNT)
+        return 0;
+    return g_prof_calls[scope][call];
+}
+
+const char *
+gf_prof_call_name (gf_prof_call_t call)
+{
+    static const char *const names[GF_PROF_CALL_COUNT] = {
+        [GF_PROF_CALL_ROUND_TRIP] = "round_trips",
+        [GF_PROF_CALL_PROPERTY] = "properties",
+        [GF_PROF_CALL_CLIENT_MESSAGE] = "client_msgs",
+        [GF_PROF_CALL_SYNC] = "syncs",
+        [GF_PROF_CALL_FLUSH] = "flushes",
+    };
+    return call < GF_PROF_CALL_COUNT ? names[call] : "?";
+}
+
+void
+gf_prof_calls_reset (void)
+{
+    memset (g_prof_calls, 0, sizeof (g_prof_calls));
+}
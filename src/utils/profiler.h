@@ -0,0 +1,58 @@
+#ifndef GF_UTILS_PROFILER_H
+#define GF_UTILS_PROFILER_H
+
+#include <stdint.h>
+
+/*
+ * Fixed-bucket latency histogram. Each power of two is split into
+ * GF_PROF_SUB linear sub-buckets, so a reported percentile is within 25% of
+ * the true value while recording stays a clock read and an increment.
+ */
+#define GF_PROF_SUB_BITS 2
+#define GF_PROF_SUB (1u << GF_PROF_SUB_BITS)
+#define GF_PROF_OCTAVES 40
+#define GF_PROF_BUCKETS (GF_PROF_OCTAVES * GF_PROF_SUB)
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t buckets[GF_PROF_BUCKETS];
+} gf_prof_hist_t;
+
+// Monotonic clock in nanoseconds.
+uint64_t gf_prof_now_ns (void);
+
+void gf_prof_record (gf_prof_hist_t *hist, uint64_t ns);
+void gf_prof_reset (gf_prof_hist_t *hist);
+
+// Upper bound of the bucket holding the given percentile (per mille: 500 is
+// p50, 990 is p99), capped at the observed maximum. 0 for an empty histogram.
+uint64_t gf_prof_percentile (const gf_prof_hist_t *hist, uint32_t per_mille);
+
+/*
+ * Display-server call counters. The platform layer counts its blocking calls
+ * and they are charged to the scope the caller set last (the core uses its
+ * tick phases; GF_PROF_SCOPE_IDLE covers everything outside a phase).
+ */
+typedef enum
+{
+    GF_PROF_CALL_ROUND_TRIP = 0, // any request that waits for a reply
+    GF_PROF_CALL_PROPERTY,       // property fetches (also counted as round-trips)
+    GF_PROF_CALL_CLIENT_MESSAGE,
+    GF_PROF_CALL_SYNC,
+    GF_PROF_CALL_FLUSH,
+    GF_PROF_CALL_COUNT,
+} gf_prof_call_t;
+
+#define GF_PROF_SCOPE_MAX 16
+#define GF_PROF_SCOPE_IDLE (GF_PROF_SCOPE_MAX - 1)
+
+void gf_prof_set_scope (uint32_t scope);
+void gf_prof_count (gf_prof_call_t call, uint32_t n);
+uint64_t gf_prof_calls (uint32_t scope, gf_prof_call_t call);
+const char *gf_prof_call_name (gf_prof_call_t call);
+void gf_prof_calls_reset (void);
+
+#endif // GF_UTILS_PROFILER_H
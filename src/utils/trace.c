@@ -0,0 +1,223 @@
+#include "trace.h"
+#include "logger.h"
+#include "memory.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define GF_TRACE_NAME_MAX 31
+
+typedef struct
+{
+    uint64_t start_ns;
+    uint64_t dur_ns;
+    uint8_t cat;
+    char name[GF_TRACE_NAME_MAX];
+} gf_trace_event_t;
+
+static gf_trace_event_t *g_trace_ring;
+static uint32_t g_trace_capacity;
+static uint64_t g_trace_total; // spans recorded since start; slot is total % capacity
+static uint64_t g_trace_origin_ns;
+static bool g_trace_on;
+
+static const char *const trace_cat_names[GF_TRACE_CAT_COUNT] = {
+    [GF_TRACE_TICK] = "tick",
+    [GF_TRACE_PLATFORM] = "platform",
+    [GF_TRACE_IPC] = "ipc",
+};
+
+gf_err_t
+gf_trace_start (uint32_t capacity)
+{
+    if (capacity == 0)
+        capacity = GF_TRACE_DEFAULT_EVENTS;
+    if (capacity > GF_TRACE_MAX_EVENTS)
+        capacity = GF_TRACE_MAX_EVENTS;
+
+    if (capacity != g_trace_capacity)
+    {
+        gf_trace_event_t *ring = gf_malloc (capacity * sizeof (gf_trace_event_t));
+        if (!ring)
+            return GF_ERROR_MEMORY_ALLOCATION;
+        gf_free (g_trace_ring);
+        g_trace_ring = ring;
+        g_trace_capacity = capacity;
+    }
+
+    g_trace_total = 0;
+    g_trace_origin_ns = gf_prof_now_ns ();
+    g_trace_on = true;
+    return GF_SUCCESS;
+}
+
+void
+gf_trace_stop (void)
+{
+    g_trace_on = false;
+}
+
+bool
+gf_trace_active (void)
+{
+    return g_trace_on;
+}
+
+uint32_t
+gf_trace_count (void)
+{
+    return g_trace_total < g_trace_capacity ? (uint32_t)g_trace_total : g_trace_capacity;
+}
+
+uint64_t
+gf_trace_begin (void)
+{
+    return g_trace_on ? gf_prof_now_ns () : 0;
+}
+
+void
+gf_trace_end (gf_trace_cat_t cat, const char *name, uint64_t start_ns)
+{
+    if (!g_trace_on || start_ns == 0)
+        return;
+
+    gf_trace_record (cat, name, start_ns, gf_prof_now_ns () - start_ns);
+}
+
+void
+gf_trace_record (gf_trace_cat_t cat, const char *name, uint64_t start_ns,
+                 uint64_t dur_ns)
+{
+    if (!g_trace_on || !name)
+        return;
+
+    gf_trace_event_t *ev = &g_trace_ring[g_trace_total++ % g_trace_capacity];
+    ev->start_ns = start_ns;
+    ev->dur_ns = dur_ns;
+    ev->cat = (uint8_t)cat;
+    strncpy (ev->name, name, sizeof (ev->name) - 1);
+    ev->name[sizeof (ev->name) - 1] = '\0';
+}
+
+// Names can come from IPC clients, so escape anything JSON would choke on.
+static void
+_trace_write_string (FILE *f, const char *s)
+{
+    fputc ('"', f);
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf (f, "\\%c", c);
+        else if (c < 0x20)
+            fprintf (f, "\\u%04x", c);
+        else
+            fputc (c, f);
+    }
+    fputc ('"', f);
+}
+
+static void
+_trace_default_path (char *buffer, size_t size)
+{
+#ifdef _WIN32
+    char dir[MAX_PATH];
+    DWORD len = GetTempPathA (sizeof (dir), dir);
+    if (len == 0 || len >= sizeof (dir))
+        snprintf (dir, sizeof (dir), ".\\");
+    snprintf (buffer, size, "%sgridflux-trace.json", dir);
+#else
+    // The runtime directory is private to the user, unlike a shared /tmp
+    const char *dir = getenv ("XDG_RUNTIME_DIR");
+    if (!dir || !dir[0] || access (dir, W_OK) != 0)
+        dir = getenv ("TMPDIR");
+    snprintf (buffer, size, "%s/gridflux-trace.json", (dir && dir[0]) ? dir : "/tmp");
+#endif
+}
+
+static FILE *
+_trace_open (const char *path)
+{
+#ifdef _WIN32
+    return fopen (path, "w");
+#else
+    // Never follow a symlink someone planted at a predictable temp path
+    int fd = open (path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return NULL;
+
+    FILE *f = fdopen (fd, "w");
+    if (!f)
+        close (fd);
+    return f;
+#endif
+}
+
+gf_err_t
+gf_trace_write (const char *path, char *out_path, size_t out_size)
+{
+    char default_path[512];
+    if (!path || !path[0])
+    {
+        _trace_default_path (default_path, sizeof (default_path));
+        path = default_path;
+    }
+    if (out_path && out_size)
+        snprintf (out_path, out_size, "%s", path);
+
+    FILE *f = _trace_open (path);
+    if (!f)
+    {
+        GF_LOG_ERROR ("Failed to open trace file %s", path);
+        return GF_ERROR_INVALID_PARAMETER;
+    }
+
+    fprintf (f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf (f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                "\"args\":{\"name\":\"gridflux\"}}");
+
+    // Oldest first: once the ring has wrapped that is the slot after the newest
+    uint32_t count = gf_trace_count ();
+    uint64_t first = g_trace_total - count;
+    for (uint64_t i = first; i < g_trace_total; i++)
+    {
+        const gf_trace_event_t *ev = &g_trace_ring[i % g_trace_capacity];
+        double ts_us = (double)(int64_t)(ev->start_ns - g_trace_origin_ns) / 1000.0;
+
+        fprintf (f, ",\n{\"name\":");
+        _trace_write_string (f, ev->name);
+        fprintf (f, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,"
+                    "\"tid\":1}",
+                 ev->cat < GF_TRACE_CAT_COUNT ? trace_cat_names[ev->cat] : "?", ts_us,
+                 (double)ev->dur_ns / 1000.0);
+    }
+
+    fprintf (f, "\n]}\n");
+    bool failed = ferror (f) != 0;
+    if (fclose (f) != 0 || failed)
+    {
+        GF_LOG_ERROR ("Failed to write trace file %s", path);
+        return GF_ERROR_PLATFORM_ERROR;
+    }
+
+    GF_LOG_INFO ("Wrote %u trace events to %s", count, path);
+    return GF_SUCCESS;
+}
+
+void
+gf_trace_cleanup (void)
+{
+    g_trace_on = false;
+    gf_free (g_trace_ring);
+    g_trace_ring = NULL;
+    g_trace_capacity = 0;
+    g_trace_total = 0;
+}
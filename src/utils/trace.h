@@ -0,0 +1,45 @@
+#ifndef GF_UTILS_TRACE_H
+#define GF_UTILS_TRACE_H
+
+#include "../core/types.h"
+
+/*
+ * Span recorder for Chrome/Perfetto trace export. While tracing is on every
+ * recorded span lands in a fixed ring that overwrites its oldest entries, so
+ * a long session keeps the most recent history. gf_trace_write dumps the ring
+ * as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * When tracing is off gf_trace_begin is a flag test and recording is a no-op.
+ */
+typedef enum
+{
+    GF_TRACE_TICK = 0,
+    GF_TRACE_PLATFORM,
+    GF_TRACE_IPC,
+    GF_TRACE_CAT_COUNT,
+} gf_trace_cat_t;
+
+#define GF_TRACE_DEFAULT_EVENTS 65536
+#define GF_TRACE_MAX_EVENTS (1u << 20) // larger requests are clamped
+
+gf_err_t gf_trace_start (uint32_t capacity);
+void gf_trace_stop (void);
+bool gf_trace_active (void);
+// Spans held in the ring (at most its capacity).
+uint32_t gf_trace_count (void);
+
+// Start timestamp for gf_trace_end; 0 while tracing is off.
+uint64_t gf_trace_begin (void);
+void gf_trace_end (gf_trace_cat_t cat, const char *name, uint64_t start_ns);
+// Record a span whose bounds the caller already measured.
+void gf_trace_record (gf_trace_cat_t cat, const char *name, uint64_t start_ns,
+                      uint64_t dur_ns);
+
+// Write the ring to path, or to gridflux-trace.json in XDG_RUNTIME_DIR (the
+// temp directory without one) when path is NULL or empty. An existing symlink
+// at path is refused. The path actually used is copied to out_path.
+gf_err_t gf_trace_write (const char *path, char *out_path, size_t out_size);
+
+void gf_trace_cleanup (void);
+
+#endif // GF_UTILS_TRACE_H
@@ -0,0 +1,31 @@
+#ifndef GF_TESTS_CHECK_H
+#define GF_TESTS_CHECK_H
+
+#include <stdio.h>
+
+/*
+ * Minimal checks for the programs ctest runs. A failed GF_CHECK prints the
+ * expression and marks the run failed; main returns gf_check_status (). Unlike
+ * assert they stay on in release builds.
+ */
+static int gf_check_failures;
+
+#define GF_CHECK(expr)                                                                  \
+    do                                                                                 \
+    {                                                                                  \
+        if (!(expr))                                                                   \
+        {                                                                              \
+            fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);  \
+            gf_check_failures++;                                                       \
+        }                                                                              \
+    } while (0)
+
+static inline int
+gf_check_status (void)
+{
+    if (gf_check_failures)
+        fprintf (stderr, "%d check(s) failed\n", gf_check_failures);
+    return gf_check_failures ? 1 : 0;
+}
+
+#endif // GF_TESTS_CHECK_H
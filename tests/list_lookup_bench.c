@@ -0,0 +1,89 @@
+#include "../src/utils/list.h"
+#include "../src/utils/profiler.h"
+#include "check.h"
+#include <stdio.h>
+
+/*
+ * Lookup cost of gf_window_list_find_by_window_id at 10, 100 and 1000
+ * windows, next to the linear scan it replaced. Handles are spaced like X
+ * client ids (same low bits, different resource bases). The timings are for
+ * reading; what fails the run is a lookup returning the wrong record, also
+ * after removals have shifted the list.
+ */
+
+#define BENCH_LOOKUPS 1000000
+
+static gf_handle_t
+bench_handle (uint32_t i)
+{
+    return (gf_handle_t)(uintptr_t)(0x1e00003u + i * 0x200000u);
+}
+
+static const gf_win_info_t *
+linear_find (const gf_win_list_t *list, gf_handle_t id)
+{
+    for (uint32_t i = 0; i < list->count; i++)
+    {
+        if (list->items[i].id == id)
+            return &list->items[i];
+    }
+    return NULL;
+}
+
+static void
+bench_size (uint32_t size)
+{
+    gf_win_list_t list;
+    GF_CHECK (gf_window_list_init (&list, 16) == GF_SUCCESS);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        gf_win_info_t win = { .id = bench_handle (i),
+                              .workspace_id = (gf_ws_id_t)(i % 4) };
+        GF_CHECK (gf_window_list_add (&list, &win) == GF_SUCCESS);
+    }
+
+    uint32_t wrong = 0;
+    uint64_t start = gf_prof_now_ns ();
+    for (uint32_t k = 0; k < BENCH_LOOKUPS; k++)
+    {
+        gf_handle_t id = bench_handle (k % size);
+        const gf_win_info_t *win = gf_window_list_find_by_window_id (&list, id);
+        wrong += !win || win->id != id;
+    }
+    uint64_t indexed = gf_prof_now_ns () - start;
+
+    start = gf_prof_now_ns ();
+    for (uint32_t k = 0; k < BENCH_LOOKUPS; k++)
+    {
+        gf_handle_t id = bench_handle (k % size);
+        wrong += linear_find (&list, id) == NULL;
+    }
+    uint64_t linear = gf_prof_now_ns () - start;
+
+    GF_CHECK (wrong == 0);
+    GF_CHECK (gf_window_list_find_by_window_id (&list, bench_handle (size)) == NULL);
+
+    // Removing from the front shifts every later slot down
+    for (uint32_t i = 0; i < size; i += 3)
+        GF_CHECK (gf_window_list_remove (&list, bench_handle (i)) == GF_SUCCESS);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        gf_handle_t id = bench_handle (i);
+        const gf_win_info_t *win = gf_window_list_find_by_window_id (&list, id);
+        GF_CHECK (i % 3 == 0 ? win == NULL : (win && win->id == id));
+    }
+
+    printf ("%5u windows: %6.1f ns/lookup indexed, %7.1f ns/lookup linear\n", size,
+            (double)indexed / BENCH_LOOKUPS, (double)linear / BENCH_LOOKUPS);
+    gf_window_list_cleanup (&list);
+}
+
+int
+main (void)
+{
+    bench_size (10);
+    bench_size (100);
+    bench_size (1000);
+    return gf_check_status ();
+}
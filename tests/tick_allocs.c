@@ -0,0 +1,130 @@
+#include "../src/core/internal.h"
+#include "../src/core/layout.h"
+#include "../src/core/wm.h"
+#include "../src/utils/intern.h"
+#include "../src/utils/memory.h"
+#include "check.h"
+#include <string.h>
+
+/*
+ * Steady-state ticks must not touch the heap: every transient layout buffer
+ * comes from the scratch arena. A window manager with a dozen windows over a
+ * fake platform is re-tiled tick after tick, the way wm_tick drives the layout
+ * phase, and gf_mem_alloc_count must not move once the lists have grown.
+ */
+
+#define TEST_WINDOWS 12
+#define TEST_TICKS 100
+
+static gf_rect_t placed[TEST_WINDOWS];
+static uint32_t set_calls;
+
+static int
+fake_slot (gf_handle_t window)
+{
+    uintptr_t slot = (uintptr_t)window - 1;
+    return slot < TEST_WINDOWS ? (int)slot : -1;
+}
+
+static gf_err_t
+fake_get_geometry (gf_display_t display, gf_handle_t window, gf_rect_t *geometry)
+{
+    (void)display;
+    int slot = fake_slot (window);
+    if (slot < 0)
+        return GF_ERROR_INVALID_PARAMETER;
+    *geometry = placed[slot];
+    return GF_SUCCESS;
+}
+
+static gf_err_t
+fake_set_geometry (gf_display_t display, gf_handle_t window, const gf_rect_t *geometry,
+                   gf_geom_flags_t flags, gf_config_t *cfg)
+{
+    (void)display;
+    (void)flags;
+    (void)cfg;
+    int slot = fake_slot (window);
+    if (slot < 0)
+        return GF_ERROR_INVALID_PARAMETER;
+    placed[slot] = *geometry;
+    set_calls++;
+    return GF_SUCCESS;
+}
+
+static gf_err_t
+fake_screen_bounds (gf_display_t display, gf_rect_t *bounds)
+{
+    (void)display;
+    *bounds = (gf_rect_t){ 0, 0, 1920, 1080 };
+    return GF_SUCCESS;
+}
+
+static uint32_t
+fake_workspace_count (gf_display_t display)
+{
+    (void)display;
+    return 4;
+}
+
+static void
+tick (gf_wm_t *m)
+{
+    gf_window_list_mark_all_needs_update (wm_windows (m), NULL);
+    gf_wm_layout_apply (m);
+    gf_wm_changes_sweep (m);
+    gf_scratch_reset ();
+}
+
+int
+main (void)
+{
+    gf_config_t config = {
+        .max_windows_per_workspace = 4,
+        .max_workspaces = 8,
+        .min_window_size = 100,
+    };
+    gf_platform_t platform = {
+        .window_get_geometry = fake_get_geometry,
+        .window_set_geometry = fake_set_geometry,
+        .screen_get_bounds = fake_screen_bounds,
+        .workspace_get_count = fake_workspace_count,
+    };
+
+    gf_layout_engine_t *layout = gf_layout_engine_create (&config);
+    gf_wm_t *m = NULL;
+    GF_CHECK (layout && gf_wm_create (&m, &platform, layout) == GF_SUCCESS);
+    if (!m)
+        return gf_check_status ();
+    m->config = &config;
+
+    for (uintptr_t i = 0; i < TEST_WINDOWS; i++)
+    {
+        gf_win_info_t win = {
+            .id = (gf_handle_t)(i + 1),
+            .workspace_id = -1,
+            .is_valid = true,
+            .name_id = GF_STR_NONE,
+        };
+        GF_CHECK (gf_window_list_add (wm_windows (m), &win) == GF_SUCCESS);
+    }
+
+    // The first ticks create workspaces and grow the change sets
+    for (int i = 0; i < 3; i++)
+        tick (m);
+
+    uint64_t allocs = gf_mem_alloc_count ();
+    set_calls = 0;
+    for (int i = 0; i < TEST_TICKS; i++)
+        tick (m);
+
+    GF_CHECK (gf_mem_alloc_count () == allocs);
+    GF_CHECK (set_calls == TEST_WINDOWS * TEST_TICKS);
+    GF_CHECK (gf_scratch_high_water () > 0);
+
+    gf_wm_destroy (m);
+    gf_layout_engine_destroy (layout);
+    gf_scratch_cleanup ();
+    gf_intern_cleanup ();
+    return gf_check_status ();
+}
@@ -0,0 +1,213 @@
+#include "../src/ipc/wire.h"
+#include "../src/utils/intern.h"
+#include "../src/utils/memory.h"
+#include "check.h"
+#include <string.h>
+
+/*
+ * Round trip of the compact query encoding (ipc/wire.c): full and delta
+ * window and workspace sets come back field for field, and every truncated
+ * prefix of a valid payload is rejected rather than half decoded.
+ */
+
+static bool
+windows_equal (const gf_win_info_t *a, const gf_win_info_t *b)
+{
+    return a->id == b->id && a->workspace_id == b->workspace_id
+           && a->monitor_id == b->monitor_id
+           && memcmp (&a->geometry, &b->geometry, sizeof (a->geometry)) == 0
+           && a->is_maximized == b->is_maximized && a->is_minimized == b->is_minimized
+           && a->needs_update == b->needs_update && a->is_valid == b->is_valid
+           && a->last_modified == b->last_modified
+           && strcmp (gf_win_name (a), gf_win_name (b)) == 0;
+}
+
+static bool
+workspaces_equal (const gf_ws_info_t *a, const gf_ws_info_t *b)
+{
+    return a->id == b->id && a->window_count == b->window_count
+           && a->max_windows == b->max_windows
+           && a->available_space == b->available_space && a->is_locked == b->is_locked
+           && a->has_maximized_state == b->has_maximized_state
+           && a->is_custom_layout == b->is_custom_layout && a->has_rule == b->has_rule;
+}
+
+static void
+free_windows (gf_win_list_t *list)
+{
+    gf_window_list_cleanup (list);
+    gf_free (list);
+}
+
+static void
+free_workspaces (gf_ws_list_t *list)
+{
+    gf_workspace_list_cleanup (list);
+    gf_free (list);
+}
+
+static void
+test_windows (gf_win_list_t *windows)
+{
+    unsigned char buffer[4096];
+    size_t length = gf_wire_encode_windows (windows, NULL);
+    GF_CHECK (length > 0 && length <= sizeof (buffer));
+    GF_CHECK (gf_wire_encode_windows (windows, buffer) == length);
+
+    gf_win_list_t *decoded = gf_wire_decode_windows (buffer, length);
+    GF_CHECK (decoded && decoded->count == windows->count);
+    for (uint32_t i = 0; decoded && i < decoded->count; i++)
+        GF_CHECK (windows_equal (&decoded->items[i], &windows->items[i]));
+    if (decoded)
+        free_windows (decoded);
+
+    for (size_t cut = 0; cut < length; cut++)
+        GF_CHECK (gf_wire_decode_windows (buffer, cut) == NULL);
+}
+
+static void
+test_workspaces (gf_ws_list_t *workspaces)
+{
+    unsigned char buffer[1024];
+    size_t length = gf_wire_encode_workspaces (workspaces, NULL);
+    GF_CHECK (length > 0 && length <= sizeof (buffer));
+    GF_CHECK (gf_wire_encode_workspaces (workspaces, buffer) == length);
+
+    gf_ws_list_t *decoded = gf_wire_decode_workspaces (buffer, length);
+    GF_CHECK (decoded && decoded->count == workspaces->count);
+    for (uint32_t i = 0; decoded && i < decoded->count; i++)
+        GF_CHECK (workspaces_equal (&decoded->items[i], &workspaces->items[i]));
+    for (uint32_t i = 0; decoded && i < GF_MAX_MONITORS; i++)
+        GF_CHECK (decoded->active_workspace[i] == workspaces->active_workspace[i]);
+    if (decoded)
+        free_workspaces (decoded);
+
+    for (size_t cut = 0; cut < length; cut++)
+        GF_CHECK (gf_wire_decode_workspaces (buffer, cut) == NULL);
+}
+
+static void
+test_window_delta (gf_win_list_t *windows)
+{
+    unsigned char buffer[4096];
+    uint64_t removed[] = { 0xdead, 42 };
+    gf_wire_delta_t delta = { .generation = 9, .removed = removed, .removed_count = 2 };
+    gf_wire_delta_t got;
+
+    // Only records changed after generation 6 go out
+    size_t length = gf_wire_encode_windows_since (windows, 6, &delta, buffer);
+    gf_win_list_t *decoded = gf_wire_decode_windows_since (buffer, length, &got);
+    GF_CHECK (decoded && decoded->count == 2);
+    if (decoded)
+    {
+        GF_CHECK (windows_equal (&decoded->items[0], &windows->items[1]));
+        GF_CHECK (windows_equal (&decoded->items[1], &windows->items[2]));
+        GF_CHECK (got.generation == 9 && !got.reset && got.removed_count == 2);
+        GF_CHECK (got.removed_count == 2 && got.removed[0] == 0xdead
+                  && got.removed[1] == 42);
+        gf_wire_delta_release (&got);
+        free_windows (decoded);
+    }
+
+    for (size_t cut = 0; cut < length; cut++)
+        GF_CHECK (gf_wire_decode_windows_since (buffer, cut, &got) == NULL);
+
+    // A reset carries every record whatever its generation
+    delta.reset = true;
+    length = gf_wire_encode_windows_since (windows, 6, &delta, buffer);
+    decoded = gf_wire_decode_windows_since (buffer, length, &got);
+    GF_CHECK (decoded && decoded->count == windows->count && got.reset);
+    if (decoded)
+    {
+        gf_wire_delta_release (&got);
+        free_windows (decoded);
+    }
+}
+
+static void
+test_workspace_delta (gf_ws_list_t *workspaces)
+{
+    unsigned char buffer[1024];
+    uint64_t removed[] = { 7 };
+    gf_wire_delta_t delta = { .generation = 8, .removed = removed, .removed_count = 1 };
+    gf_wire_delta_t got;
+
+    size_t length = gf_wire_encode_workspaces_since (workspaces, 3, &delta, buffer);
+    gf_ws_list_t *decoded = gf_wire_decode_workspaces_since (buffer, length, &got);
+    GF_CHECK (decoded && decoded->count == 1);
+    if (decoded)
+    {
+        GF_CHECK (workspaces_equal (&decoded->items[0], &workspaces->items[1]));
+        GF_CHECK (decoded->active_workspace[0] == workspaces->active_workspace[0]);
+        GF_CHECK (got.removed_count == 1 && got.removed[0] == 7);
+        gf_wire_delta_release (&got);
+        free_workspaces (decoded);
+    }
+
+    for (size_t cut = 0; cut < length; cut++)
+        GF_CHECK (gf_wire_decode_workspaces_since (buffer, cut, &got) == NULL);
+}
+
+int
+main (void)
+{
+    gf_win_info_t items[] = {
+        { .id = (gf_handle_t)0x3a00007,
+          .workspace_id = 2,
+          .monitor_id = 1,
+          .geometry = { -1920, 40, 800, 600 },
+          .is_maximized = true,
+          .is_valid = true,
+          .last_modified = 1760000000,
+          .name_id = gf_intern ("firefox"),
+          .generation = 5 },
+        { .id = (gf_handle_t)1,
+          .workspace_id = -1,
+          .geometry = { 0, 0, 1, 1 },
+          .is_minimized = true,
+          .needs_update = true,
+          .generation = 7 },
+        { .id = (gf_handle_t)(uintptr_t)UINTPTR_MAX,
+          .workspace_id = 31,
+          .name_id = gf_intern ("kitty"),
+          .generation = 9 },
+    };
+    gf_win_list_t windows = { .items = items, .count = 3, .capacity = 3 };
+
+    gf_ws_info_t ws[] = {
+        { .id = 1,
+          .window_count = 3,
+          .max_windows = 10,
+          .available_space = 7,
+          .is_locked = true,
+          .generation = 3 },
+        { .id = 2,
+          .available_space = -3,
+          .has_rule = true,
+          .is_custom_layout = true,
+          .has_maximized_state = true,
+          .generation = 8 },
+    };
+    gf_ws_list_t workspaces = { .items = ws, .count = 2, .capacity = 2 };
+    workspaces.active_workspace[0] = 2;
+    workspaces.active_workspace[1] = 1;
+
+    test_windows (&windows);
+    test_workspaces (&workspaces);
+    test_window_delta (&windows);
+    test_workspace_delta (&workspaces);
+
+    // An empty set is still a valid payload
+    gf_win_list_t none = { 0 };
+    test_windows (&none);
+
+    // Garbage with a valid version byte must not decode
+    unsigned char garbage[64];
+    memset (garbage, 0xff, sizeof (garbage));
+    garbage[0] = GF_WIRE_VERSION;
+    GF_CHECK (gf_wire_decode_windows (garbage, sizeof (garbage)) == NULL);
+    GF_CHECK (gf_wire_decode_workspaces (garbage, sizeof (garbage)) == NULL);
+
+    gf_intern_cleanup ();
+    return gf_check_status ();
+}